@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <mutex>
+#include <rtxx/barrier.hpp>
+#include <rtxx/condition_variable.hpp>
+#include <rtxx/mutex.hpp>
+
+#include "bench.hpp"
+
+namespace bench
+{
+namespace
+{
+/// Phase barrier built from a mutex and a condition variable, the
+/// baseline.
+struct cv_barrier
+{
+  explicit cv_barrier(unsigned count) : count(count), remaining(count) {}
+
+  void arrive_and_wait()
+  {
+    std::unique_lock<mutex> lock(m);
+    const auto my_phase = phase;
+    if (--remaining == 0)
+    {
+      remaining = count;
+      ++phase;
+      cv.notify_all();
+      return;
+    }
+    while (phase == my_phase)
+      cv.wait(lock);
+  }
+
+  mutex m;
+  condition_variable cv;
+  const unsigned count;
+  unsigned remaining;
+  unsigned long phase{0};
+};
+
+/// Time between the last arrival of a phase and the return of the first
+/// participant, seen by the side pinned to cpu_a.
+template <typename Barrier>
+void measure(const options &opt, reporter &rep, const char *metric,
+             Barrier &b)
+{
+  // Stamps of the current and previous phase: a side may be one phase
+  // ahead of the other.
+  monotonic_clock::time_point arrive[2][2];
+  latency_histogram latency;
+
+  cpu_set_t set_a, set_b;
+  task other(measuring_task(opt, "bench_barrier_b", opt.cpu_b, &set_b), [&] {
+    for (long i = 0; i != opt.iterations; ++i)
+    {
+      arrive[i & 1][1] = monotonic_clock::now();
+      b.arrive_and_wait();
+    }
+  });
+  task first(measuring_task(opt, "bench_barrier_a", opt.cpu_a, &set_a), [&] {
+    for (long i = 0; i != opt.iterations; ++i)
+    {
+      arrive[i & 1][0] = monotonic_clock::now();
+      b.arrive_and_wait();
+      const auto now = monotonic_clock::now();
+      latency.record(now - std::max(arrive[i & 1][0], arrive[i & 1][1]));
+    }
+  });
+  first.join();
+  other.join();
+
+  rep.add("barrier_crossing", metric, latency.snapshot());
+}
+} // namespace
+
+void barrier_crossing(const options &opt, reporter &rep)
+{
+  {
+    barrier b(2);
+    measure(opt, rep, "spin_then_block", b);
+  }
+  {
+    barrier b(2, barrier::options{spin_time(chrono::nanoseconds(0))});
+    measure(opt, rep, "block", b);
+  }
+  {
+    cv_barrier b(2);
+    measure(opt, rep, "mutex_and_cv", b);
+  }
+}
+} // namespace bench
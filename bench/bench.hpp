@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <rtxx/latency_histogram.hpp>
+#include <rtxx/task.hpp>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+using namespace rtxx;
+
+/// Command line options shared by all suites
+struct options
+{
+  /// Number of measured iterations per suite
+  long iterations{10000};
+
+  /// Period of the periodic wakeup suite, in microseconds
+  long period_us{1000};
+
+  /// RT priority of the measuring tasks
+  int priority{90};
+
+  /// Number of non-RT busy tasks started while measuring
+  int load{0};
+
+  /// CPUs the two sides of ping-pong suites are pinned to, -1 for none
+  int cpu_a{-1};
+  int cpu_b{-1};
+};
+
+/// One measured metric
+struct result
+{
+  std::string suite;
+  std::string metric;
+  latency_snapshot latency;
+  unsigned long overruns{0};
+};
+
+/// Collects the results of all suites
+class reporter
+{
+public:
+  void add(std::string suite, std::string metric,
+           const latency_snapshot &latency, unsigned long overruns = 0);
+
+  void write_text(std::FILE *out) const;
+  void write_csv(std::FILE *out) const;
+  void write_json(std::FILE *out, const options &opt) const;
+
+private:
+  std::vector<result> results_;
+};
+
+/// Busy non-RT tasks, running while the object lives
+class load_generator
+{
+public:
+  explicit load_generator(int count);
+  ~load_generator();
+
+private:
+  std::atomic<bool> stop_{false};
+  std::vector<std::unique_ptr<task>> tasks_;
+};
+
+/// Task options for a measuring task pinned to \c cpu (-1 for none)
+task::options measuring_task(const options &opt, const char *name, int cpu,
+                             cpu_set_t *set);
+
+/// Name of the backend rtxx was built with
+const char *backend_name();
+
+void wakeup_jitter(const options &opt, reporter &rep);
+void mutex_pingpong(const options &opt, reporter &rep);
+void mutex_modes(const options &opt, reporter &rep);
+void semaphore_handoff(const options &opt, reporter &rep);
+void condition_variable_notify(const options &opt, reporter &rep);
+void task_create(const options &opt, reporter &rep);
+void clock_read(const options &opt, reporter &rep);
+void state_publish(const options &opt, reporter &rep);
+void barrier_crossing(const options &opt, reporter &rep);
+
+} // namespace bench
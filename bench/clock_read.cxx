@@ -0,0 +1,34 @@
+#include "bench.hpp"
+
+namespace bench
+{
+namespace
+{
+/// Average cost of one call to Clock::now(), per batch of calls.
+template <typename Clock> latency_snapshot read_cost(long iterations)
+{
+  constexpr int batch = 64;
+  latency_histogram cost;
+
+  for (long i = 0; i != iterations; ++i)
+  {
+    const auto st = tsc_clock::now();
+    for (int j = 0; j != batch; ++j)
+    {
+      const auto t = Clock::now();
+      asm volatile("" : : "g"(&t) : "memory");
+    }
+    cost.record((tsc_clock::now() - st) / batch);
+  }
+  return cost.snapshot();
+}
+} // namespace
+
+void clock_read(const options &opt, reporter &rep)
+{
+  tsc_clock::calibrate();
+
+  rep.add("clock_read", "monotonic", read_cost<monotonic_clock>(opt.iterations));
+  rep.add("clock_read", "tsc", read_cost<tsc_clock>(opt.iterations));
+}
+} // namespace bench
@@ -0,0 +1,128 @@
+#include <cinttypes>
+#include <cstdio>
+
+#include "bench.hpp"
+
+namespace bench
+{
+namespace
+{
+struct row
+{
+  long long min, mean, p50, p99, p999, max;
+};
+
+row summarize(const latency_snapshot &s)
+{
+  return {s.min().count(),          s.mean().count(),
+          s.percentile(0.5).count(), s.percentile(0.99).count(),
+          s.percentile(0.999).count(), s.max().count()};
+}
+} // namespace
+
+void reporter::add(std::string suite, std::string metric,
+                   const latency_snapshot &latency, unsigned long overruns)
+{
+  results_.push_back({std::move(suite), std::move(metric), latency, overruns});
+}
+
+void reporter::write_text(std::FILE *out) const
+{
+  std::fprintf(out, "%-26s %-22s %9s %9s %9s %9s %9s %9s %9s %8s\n", "suite",
+               "metric", "count", "min", "mean", "p50", "p99", "p99.9", "max",
+               "overruns");
+  for (const auto &r : results_)
+  {
+    const auto s = summarize(r.latency);
+    std::fprintf(out,
+                 "%-26s %-22s %9" PRIu64
+                 " %9lld %9lld %9lld %9lld %9lld %9lld %8lu\n",
+                 r.suite.c_str(), r.metric.c_str(), r.latency.count(), s.min,
+                 s.mean, s.p50, s.p99, s.p999, s.max, r.overruns);
+  }
+}
+
+void reporter::write_csv(std::FILE *out) const
+{
+  std::fprintf(out, "backend,suite,metric,count,min_ns,mean_ns,p50_ns,p99_ns,"
+                    "p999_ns,max_ns,overruns\n");
+  for (const auto &r : results_)
+  {
+    const auto s = summarize(r.latency);
+    std::fprintf(out, "%s,%s,%s,%" PRIu64 ",%lld,%lld,%lld,%lld,%lld,%lld,%lu\n",
+                 backend_name(), r.suite.c_str(), r.metric.c_str(),
+                 r.latency.count(), s.min, s.mean, s.p50, s.p99, s.p999, s.max,
+                 r.overruns);
+  }
+}
+
+void reporter::write_json(std::FILE *out, const options &opt) const
+{
+  std::fprintf(out,
+               "{\n  \"backend\": \"%s\",\n"
+               "  \"options\": {\"iterations\": %ld, \"period_us\": %ld, "
+               "\"priority\": %d, \"load\": %d, \"cpus\": [%d, %d]},\n"
+               "  \"results\": [",
+               backend_name(), opt.iterations, opt.period_us, opt.priority,
+               opt.load, opt.cpu_a, opt.cpu_b);
+
+  const char *sep = "\n";
+  for (const auto &r : results_)
+  {
+    const auto s = summarize(r.latency);
+    std::fprintf(out,
+                 "%s    {\"suite\": \"%s\", \"metric\": \"%s\", "
+                 "\"count\": %" PRIu64 ", \"min_ns\": %lld, \"mean_ns\": %lld, "
+                 "\"p50_ns\": %lld, \"p99_ns\": %lld, \"p999_ns\": %lld, "
+                 "\"max_ns\": %lld, \"overruns\": %lu}",
+                 sep, r.suite.c_str(), r.metric.c_str(), r.latency.count(),
+                 s.min, s.mean, s.p50, s.p99, s.p999, s.max, r.overruns);
+    sep = ",\n";
+  }
+  std::fprintf(out, "\n  ]\n}\n");
+}
+
+load_generator::load_generator(int count)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    tasks_.emplace_back(new task(task::options{name("bench_load")}, [this] {
+      volatile std::uint64_t x = 0;
+      while (!stop_.load(std::memory_order_relaxed))
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    }));
+  }
+}
+
+load_generator::~load_generator()
+{
+  stop_.store(true);
+  for (auto &t : tasks_)
+    t->join();
+}
+
+task::options measuring_task(const options &opt, const char *task_name,
+                             int cpu, cpu_set_t *set)
+{
+  task::options o{name(task_name), priority(opt.priority)};
+  if (cpu >= 0)
+  {
+    CPU_ZERO(set);
+    CPU_SET(cpu, set);
+    o.cpu_set = set;
+  }
+  return o;
+}
+
+const char *backend_name()
+{
+#if defined(RTXX_USE_POSIX)
+  return "posix";
+#elif defined(RTXX_USE_ALCHEMY)
+  return "alchemy";
+#else
+  return "unknown";
+#endif
+}
+
+} // namespace bench
@@ -0,0 +1,46 @@
+#include <mutex>
+#include <rtxx/condition_variable.hpp>
+#include <rtxx/mutex.hpp>
+
+#include "bench.hpp"
+
+namespace bench
+{
+/// Time between notify_one() and the return of the wait it wakes.
+void condition_variable_notify(const options &opt, reporter &rep)
+{
+  mutex m;
+  condition_variable ping, pong;
+  bool ready = false;
+  monotonic_clock::time_point stamp;
+  latency_histogram latency;
+
+  cpu_set_t set_a, set_b;
+  task waiter(measuring_task(opt, "bench_cv_wait", opt.cpu_b, &set_b), [&] {
+    std::unique_lock<mutex> lock(m);
+    for (long i = 0; i != opt.iterations; ++i)
+    {
+      while (!ready)
+        ping.wait(lock);
+      latency.record(monotonic_clock::now() - stamp);
+      ready = false;
+      pong.notify_one();
+    }
+  });
+  task notifier(measuring_task(opt, "bench_cv_notify", opt.cpu_a, &set_a), [&] {
+    std::unique_lock<mutex> lock(m);
+    for (long i = 0; i != opt.iterations; ++i)
+    {
+      ready = true;
+      stamp = monotonic_clock::now();
+      ping.notify_one();
+      while (ready)
+        pong.wait(lock);
+    }
+  });
+  notifier.join();
+  waiter.join();
+
+  rep.add("condition_variable_notify", "notify_to_wake", latency.snapshot());
+}
+} // namespace bench
@@ -0,0 +1,136 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "bench.hpp"
+
+namespace
+{
+struct suite
+{
+  const char *name;
+  void (*run)(const bench::options &, bench::reporter &);
+};
+
+const suite suites[] = {
+    {"wakeup_jitter", bench::wakeup_jitter},
+    {"mutex_pingpong", bench::mutex_pingpong},
+    {"mutex_modes", bench::mutex_modes},
+    {"semaphore_handoff", bench::semaphore_handoff},
+    {"condition_variable_notify", bench::condition_variable_notify},
+    {"task_create", bench::task_create},
+    {"clock_read", bench::clock_read},
+    {"state_publish", bench::state_publish},
+    {"barrier_crossing", bench::barrier_crossing},
+};
+
+void usage(const char *argv0)
+{
+  std::fprintf(stderr,
+               "usage: %s [options]\n"
+               "  --suite NAME        run only NAME (may be repeated)\n"
+               "  --iterations N      measured iterations per suite\n"
+               "  --period-us N       period of the wakeup suite\n"
+               "  --priority N        RT priority of the measuring tasks\n"
+               "  --load N            busy non-RT tasks running meanwhile\n"
+               "  --cpus A,B          pin the two sides of ping-pong suites\n"
+               "  --format F          text, csv or json\n"
+               "  --output FILE       write results to FILE\n"
+               "  --list              list suites\n",
+               argv0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  bench::options opt;
+  std::string format = "text";
+  const char *output = nullptr;
+  std::vector<std::string> selected;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    const auto value = [&]() -> const char * {
+      if (i + 1 == argc)
+      {
+        usage(argv[0]);
+        std::exit(2);
+      }
+      return argv[++i];
+    };
+
+    if (arg == "--suite")
+      selected.emplace_back(value());
+    else if (arg == "--iterations")
+      opt.iterations = std::atol(value());
+    else if (arg == "--period-us")
+      opt.period_us = std::atol(value());
+    else if (arg == "--priority")
+      opt.priority = std::atoi(value());
+    else if (arg == "--load")
+      opt.load = std::atoi(value());
+    else if (arg == "--cpus")
+    {
+      if (std::sscanf(value(), "%d,%d", &opt.cpu_a, &opt.cpu_b) != 2)
+      {
+        usage(argv[0]);
+        return 2;
+      }
+    }
+    else if (arg == "--format")
+      format = value();
+    else if (arg == "--output")
+      output = value();
+    else if (arg == "--list")
+    {
+      for (const auto &s : suites)
+        std::printf("%s\n", s.name);
+      return 0;
+    }
+    else
+    {
+      usage(argv[0]);
+      return arg == "--help" ? 0 : 2;
+    }
+  }
+
+  if (format != "text" && format != "csv" && format != "json")
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  bench::reporter rep;
+  {
+    bench::load_generator load(opt.load);
+
+    for (const auto &s : suites)
+    {
+      bool run = selected.empty();
+      for (const auto &name : selected)
+        run = run || name == s.name;
+      if (run)
+        s.run(opt, rep);
+    }
+  }
+
+  std::FILE *out = stdout;
+  if (output && !(out = std::fopen(output, "w")))
+  {
+    std::perror(output);
+    return 1;
+  }
+
+  if (format == "csv")
+    rep.write_csv(out);
+  else if (format == "json")
+    rep.write_json(out, opt);
+  else
+    rep.write_text(out);
+
+  if (out != stdout)
+    std::fclose(out);
+}
@@ -0,0 +1,75 @@
+#include <rtxx/mutex.hpp>
+#include <rtxx/semaphore.hpp>
+
+#include "bench.hpp"
+
+namespace bench
+{
+namespace
+{
+/// Contended handoff: the holder releases a mutex another task waits on.
+/** Each sample is the time between the holder's unlock() and the return
+ *  of the contender's lock().
+ */
+latency_snapshot contended_handoff(const options &opt,
+                                   const mutex::options &mopt)
+{
+  mutex m(mopt);
+  semaphore holding(0), contending(0), done(0);
+  monotonic_clock::time_point stamp;
+  latency_histogram latency;
+
+  cpu_set_t set_a, set_b;
+  task contender(
+      measuring_task(opt, "bench_contender", opt.cpu_b, &set_b), [&] {
+        for (long i = 0; i != opt.iterations; ++i)
+        {
+          holding.wait();
+          contending.post();
+          m.lock();
+          latency.record(monotonic_clock::now() - stamp);
+          m.unlock();
+          done.post();
+        }
+      });
+  task holder(measuring_task(opt, "bench_holder", opt.cpu_a, &set_a), [&] {
+    for (long i = 0; i != opt.iterations; ++i)
+    {
+      m.lock();
+      holding.post();
+      contending.wait();
+
+      // Give the contender time to start spinning or to block.
+      const auto until = monotonic_clock::now() + chrono::microseconds(20);
+      while (monotonic_clock::now() < until)
+        ;
+
+      stamp = monotonic_clock::now();
+      m.unlock();
+      done.wait();
+    }
+  });
+  holder.join();
+  contender.join();
+
+  return latency.snapshot();
+}
+} // namespace
+
+void mutex_modes(const options &opt, reporter &rep)
+{
+  const int ceiling = sched_get_priority_max(SCHED_FIFO);
+
+  rep.add("mutex_modes", "none",
+          contended_handoff(opt, mutex::options{}));
+  rep.add("mutex_modes", "inherit",
+          contended_handoff(opt, mutex::options{priority_inherit()}));
+  rep.add("mutex_modes", "protect",
+          contended_handoff(opt, mutex::options{priority_ceiling(ceiling)}));
+  rep.add("mutex_modes", "adaptive",
+          contended_handoff(opt, mutex::options{adaptive_spin(1000)}));
+  rep.add("mutex_modes", "inherit_adaptive",
+          contended_handoff(opt, mutex::options{priority_inherit(),
+                                                adaptive_spin(1000)}));
+}
+} // namespace bench
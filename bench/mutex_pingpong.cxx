@@ -0,0 +1,75 @@
+#include <rtxx/mutex.hpp>
+#include <rtxx/semaphore.hpp>
+
+#include "bench.hpp"
+
+namespace bench
+{
+namespace
+{
+/// Two tasks pass the turn to each other through a mutex.
+/** Each sample is the time between one side releasing the mutex with the
+ *  turn handed over and the other side acquiring it.
+ */
+struct pingpong
+{
+  explicit pingpong(long iterations) : iterations(iterations) {}
+
+  void side(int id)
+  {
+    // Both sides must exist before either spins on the turn. The gate is
+    // passed on, as the first side to wake may preempt the creator.
+    start.wait();
+    start.post();
+
+    for (;;)
+    {
+      m.lock();
+      if (handoffs == iterations)
+      {
+        m.unlock();
+        return;
+      }
+
+      if (turn != id)
+      {
+        m.unlock();
+        this_task::yield();
+        continue;
+      }
+
+      const auto now = monotonic_clock::now();
+      if (handoffs++ > 0)
+        latency.record(now - stamp);
+      turn = 1 - id;
+      stamp = monotonic_clock::now();
+      m.unlock();
+    }
+  }
+
+  const long iterations;
+  semaphore start{0};
+  mutex m;
+  int turn{0};
+  long handoffs{0};
+  monotonic_clock::time_point stamp;
+  latency_histogram latency;
+};
+} // namespace
+
+void mutex_pingpong(const options &opt, reporter &rep)
+{
+  pingpong pp(opt.iterations + 1);
+
+  cpu_set_t set_a, set_b;
+  task a(measuring_task(opt, "bench_mutex_a", opt.cpu_a, &set_a),
+         [&] { pp.side(0); });
+  task b(measuring_task(opt, "bench_mutex_b", opt.cpu_b, &set_b),
+         [&] { pp.side(1); });
+  pp.start.post();
+  a.join();
+  b.join();
+
+  rep.add("mutex_pingpong", "handoff", pp.latency.snapshot());
+}
+} // namespace bench
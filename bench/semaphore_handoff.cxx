@@ -0,0 +1,36 @@
+#include <rtxx/semaphore.hpp>
+
+#include "bench.hpp"
+
+namespace bench
+{
+/// Time between a post and the return of the wait it satisfies.
+void semaphore_handoff(const options &opt, reporter &rep)
+{
+  semaphore ping(0), pong(0);
+  monotonic_clock::time_point stamp;
+  latency_histogram latency;
+
+  cpu_set_t set_a, set_b;
+  task waiter(measuring_task(opt, "bench_sem_wait", opt.cpu_b, &set_b), [&] {
+    for (long i = 0; i != opt.iterations; ++i)
+    {
+      ping.wait();
+      latency.record(monotonic_clock::now() - stamp);
+      pong.post();
+    }
+  });
+  task poster(measuring_task(opt, "bench_sem_post", opt.cpu_a, &set_a), [&] {
+    for (long i = 0; i != opt.iterations; ++i)
+    {
+      stamp = monotonic_clock::now();
+      ping.post();
+      pong.wait();
+    }
+  });
+  poster.join();
+  waiter.join();
+
+  rep.add("semaphore_handoff", "post_to_wake", latency.snapshot());
+}
+} // namespace bench
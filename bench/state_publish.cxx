@@ -0,0 +1,114 @@
+#include <cstring>
+#include <mutex>
+#include <rtxx/mutex.hpp>
+#include <rtxx/seqlock.hpp>
+#include <rtxx/triple_buffer.hpp>
+#include <string>
+
+#include "bench.hpp"
+
+namespace bench
+{
+namespace
+{
+struct robot_state
+{
+  std::uint64_t seq;
+  double joints[32];
+};
+
+/// Shared state guarded by a mutex, the baseline.
+struct locked_state
+{
+  mutex lock;
+  robot_state value{};
+
+  void store(const robot_state &s)
+  {
+    std::lock_guard<mutex> guard(lock);
+    value = s;
+  }
+
+  robot_state load()
+  {
+    std::lock_guard<mutex> guard(lock);
+    return value;
+  }
+};
+
+struct triple_state
+{
+  triple_buffer<robot_state> buf;
+
+  void store(const robot_state &s) { buf.write(s); }
+  robot_state load() { return buf.read(); }
+};
+
+/// Time taken by a periodic writer to publish while \c readers spin on
+/// loads at non-RT priority.
+template <typename State>
+void measure(const options &opt, reporter &rep, const char *kind,
+             int readers)
+{
+  State state;
+  std::atomic<bool> stop{false};
+  std::vector<std::unique_ptr<task>> reader_tasks;
+
+  cpu_set_t reader_set;
+  task::options reader_opt{name("bench_reader")};
+  if (opt.cpu_b >= 0)
+  {
+    CPU_ZERO(&reader_set);
+    CPU_SET(opt.cpu_b, &reader_set);
+    reader_opt.cpu_set = &reader_set;
+  }
+
+  for (int r = 0; r != readers; ++r)
+  {
+    reader_tasks.emplace_back(new task(reader_opt, [&] {
+      while (!stop.load(std::memory_order_relaxed))
+      {
+        const std::uint64_t seq = state.load().seq;
+        asm volatile("" : : "r"(seq));
+      }
+    }));
+  }
+
+  latency_histogram latency;
+  cpu_set_t set;
+  task writer(measuring_task(opt, "bench_writer", opt.cpu_a, &set), [&] {
+    robot_state s{};
+    const auto period = chrono::microseconds(200);
+    this_task::set_periodic(monotonic_clock::now() + period, period);
+    for (long i = 0; i != opt.iterations; ++i)
+    {
+      this_task::wait_period();
+      s.seq = i;
+      const auto st = monotonic_clock::now();
+      state.store(s);
+      latency.record(monotonic_clock::now() - st);
+    }
+  });
+  writer.join();
+
+  stop = true;
+  for (auto &t : reader_tasks)
+    t->join();
+
+  rep.add("state_publish",
+          std::string(kind) + "_write_r" + std::to_string(readers),
+          latency.snapshot());
+}
+} // namespace
+
+/// Writer latency of latest-value sharing with 1 to 4 concurrent readers.
+void state_publish(const options &opt, reporter &rep)
+{
+  for (int readers : {1, 2, 4})
+  {
+    measure<seqlock<robot_state>>(opt, rep, "seqlock", readers);
+    measure<locked_state>(opt, rep, "mutex", readers);
+  }
+  measure<triple_state>(opt, rep, "triple_buffer", 1);
+}
+} // namespace bench
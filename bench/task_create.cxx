@@ -0,0 +1,27 @@
+#include "bench.hpp"
+
+namespace bench
+{
+/// Cost of creating a task and of joining it once it has finished.
+void task_create(const options &opt, reporter &rep)
+{
+  latency_histogram create, join;
+
+  cpu_set_t set;
+  const auto o = measuring_task(opt, "bench_create", opt.cpu_a, &set);
+  for (long i = 0; i != opt.iterations; ++i)
+  {
+    const auto st = monotonic_clock::now();
+    task t(o, [] {});
+    const auto mid = monotonic_clock::now();
+    t.join();
+    const auto nd = monotonic_clock::now();
+
+    create.record(mid - st);
+    join.record(nd - mid);
+  }
+
+  rep.add("task_create", "create", create.snapshot());
+  rep.add("task_create", "join", join.snapshot());
+}
+} // namespace bench
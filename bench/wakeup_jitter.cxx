@@ -0,0 +1,23 @@
+#include "bench.hpp"
+
+namespace bench
+{
+/// Wakeup latency of a periodic task, as recorded by the task itself.
+void wakeup_jitter(const options &opt, reporter &rep)
+{
+  cpu_set_t set;
+  auto o = measuring_task(opt, "bench_jitter", opt.cpu_a, &set);
+  o.record_latency = true;
+
+  const auto period = chrono::microseconds(opt.period_us);
+  task t(o, [&] {
+    this_task::set_periodic(monotonic_clock::now() + period, period);
+    for (long i = 0; i < opt.iterations; i += 1 + this_task::wait_period())
+    {
+    }
+  });
+  t.join();
+
+  rep.add("wakeup_jitter", "wakeup", t.wakeup_latency(), t.overruns());
+}
+} // namespace bench
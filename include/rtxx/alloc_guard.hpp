@@ -0,0 +1,118 @@
+#pragma once
+
+/// Replacement global allocation functions checking the allocation guard.
+/** Include this header in exactly one translation unit of the program to
+ *  enable task::options::alloc_guard. Every \c operator \c new then
+ *  reports to the guard of the calling task, which counts or aborts once
+ *  the task has finished its warm-up. Direct calls to \c malloc() are not
+ *  seen.
+ */
+
+#include <cstdlib>
+#include <new>
+#include <rtxx/memory_resource.hpp>
+
+namespace rtxx
+{
+namespace detail
+{
+inline void *guarded_alloc(std::size_t size, std::size_t align) noexcept
+{
+  check_allocation();
+
+  if (size == 0)
+    size = 1;
+  if (align <= alignof(std::max_align_t))
+    return std::malloc(size);
+
+  void *p = nullptr;
+  return posix_memalign(&p, align, size) == 0 ? p : nullptr;
+}
+
+inline void *guarded_alloc_or_throw(std::size_t size, std::size_t align)
+{
+  void *p = guarded_alloc(size, align);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+} // namespace detail
+} // namespace rtxx
+
+void *operator new(std::size_t size)
+{
+  return rtxx::detail::guarded_alloc_or_throw(size, 0);
+}
+
+void *operator new[](std::size_t size)
+{
+  return rtxx::detail::guarded_alloc_or_throw(size, 0);
+}
+
+void *operator new(std::size_t size, std::align_val_t align)
+{
+  return rtxx::detail::guarded_alloc_or_throw(size, std::size_t(align));
+}
+
+void *operator new[](std::size_t size, std::align_val_t align)
+{
+  return rtxx::detail::guarded_alloc_or_throw(size, std::size_t(align));
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  return rtxx::detail::guarded_alloc(size, 0);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+  return rtxx::detail::guarded_alloc(size, 0);
+}
+
+void *operator new(std::size_t size, std::align_val_t align,
+                   const std::nothrow_t &) noexcept
+{
+  return rtxx::detail::guarded_alloc(size, std::size_t(align));
+}
+
+void *operator new[](std::size_t size, std::align_val_t align,
+                     const std::nothrow_t &) noexcept
+{
+  return rtxx::detail::guarded_alloc(size, std::size_t(align));
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t,
+                     const std::nothrow_t &) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void *p, std::align_val_t,
+                       const std::nothrow_t &) noexcept
+{
+  std::free(p);
+}
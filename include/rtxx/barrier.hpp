@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/impl/spin_wait.hpp>
+#include <rtxx/inplace_function.hpp>
+
+#if defined(RTXX_USE_SIM)
+#error "rtxx::barrier is not supported by the simulation backend"
+#endif
+
+#if defined(RTXX_USE_ALCHEMY)
+#include <alchemy/event.h>
+#endif
+
+namespace rtxx
+{
+/// Reusable rendezvous of a fixed number of tasks.
+/** Each call to arrive_and_wait() blocks until all the participants have
+ *  arrived, then the barrier is ready for the next phase. The last task
+ *  to arrive runs the completion function before releasing the others.
+ *
+ *  Waiting tasks first spin, each on its own cache line, so that the
+ *  release costs one store per participant and no system call. Past
+ *  options::spin, they sleep on a futex, or on an event on Alchemy.
+ *  Spinning only pays when the participants run on different CPUs.
+ *
+ * @par Example
+ * @code
+ *   rtxx::barrier phase(4, [] { swap_buffers(); });
+ *
+ *   // in each of the four tasks
+ *   for (;;)
+ *   {
+ *     sense();
+ *     phase.arrive_and_wait();
+ *     compute();
+ *     phase.arrive_and_wait();
+ *   }
+ * @endcode
+ */
+class barrier
+{
+public:
+  /// Barrier options
+  struct options
+  {
+    /// Time spent spinning before sleeping, zero to sleep at once
+    chrono::nanoseconds spin{chrono::microseconds(20)};
+
+    /// Construct options from convenient initializers
+    template <typename... Initializers>
+    constexpr explicit options(Initializers &&... init) noexcept;
+  };
+
+  /// Function run by the last task to arrive, before the release
+  /** It must not throw. */
+  using completion_function = inplace_function<void()>;
+
+  /// Create a barrier for \c count participants
+  /** @throw system_error with errc::invalid_argument if \c count is 0. */
+  RTXX_DECL explicit barrier(unsigned count);
+
+  /// Create a barrier for \c count participants
+  RTXX_DECL barrier(unsigned count, const options &opt);
+
+  /// Create a barrier for \c count participants with a completion function
+  RTXX_DECL barrier(unsigned count, completion_function completion,
+                    const options &opt = options{});
+
+  /// Destroy the barrier
+  RTXX_DECL ~barrier();
+
+  /// Deleted copy constructor
+  barrier(const barrier &) = delete;
+
+  /// Deleted copy assignment operator
+  barrier &operator=(const barrier &) = delete;
+
+  /// Arrive at the barrier and wait for the other participants
+  /** @returns true in the task which ran the completion function */
+  RTXX_DECL bool arrive_and_wait() noexcept;
+
+  /// Get the number of participants
+  [[nodiscard]] unsigned expected() const noexcept { return count_; }
+
+private:
+  struct alignas(RTXX_CACHELINE_SIZE) slot
+  {
+    std::atomic<std::uint32_t> phase{0};
+  };
+
+  /// Release the tasks waiting for the end of phase \c phase.
+  RTXX_DECL void release(std::uint32_t phase) noexcept;
+
+  /// Sleep until the end of phase \c phase.
+  RTXX_DECL void sleep(std::uint32_t phase) noexcept;
+
+  const unsigned count_;
+  const std::int64_t spin_;
+  completion_function completion_;
+
+  /// Where the task with each arrival ticket spins.
+  std::unique_ptr<slot[]> slots_;
+
+  /// Participants yet to arrive in the current phase.
+  alignas(RTXX_CACHELINE_SIZE) std::atomic<unsigned> remaining_;
+
+  /// Number of the current phase, also the futex word.
+  alignas(RTXX_CACHELINE_SIZE) std::atomic<std::uint32_t> phase_{0};
+  std::atomic<std::uint32_t> sleepers_{0};
+
+#if defined(RTXX_USE_ALCHEMY)
+  RT_EVENT event_;
+#endif
+};
+
+template <typename... Initializers>
+constexpr barrier::options::options(Initializers &&... init) noexcept
+{
+  (init(this), ...);
+}
+
+} // namespace rtxx
+
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/barrier.ipp>
+#endif
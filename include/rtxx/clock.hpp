@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 
 #include "rtxx/config.hpp"
 
@@ -68,8 +69,125 @@ public:
 };
 #endif
 
+/// An absolute timeout on the monotonic_clock timeline
+/** The timespec handed to the kernel is computed once, so a deadline can
+ *  bound several timed waits of a cycle without reading the clock again.
+ *
+ * @par Example
+ * @code
+ *   const auto d = rtxx::deadline::after(500us);
+ *   if (sem.wait_until(d) && queue.receive_until(msg, d))
+ *     process(msg);
+ * @endcode
+ */
+class deadline
+{
+public:
+  /// Create a deadline at \c t
+  RTXX_INLINE_DECL constexpr explicit deadline(
+      monotonic_clock::time_point t) noexcept;
+
+  /// Create a deadline \c rel_time from now
+  RTXX_INLINE_DECL static deadline after(chrono::nanoseconds rel_time);
+
+  /// Get the point in time of the deadline
+  [[nodiscard]] RTXX_INLINE_DECL constexpr monotonic_clock::time_point
+  when() const noexcept;
+
+  /// Get the deadline as an absolute CLOCK_MONOTONIC timespec
+  [[nodiscard]] RTXX_INLINE_DECL constexpr const struct timespec *
+  as_timespec() const noexcept;
+
+  /// Checks if the deadline has passed
+  [[nodiscard]] RTXX_INLINE_DECL bool expired() const;
+
+  /// Get the time left, or zero if the deadline has passed
+  [[nodiscard]] RTXX_INLINE_DECL chrono::nanoseconds remaining() const;
+
+private:
+  monotonic_clock::time_point t_;
+  struct timespec ts_;
+};
+
+namespace detail
+{
+/// Conversion from counter ticks to monotonic_clock nanoseconds.
+struct tsc_calibration
+{
+  /// Whether the hardware counter is used at all
+  bool use_counter;
+
+  /// Counter value and monotonic time read together at calibration
+  std::uint64_t base_counter;
+  std::int64_t base_ns;
+
+  /// Nanoseconds per tick, as a 32.32 fixed point number
+  std::uint64_t mult;
+};
+
+/// The calibration of tsc_clock, made on first use.
+RTXX_DECL const tsc_calibration &tsc_state() noexcept;
+} // namespace detail
+
+/// Clock reading the CPU's time-stamp counter
+/** Reading this clock costs a few nanoseconds and never fails. It uses the
+ *  invariant TSC on x86 and the virtual counter on AArch64. The counter is
+ *  calibrated against CLOCK_MONOTONIC once, over about 10ms, and then
+ *  extrapolated linearly. Its time points are thus only close to the
+ *  monotonic_clock timeline: the error of the measured rate, and NTP
+ *  slewing CLOCK_MONOTONIC afterwards, make them drift apart the further
+ *  they are from the calibration. Use it to measure intervals, not to
+ *  compare with monotonic_clock time points hours later.
+ *
+ *  On hosts without an invariant counter, now() falls back to
+ *  CLOCK_MONOTONIC.
+ *
+ *  Calibration takes about 10ms and happens on first use. Call
+ *  calibrate() during initialisation to keep it out of RT code.
+ *
+ * @par Concepts
+ *      @li Clock
+ */
+class tsc_clock
+{
+public:
+  using duration = chrono::nanoseconds;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = chrono::time_point<tsc_clock>;
+
+  static const bool is_steady{true};
+
+  /// Get the current clock value
+  RTXX_INLINE_DECL static time_point now() noexcept;
+
+  /// Read the raw hardware counter, or 0 if there is none
+  RTXX_INLINE_DECL static std::uint64_t read_counter() noexcept;
+
+  /// Convert a time point to monotonic_clock
+  /** The time since the epoch is kept as is: the result is an
+   *  approximation, whose error grows with the distance to the
+   *  calibration.
+   */
+  RTXX_INLINE_DECL static monotonic_clock::time_point
+  to_monotonic(time_point t) noexcept;
+
+  /// Convert a time point from monotonic_clock
+  /** An approximation, see to_monotonic(). */
+  RTXX_INLINE_DECL static time_point
+  from_monotonic(monotonic_clock::time_point t) noexcept;
+
+  /// Checks if the hardware counter is used
+  /** Returns false if now() falls back to CLOCK_MONOTONIC. */
+  RTXX_INLINE_DECL static bool uses_counter() noexcept;
+
+  /// Calibrate the counter, if this has not been done yet
+  RTXX_INLINE_DECL static void calibrate() noexcept;
+};
+
 } // namespace rtxx
 
+#include <rtxx/impl/clock.hpp>
 #ifdef RTXX_HEADER_ONLY
 #include <rtxx/impl/clock.ipp>
 #endif
@@ -4,7 +4,10 @@
 #include <rtxx/clock.hpp>
 #include <rtxx/config.hpp>
 #include <rtxx/error.hpp>
-#if defined(RTXX_USE_POSIX)
+#include <rtxx/impl/process_shared.hpp>
+#if defined(RTXX_USE_SIM)
+#include <rtxx/impl/sim.hpp>
+#elif defined(RTXX_USE_POSIX)
 #include <pthread.h>
 #elif defined(RTXX_USE_ALCHEMY)
 #include <alchemy/cond.h>
@@ -18,9 +21,27 @@ class mutex;
 class condition_variable
 {
 public:
+  /// Condition variable options
+  struct options
+  {
+    /// Allow the condition variable to be used by several processes.
+    /** It must then be placed in shared memory and used with a
+     *  process-shared mutex. Not supported on Alchemy nor by the
+     *  simulation.
+     */
+    bool process_shared{false};
+
+    /// Construct options from convenient initializers
+    template <typename... Initializers>
+    constexpr explicit options(Initializers &&... init) noexcept;
+  };
+
   /// Create a condition variable
   RTXX_DECL condition_variable();
 
+  /// Create a condition variable
+  RTXX_DECL explicit condition_variable(const options &opt);
+
   /// Destroy a condition variable
   RTXX_DECL ~condition_variable();
 
@@ -47,14 +68,35 @@ public:
 
   /// blocks the current thread until the condition variable is woken up or
   /// until specified time point has been reached
+  /** The clock may be monotonic_clock, or realtime_clock on POSIX. */
   template <typename Clock, typename Duration>
   bool wait_until(std::unique_lock<mutex> &lock,
                   chrono::time_point<Clock, Duration> const &abs_time);
 
+  /// blocks the current thread until the condition variable is woken up or
+  /// until the deadline has passed
+  RTXX_INLINE_DECL bool wait_until(std::unique_lock<mutex> &lock,
+                                   const deadline &d);
+
+  /// blocks the current thread until the condition variable is woken up or
+  /// until \c abs_time
+  /** \c abs_time is on the CLOCK_REALTIME timeline on POSIX, as for
+   *  \c pthread_cond_timedwait(), and follows steps of the wall clock.
+   *  Prefer the overloads taking a deadline or a clock.
+   */
   RTXX_DECL bool wait_until(std::unique_lock<mutex> &lock,
                             const struct timespec *abs_time);
 
-#if defined(RTXX_USE_POSIX)
+  /// blocks the current thread until the condition variable is woken up or
+  /// until \c abs_time on \c clock
+  /** \c clock may be CLOCK_MONOTONIC, or CLOCK_REALTIME on POSIX. */
+  RTXX_INLINE_DECL bool wait_until(std::unique_lock<mutex> &lock,
+                                   clockid_t clock,
+                                   const struct timespec *abs_time);
+
+#if defined(RTXX_USE_SIM)
+  using native_handle_type = sim::detail::wait_queue *;
+#elif defined(RTXX_USE_POSIX)
   using native_handle_type = pthread_cond_t *;
 #elif defined(RTXX_USE_ALCHEMY)
   using native_handle_type = RT_COND *;
@@ -64,7 +106,13 @@ public:
   RTXX_INLINE_DECL native_handle_type native_handle() const;
 
 private:
-#if defined(RTXX_USE_POSIX)
+  /// Wait until \c abs_time on \c clock
+  RTXX_DECL bool clock_wait(std::unique_lock<mutex> &lock, clockid_t clock,
+                            const struct timespec *abs_time);
+
+#if defined(RTXX_USE_SIM)
+  sim::detail::wait_queue c_;
+#elif defined(RTXX_USE_POSIX)
   pthread_cond_t c_;
 #elif defined(RTXX_USE_ALCHEMY)
   RT_COND c_;
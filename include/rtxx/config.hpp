@@ -1,6 +1,12 @@
 #ifndef RTXX_CONFIG_HPP
 #define RTXX_CONFIG_HPP
 
+/// The simulation backend runs each task on a POSIX thread, and takes
+/// over its clocks, scheduling and synchronization.
+#if defined(RTXX_USE_SIM) && !defined(RTXX_USE_POSIX)
+#define RTXX_USE_POSIX
+#endif
+
 #if !defined(RTXX_USE_POSIX) && !defined(RTXX_USE_ALCHEMY) &&                  \
     !defined(RTXX_USE_RTDM)
 #define RTXX_USE_POSIX
@@ -10,6 +16,10 @@
 #define RTXX_HEADER_ONLY
 #endif
 
+#if defined(RTXX_USE_SIM) && !defined(RTXX_HEADER_ONLY)
+#error "the simulation backend requires RTXX_HEADER_ONLY"
+#endif
+
 #ifndef RTXX_DECL
 
 #ifdef RTXX_HEADER_ONLY
@@ -27,6 +37,41 @@
 
 #define RTXX_INLINE_DECL inline
 
+#if defined(__linux__)
+#include <features.h>
+#endif
+
+/// Defined when the C library provides sem_clockwait() and friends
+#if defined(__GLIBC__) &&                                                      \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30))
+#define RTXX_HAVE_CLOCKWAIT
+#endif
+
+/// Defined when the C library provides pthread_attr_setaffinity_np()
+#if defined(__GLIBC__)
+#define RTXX_HAVE_PTHREAD_ATTR_SETAFFINITY_NP
+#endif
+
 #define RTXX_CONSTEXPR_LAMBDA constexpr
 
+/// Size used to keep independently written data on separate cache lines
+#ifndef RTXX_CACHELINE_SIZE
+#define RTXX_CACHELINE_SIZE 64
+#endif
+
+/// Default capacity of inplace_function, in bytes
+#ifndef RTXX_INPLACE_FUNCTION_CAPACITY
+#define RTXX_INPLACE_FUNCTION_CAPACITY 64
+#endif
+
+/// Signal sent to a task which exhausts its execution budget
+#ifndef RTXX_BUDGET_SIGNAL
+#define RTXX_BUDGET_SIGNAL (SIGRTMAX - 1)
+#endif
+
+/// Number of events kept per thread when RTXX_ENABLE_TRACE is defined
+#ifndef RTXX_TRACE_BUFFER_EVENTS
+#define RTXX_TRACE_BUFFER_EVENTS 8192
+#endif
+
 #endif
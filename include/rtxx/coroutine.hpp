@@ -0,0 +1,345 @@
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+#error "rtxx/coroutine.hpp requires C++20 coroutines"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/memory_resource.hpp>
+#include <rtxx/semaphore.hpp>
+#include <vector>
+
+namespace rtxx
+{
+class co_scheduler;
+class co_semaphore;
+
+namespace this_coroutine
+{
+struct wait_period;
+struct sleep_until;
+struct acquire;
+} // namespace this_coroutine
+
+/// Coroutine run by a co_scheduler.
+/** Frames are allocated from the frame pool of the scheduler, a coroutine
+ *  may therefore only be created through co_scheduler::spawn() or from
+ *  another coroutine of the same scheduler.
+ */
+class co_task
+{
+public:
+  struct promise_type
+  {
+    /// Allocate a frame from the pool of the current scheduler
+    /** @throw std::bad_alloc if there is no current scheduler, the pool is
+     *  exhausted or the frame is larger than a block.
+     */
+    static void *operator new(std::size_t size);
+
+    static void operator delete(void *p, std::size_t size) noexcept;
+
+    co_task get_return_object() noexcept;
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept;
+
+    co_scheduler *sched{};
+    monotonic_clock::time_point release{};
+    chrono::nanoseconds period{};
+  };
+
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  /// Take the frame of \c other
+  co_task(co_task &&other) noexcept;
+
+  /// Deleted copy constructor
+  co_task(const co_task &) = delete;
+
+  /// Deleted copy assignment operator
+  co_task &operator=(const co_task &) = delete;
+
+  /// Destroy the frame unless it was handed to a scheduler
+  ~co_task();
+
+private:
+  friend class co_scheduler;
+
+  explicit co_task(handle_type h) noexcept : h_(h) {}
+
+  handle_type h_;
+};
+
+/// Semaphore which wakes the co_scheduler awaiting it when posted
+/** A plain semaphore awaited by coroutines is polled by their scheduler,
+ *  posting a co_semaphore instead wakes the scheduler at once. Only one
+ *  scheduler is woken: a second scheduler awaiting the same co_semaphore
+ *  polls it. Posting costs a fence and a load on top of semaphore::post().
+ *  Not process-shared. The wakeup is only implemented on POSIX, elsewhere
+ *  a co_semaphore is polled as well.
+ */
+class co_semaphore
+{
+public:
+  using value_type = semaphore::value_type;
+
+  /// Create a semaphore
+  explicit co_semaphore(value_type init_value) : sem_(init_value) {}
+
+  /// Deleted copy constructor
+  co_semaphore(const co_semaphore &) = delete;
+
+  /// Deleted copy assignment operator
+  co_semaphore &operator=(const co_semaphore &) = delete;
+
+  /// Get the value of the semaphore
+  [[nodiscard]] value_type get_value() const { return sem_.get_value(); }
+
+  /// Lock the semaphore without blocking
+  [[nodiscard]] bool try_wait() { return sem_.try_wait(); }
+
+  /// Unlock the semaphore and wake the scheduler awaiting it
+  /** May be called from any task. */
+  void post();
+
+private:
+  friend class co_scheduler;
+  friend struct this_coroutine::acquire;
+
+  semaphore sem_;
+
+  /// Doorbell of the scheduler awaiting the semaphore, if any.
+  std::atomic<std::atomic<std::uint32_t> *> listener_{nullptr};
+};
+
+/// Runs many coroutines on the calling task, by release time.
+/** The scheduler is single-threaded: all its coroutines run on the task
+ *  calling run(), one at a time, until they suspend. The task sleeps
+ *  until the earliest release point or acquire deadline, and is woken by
+ *  co_semaphore::post() on a co_semaphore its coroutines await. Plain
+ *  semaphores are polled every \c poll_interval while awaited. Nothing is
+ *  allocated once the scheduler is created, as long as at most
+ *  \c max_coroutines are alive.
+ *
+ *  A co_semaphore must not be posted while a scheduler awaiting it is
+ *  being destroyed.
+ *
+ * @par Example
+ * @code
+ *   rtxx::co_task blink(led &l)
+ *   {
+ *     rtxx::this_coroutine::set_periodic(rtxx::monotonic_clock::now(), 500ms);
+ *     for (;;)
+ *     {
+ *       co_await rtxx::this_coroutine::wait_period();
+ *       l.toggle();
+ *     }
+ *   }
+ *
+ *   rtxx::co_scheduler sched(rtxx::co_scheduler::options{});
+ *   for (auto &l : leds)
+ *     sched.spawn(blink, l);
+ *   rtxx::task t(rtxx::task::options{rtxx::priority(10)}, [&] { sched.run(); });
+ * @endcode
+ */
+class co_scheduler
+{
+public:
+  /// Scheduler options
+  struct options
+  {
+    /// Number of coroutines which may be alive at the same time
+    std::size_t max_coroutines{256};
+
+    /// Largest coroutine frame, in bytes
+    std::size_t frame_size{512};
+
+    /// Interval at which semaphores which cannot wake the scheduler are
+    /// polled
+    chrono::nanoseconds poll_interval{100'000};
+
+    /// Construct options from convenient initializers
+    template <typename... Initializers>
+    constexpr explicit options(Initializers &&... init) noexcept;
+  };
+
+  /// Create a scheduler and its frame pool
+  explicit co_scheduler(const options &opt);
+
+  /// Deleted copy constructor
+  co_scheduler(const co_scheduler &) = delete;
+
+  /// Deleted copy assignment operator
+  co_scheduler &operator=(const co_scheduler &) = delete;
+
+  /// Destroy the coroutines left
+  ~co_scheduler();
+
+  /// Create a coroutine by calling \c f(args...) and make it ready
+  /** May be called before run() or from a coroutine of this scheduler.
+   *  @throw std::bad_alloc if the frame pool cannot hold the coroutine.
+   */
+  template <typename F, typename... Args> void spawn(F &&f, Args &&... args);
+
+  /// Run the coroutines until they all finish or stop() is called
+  void run();
+
+  /// Make run() return before resuming another coroutine
+  /** May be called from any task. */
+  void stop() noexcept;
+
+  /// Get the number of coroutines alive
+  [[nodiscard]] std::size_t size() const noexcept { return live_; }
+
+private:
+  friend class co_task;
+  friend struct co_task::promise_type;
+  friend struct this_coroutine::wait_period;
+  friend struct this_coroutine::sleep_until;
+  friend struct this_coroutine::acquire;
+
+  using listener_type = std::atomic<std::atomic<std::uint32_t> *>;
+
+  struct entry
+  {
+    monotonic_clock::time_point release;
+    unsigned long seq;
+    co_task::handle_type h;
+
+    bool operator<(const entry &other) const noexcept
+    {
+      return release != other.release ? release > other.release
+                                      : seq > other.seq;
+    }
+  };
+
+  struct waiter
+  {
+    co_task::handle_type h;
+    semaphore *sem;
+    listener_type *listener;
+    monotonic_clock::time_point deadline;
+    bool *acquired;
+    bool notified;
+  };
+
+  /// Make a suspended coroutine ready at \c release.
+  void schedule(co_task::handle_type h,
+                monotonic_clock::time_point release) noexcept;
+
+  /// Resume a suspended coroutine once \c sem is acquired or at \c deadline.
+  /** \c listener, if not null, is that of the co_semaphore of \c sem. */
+  void wait(co_task::handle_type h, semaphore &sem, listener_type *listener,
+            monotonic_clock::time_point deadline, bool *acquired) noexcept;
+
+  /// Move waiters whose semaphore was acquired or which timed out.
+  void poll(monotonic_clock::time_point now) noexcept;
+
+  /// Make the co_semaphore of \c listener wake the scheduler when posted.
+  /** @returns false if it cannot, the semaphore must then be polled. */
+  bool listen(listener_type *listener) noexcept;
+
+  /// Stop the co_semaphore of \c listener from waking the scheduler,
+  /// unless another waiter awaits it.
+  void unlisten(listener_type *listener) noexcept;
+
+  /// Wake run() from another task.
+  void ring() noexcept;
+
+  /// Sleep until \c t on the monotonic clock, or until the doorbell moves
+  /// from \c bell.
+  void sleep_until(monotonic_clock::time_point t, std::uint32_t bell) noexcept;
+
+  pool_resource frames_;
+  chrono::nanoseconds poll_interval_;
+  std::vector<entry> ready_;
+  std::vector<waiter> waiters_;
+  unsigned long seq_{0};
+  std::size_t live_{0};
+  std::atomic<bool> stop_{false};
+  std::atomic<std::uint32_t> doorbell_{0};
+};
+
+/// Functions to access the current coroutine
+namespace this_coroutine
+{
+/// Make the current coroutine periodic
+void set_periodic(monotonic_clock::time_point start,
+                  chrono::nanoseconds interval) noexcept;
+
+/// Awaitable resuming at the next periodic release point
+/** co_await yields the number of release points missed. */
+struct wait_period
+{
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(co_task::handle_type h) noexcept;
+  unsigned await_resume() const noexcept { return missed; }
+
+  unsigned missed{0};
+};
+
+/// Awaitable resuming at a point in time
+struct sleep_until
+{
+  explicit sleep_until(monotonic_clock::time_point t) noexcept : time(t) {}
+
+  bool await_ready() const noexcept { return monotonic_clock::now() >= time; }
+  void await_suspend(co_task::handle_type h) noexcept;
+  void await_resume() const noexcept {}
+
+  monotonic_clock::time_point time;
+};
+
+/// Awaitable resuming after a duration
+inline sleep_until sleep_for(chrono::nanoseconds d) noexcept
+{
+  return sleep_until(monotonic_clock::now() + d);
+}
+
+/// Awaitable acquiring a semaphore, at most until a deadline
+/** co_await yields \c false if the deadline was reached first. */
+struct acquire
+{
+  explicit acquire(semaphore &s, monotonic_clock::time_point t =
+                                     monotonic_clock::time_point::max()) noexcept
+      : sem(s), deadline(t)
+  {
+  }
+
+  explicit acquire(
+      co_semaphore &s,
+      monotonic_clock::time_point t = monotonic_clock::time_point::max()) noexcept
+      : sem(s.sem_), listener(&s.listener_), deadline(t)
+  {
+  }
+
+  bool await_ready() noexcept { return acquired = sem.try_wait(); }
+  void await_suspend(co_task::handle_type h) noexcept;
+  bool await_resume() const noexcept { return acquired; }
+
+  semaphore &sem;
+  std::atomic<std::atomic<std::uint32_t> *> *listener{};
+  monotonic_clock::time_point deadline;
+  bool acquired{false};
+};
+} // namespace this_coroutine
+
+/// Returns an initializer for the max_coroutines scheduler option.
+RTXX_INLINE_DECL constexpr auto max_coroutines(std::size_t n);
+
+/// Returns an initializer for the frame_size scheduler option.
+RTXX_INLINE_DECL constexpr auto frame_size(std::size_t bytes);
+
+/// Returns an initializer for the poll_interval scheduler option.
+RTXX_INLINE_DECL constexpr auto poll_interval(chrono::nanoseconds interval);
+
+} // namespace rtxx
+
+#include <rtxx/impl/coroutine.hpp>
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <initializer_list>
+#include <rtxx/config.hpp>
+#include <rtxx/error.hpp>
+#include <sched.h>
+
+namespace rtxx
+{
+/// A set of CPUs, held by value.
+/** Unlike a pointer to a \c cpu_set_t, a cpu_mask may be stored in
+ *  options structures and copied around freely.
+ *
+ * @par Example
+ * @code
+ *   rtxx::cpu_mask cpus{2, 3};
+ *   rtxx::task t(rtxx::task::options{rtxx::affinity(cpus)}, [] { ... });
+ * @endcode
+ */
+class cpu_mask
+{
+public:
+  /// Largest number of CPUs a mask may hold
+  static constexpr int max_cpus = CPU_SETSIZE;
+
+  /// Create an empty mask
+  constexpr cpu_mask() noexcept : set_{} {}
+
+  /// Create a mask holding the given CPUs
+  RTXX_INLINE_DECL cpu_mask(std::initializer_list<int> cpus) noexcept;
+
+  /// Create a mask from a \c cpu_set_t
+  RTXX_INLINE_DECL explicit cpu_mask(const cpu_set_t &set) noexcept;
+
+  /// Parse a CPU list such as "0-3,8,10-11", as found in \c /sys
+  /** Surrounding white space is ignored and an empty list gives an empty
+   *  mask.
+   *  @throw system_error with errc::invalid_argument on a malformed list.
+   */
+  RTXX_DECL static cpu_mask parse(const char *list);
+
+  /// Parse a CPU list such as "0-3,8,10-11", as found in \c /sys
+  RTXX_DECL static cpu_mask parse(const char *list, error_code &ec) noexcept;
+
+  /// Add a CPU to the mask, CPUs out of range are ignored
+  RTXX_INLINE_DECL void set(int cpu) noexcept;
+
+  /// Remove a CPU from the mask
+  RTXX_INLINE_DECL void reset(int cpu) noexcept;
+
+  /// Checks if a CPU is in the mask
+  [[nodiscard]] RTXX_INLINE_DECL bool test(int cpu) const noexcept;
+
+  /// Get the number of CPUs in the mask
+  [[nodiscard]] RTXX_INLINE_DECL int count() const noexcept;
+
+  /// Checks if the mask holds no CPU
+  [[nodiscard]] RTXX_INLINE_DECL bool empty() const noexcept;
+
+  /// Get the lowest CPU of the mask, or -1 if it is empty
+  [[nodiscard]] RTXX_INLINE_DECL int first() const noexcept;
+
+  /// Get the lowest CPU above \c cpu, or -1 if there is none
+  /** Iterate with
+   *  <tt>for (int c = m.first(); c != -1; c = m.next(c))</tt>.
+   */
+  [[nodiscard]] RTXX_INLINE_DECL int next(int cpu) const noexcept;
+
+  /// Get the CPUs in both masks
+  RTXX_INLINE_DECL cpu_mask &operator&=(const cpu_mask &other) noexcept;
+
+  /// Get the CPUs in either mask
+  RTXX_INLINE_DECL cpu_mask &operator|=(const cpu_mask &other) noexcept;
+
+  /// Remove the CPUs of another mask
+  RTXX_INLINE_DECL cpu_mask &operator-=(const cpu_mask &other) noexcept;
+
+  /// Get the underlying \c cpu_set_t
+  [[nodiscard]] const cpu_set_t *native_handle() const noexcept
+  {
+    return &set_;
+  }
+
+private:
+  cpu_set_t set_;
+};
+
+/// Get the CPUs in both masks
+RTXX_INLINE_DECL cpu_mask operator&(cpu_mask a, const cpu_mask &b) noexcept;
+
+/// Get the CPUs in either mask
+RTXX_INLINE_DECL cpu_mask operator|(cpu_mask a, const cpu_mask &b) noexcept;
+
+/// Get the CPUs of \c a which are not in \c b
+RTXX_INLINE_DECL cpu_mask operator-(cpu_mask a, const cpu_mask &b) noexcept;
+
+/// Checks if two masks hold the same CPUs
+RTXX_INLINE_DECL bool operator==(const cpu_mask &a,
+                                 const cpu_mask &b) noexcept;
+
+/// Checks if two masks hold different CPUs
+RTXX_INLINE_DECL bool operator!=(const cpu_mask &a,
+                                 const cpu_mask &b) noexcept;
+
+/// Returns an initializer for the affinity option.
+/** Applies to the options of task and thread_pool. When set, it takes
+ *  precedence over the \c cpu_set pointer.
+ */
+RTXX_INLINE_DECL constexpr auto affinity(const cpu_mask &cpus);
+
+} // namespace rtxx
+
+#include <rtxx/impl/cpu_mask.hpp>
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/cpu_mask.ipp>
+#endif
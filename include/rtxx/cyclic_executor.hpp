@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/task.hpp>
+#include <vector>
+
+namespace rtxx
+{
+/// Runs many periodic jobs on one task driven by one timer.
+/** Job periods must be harmonic (each period divides every longer one).
+ *  The minor frame is the greatest common divisor of all periods and
+ *  offsets, the major frame is the longest period. The schedule is built
+ *  once by start() and never changes while running. Within a frame, jobs
+ *  with a shorter period run first.
+ *
+ *  A job overruns when it completes after its next release. When a whole
+ *  minor frame is missed, the releases it contained are counted as
+ *  skipped and the executor resumes on the next frame of the timeline.
+ *
+ * @par Example
+ * @code
+ *   rtxx::cyclic_executor ex;
+ *   ex.add_job("servo", 1ms, 0ms, [] { servo(); });
+ *   ex.add_job("planner", 4ms, 1ms, [] { plan(); });
+ *   ex.start(rtxx::task::options{rtxx::priority(90)});
+ *   // ...
+ *   ex.stop();
+ * @endcode
+ */
+class cyclic_executor
+{
+public:
+  /// Statistics of a job
+  struct job_stats
+  {
+    /// Number of completed invocations
+    unsigned long runs;
+
+    /// Number of invocations that completed after the next release
+    unsigned long overruns;
+
+    /// Number of releases skipped because their minor frame was missed
+    unsigned long skipped;
+
+    /// Longest execution time observed
+    chrono::nanoseconds max_exec_time;
+  };
+
+  /// Create an executor with no jobs
+  RTXX_DECL cyclic_executor();
+
+  /// Deleted copy constructor
+  cyclic_executor(const cyclic_executor &) = delete;
+
+  /// Deleted copy assignment operator
+  cyclic_executor &operator=(const cyclic_executor &) = delete;
+
+  /// Stop the executor if it is running
+  RTXX_DECL ~cyclic_executor();
+
+  /// Add a job, released at \c offset + k * \c period
+  /** Must be called before start().
+   *  @returns the index of the job
+   */
+  RTXX_DECL std::size_t add_job(const char *name, chrono::nanoseconds period,
+                                chrono::nanoseconds offset,
+                                std::function<void()> fn);
+
+  /// Build the schedule and start running it on a new task
+  /** @throw system_error with errc::invalid_argument if the periods are
+   *  not harmonic or an offset is not shorter than its period.
+   */
+  RTXX_DECL void start(const task::options &opt);
+
+  /// Build the schedule and start running it on a new task
+  RTXX_DECL void start(const task::options &opt, error_code &ec);
+
+  /// Stop running at the next minor frame and join the task
+  RTXX_DECL void stop();
+
+  /// Checks if the executor is running
+  [[nodiscard]] RTXX_DECL bool running() const noexcept;
+
+  /// Get the minor frame length, valid after start()
+  [[nodiscard]] RTXX_DECL chrono::nanoseconds minor_frame() const noexcept;
+
+  /// Get the major frame length, valid after start()
+  [[nodiscard]] RTXX_DECL chrono::nanoseconds major_frame() const noexcept;
+
+  /// Get the number of jobs
+  [[nodiscard]] RTXX_DECL std::size_t job_count() const noexcept;
+
+  /// Get the name of a job
+  [[nodiscard]] RTXX_DECL const char *job_name(std::size_t job) const;
+
+  /// Get the statistics of a job
+  /** May be called from any task while the executor is running. */
+  [[nodiscard]] RTXX_DECL job_stats stats(std::size_t job) const;
+
+  /// Get the number of minor frames missed as a whole
+  [[nodiscard]] RTXX_DECL unsigned long frame_overruns() const noexcept;
+
+private:
+  struct job
+  {
+    const char *name;
+    chrono::nanoseconds period;
+    chrono::nanoseconds offset;
+    std::function<void()> fn;
+  };
+
+  struct counters
+  {
+    std::atomic<unsigned long> runs{0};
+    std::atomic<unsigned long> overruns{0};
+    std::atomic<unsigned long> skipped{0};
+    std::atomic<chrono::nanoseconds::rep> max_exec_time{0};
+  };
+
+  /// Build frames_ and frame_begin_ from jobs_.
+  RTXX_DECL void build_schedule(error_code &ec);
+
+  /// Body of the executor task.
+  RTXX_DECL void run() noexcept;
+
+  std::vector<job> jobs_;
+  std::unique_ptr<counters[]> counters_;
+
+  /// Jobs of frame k are frames_[frame_begin_[k]] .. frames_[frame_begin_[k + 1]].
+  std::vector<std::size_t> frames_;
+  std::vector<std::size_t> frame_begin_;
+
+  chrono::nanoseconds minor_{};
+  chrono::nanoseconds major_{};
+
+  std::atomic<bool> stop_{false};
+  std::atomic<unsigned long> frame_overruns_{0};
+  std::unique_ptr<task> task_;
+};
+
+} // namespace rtxx
+
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/cyclic_executor.ipp>
+#endif
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/impl/process_shared.hpp>
+
+#if defined(RTXX_USE_SIM)
+#error "rtxx::event_flags is not supported by the simulation backend"
+#endif
+
+#if defined(RTXX_USE_ALCHEMY)
+#include <alchemy/event.h>
+#endif
+
+namespace rtxx
+{
+/// Group of 32 event flags, waited on by any or all of a mask.
+/** Setting flags wakes only the waiters interested in one of the flags
+ *  which became set: on POSIX the flags are the futex word itself and
+ *  each waiter sleeps with its mask as futex bitset, on Alchemy they are
+ *  an \c RT_EVENT. A wait_all() waiter is woken when one of its missing
+ *  flags is set, and sleeps again if others are still missing.
+ *
+ *  Flags are not consumed by waiting: clear them once handled.
+ *
+ * @par Example
+ * @code
+ *   enum : rtxx::event_flags::mask_type { axis_fault = 1, estop = 2,
+ *                                         fieldbus_ready = 4 };
+ *   rtxx::event_flags events;
+ *
+ *   // in the supervisor task
+ *   if (auto got = events.wait_any_for(axis_fault | estop, 10ms))
+ *   {
+ *     events.clear(got);
+ *     // ...
+ *   }
+ *
+ *   // in the fieldbus task
+ *   events.set(fieldbus_ready);
+ * @endcode
+ */
+class event_flags
+{
+public:
+  /// Type of a set of flags, one bit per flag
+  /** 32 bits, the width of a futex word and of an \c RT_EVENT. */
+  using mask_type = std::uint32_t;
+
+  /// Event flags options
+  struct options
+  {
+    /// Allow the flags to be used by several processes.
+    /** The object must then be placed in shared memory, see
+     *  shared_memory. Not supported on Alchemy.
+     */
+    bool process_shared{false};
+
+    /// Construct options from convenient initializers
+    template <typename... Initializers>
+    constexpr explicit options(Initializers &&... init) noexcept;
+  };
+
+  /// Create a group of flags with the flags of \c init set
+  RTXX_DECL explicit event_flags(mask_type init = 0);
+
+  /// Create a group of flags with the flags of \c init set
+  RTXX_DECL event_flags(mask_type init, const options &opt);
+
+  /// Destroy the group
+  RTXX_DECL ~event_flags();
+
+  /// Deleted copy constructor
+  event_flags(const event_flags &) = delete;
+
+  /// Deleted copy assignment operator
+  event_flags &operator=(const event_flags &) = delete;
+
+  /// Set flags, waking the tasks waiting for one of them
+  /** Never blocks. Makes no system call when no task waits, or when the
+   *  flags were already set.
+   *  @returns the flags before the call
+   */
+  RTXX_DECL mask_type set(mask_type flags);
+
+  /// Clear flags, never wakes a task
+  /** @returns the flags before the call */
+  RTXX_DECL mask_type clear(mask_type flags);
+
+  /// Get the flags currently set
+  [[nodiscard]] RTXX_DECL mask_type get() const;
+
+  /// Wait until one of the flags of \c mask is set
+  /** @returns the flags of \c mask which are set
+   *  @throw system_error with errc::invalid_argument if \c mask is zero.
+   */
+  RTXX_INLINE_DECL mask_type wait_any(mask_type mask);
+
+  /// Wait until one of the flags of \c mask is set, at most \c rel_time
+  /** @returns the flags of \c mask which are set, zero on timeout */
+  template <typename Rep, typename Period>
+  mask_type wait_any_for(mask_type mask,
+                         chrono::duration<Rep, Period> const &rel_time);
+
+  /// Wait until one of the flags of \c mask is set, at most until
+  /// \c abs_time
+  /** The clock may be monotonic_clock, or realtime_clock on POSIX.
+   *  @returns the flags of \c mask which are set, zero on timeout
+   */
+  template <typename Clock, typename Duration>
+  mask_type wait_any_until(mask_type mask,
+                           chrono::time_point<Clock, Duration> const &abs_time);
+
+  /// Wait until one of the flags of \c mask is set, at most until \c d
+  /** @returns the flags of \c mask which are set, zero on timeout */
+  RTXX_INLINE_DECL mask_type wait_any_until(mask_type mask, const deadline &d);
+
+  /// Wait until all the flags of \c mask are set
+  /** @returns \c mask
+   *  @throw system_error with errc::invalid_argument if \c mask is zero.
+   */
+  RTXX_INLINE_DECL mask_type wait_all(mask_type mask);
+
+  /// Wait until all the flags of \c mask are set, at most \c rel_time
+  /** @returns \c mask, zero on timeout */
+  template <typename Rep, typename Period>
+  mask_type wait_all_for(mask_type mask,
+                         chrono::duration<Rep, Period> const &rel_time);
+
+  /// Wait until all the flags of \c mask are set, at most until
+  /// \c abs_time
+  /** The clock may be monotonic_clock, or realtime_clock on POSIX.
+   *  @returns \c mask, zero on timeout
+   */
+  template <typename Clock, typename Duration>
+  mask_type wait_all_until(mask_type mask,
+                           chrono::time_point<Clock, Duration> const &abs_time);
+
+  /// Wait until all the flags of \c mask are set, at most until \c d
+  /** @returns \c mask, zero on timeout */
+  RTXX_INLINE_DECL mask_type wait_all_until(mask_type mask, const deadline &d);
+
+private:
+  /// Wait for any or all flags of \c mask, at most until \c abs_timeout
+  /// on \c clock if not null.
+  RTXX_DECL mask_type clock_wait(mask_type mask, bool all, clockid_t clock,
+                                 const struct timespec *abs_timeout);
+
+#if defined(RTXX_USE_POSIX)
+  /// The flags, also the futex word.
+  std::atomic<std::uint32_t> flags_;
+  std::atomic<std::uint32_t> waiters_{0};
+  const bool shared_;
+
+#elif defined(RTXX_USE_ALCHEMY)
+  RT_EVENT event_;
+#endif
+};
+
+template <typename... Initializers>
+constexpr event_flags::options::options(Initializers &&... init) noexcept
+{
+  (init(this), ...);
+}
+
+inline event_flags::mask_type event_flags::wait_any(mask_type mask)
+{
+  return clock_wait(mask, false, CLOCK_MONOTONIC, nullptr);
+}
+
+template <typename Rep, typename Period>
+event_flags::mask_type
+event_flags::wait_any_for(mask_type mask,
+                          chrono::duration<Rep, Period> const &rel_time)
+{
+  return wait_any_until(mask, monotonic_clock::now() + rel_time);
+}
+
+template <typename Clock, typename Duration>
+event_flags::mask_type event_flags::wait_any_until(
+    mask_type mask, chrono::time_point<Clock, Duration> const &abs_time)
+{
+  const auto ts = detail::duration_to_timespec(abs_time.time_since_epoch());
+  return clock_wait(mask, false, detail::wait_clockid<Clock>(), &ts);
+}
+
+inline event_flags::mask_type event_flags::wait_any_until(mask_type mask,
+                                                          const deadline &d)
+{
+  return clock_wait(mask, false, CLOCK_MONOTONIC, d.as_timespec());
+}
+
+inline event_flags::mask_type event_flags::wait_all(mask_type mask)
+{
+  return clock_wait(mask, true, CLOCK_MONOTONIC, nullptr);
+}
+
+template <typename Rep, typename Period>
+event_flags::mask_type
+event_flags::wait_all_for(mask_type mask,
+                          chrono::duration<Rep, Period> const &rel_time)
+{
+  return wait_all_until(mask, monotonic_clock::now() + rel_time);
+}
+
+template <typename Clock, typename Duration>
+event_flags::mask_type event_flags::wait_all_until(
+    mask_type mask, chrono::time_point<Clock, Duration> const &abs_time)
+{
+  const auto ts = detail::duration_to_timespec(abs_time.time_since_epoch());
+  return clock_wait(mask, true, detail::wait_clockid<Clock>(), &ts);
+}
+
+inline event_flags::mask_type event_flags::wait_all_until(mask_type mask,
+                                                          const deadline &d)
+{
+  return clock_wait(mask, true, CLOCK_MONOTONIC, d.as_timespec());
+}
+
+} // namespace rtxx
+
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/event_flags.ipp>
+#endif
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <climits>
+#include <cstring>
+#include <rtxx/barrier.hpp>
+#include <rtxx/error.hpp>
+#include <rtxx/impl/futex.hpp>
+#include <rtxx/log.hpp>
+#include <rtxx/trace.hpp>
+
+namespace rtxx
+{
+barrier::barrier(unsigned count) : barrier(count, completion_function())
+{
+}
+
+barrier::barrier(unsigned count, const options &opt)
+    : barrier(count, completion_function(), opt)
+{
+}
+
+barrier::barrier(unsigned count, completion_function completion,
+                 const options &opt)
+    : count_(count), spin_(opt.spin.count()),
+      completion_(std::move(completion)), remaining_(count)
+{
+  if (count == 0)
+    throw system_error(EINVAL, system_category(), "barrier::barrier");
+
+  slots_.reset(new slot[count]);
+
+#if defined(RTXX_USE_ALCHEMY)
+  int err = rt_event_create(&event_, nullptr, 0, EV_PRIO);
+  if (err)
+    throw system_error(-err, system_category(), "barrier::barrier");
+#endif
+}
+
+barrier::~barrier()
+{
+#if defined(RTXX_USE_ALCHEMY)
+  int err = rt_event_delete(&event_);
+  if (err)
+    log::error("barrier::~barrier: %s", strerror(-err));
+#endif
+}
+
+bool barrier::arrive_and_wait() noexcept
+{
+  // The phase cannot end before this task arrives, so this is the
+  // current one.
+  const auto phase = phase_.load(std::memory_order_acquire);
+  const unsigned ticket =
+      remaining_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+
+  if (ticket == 0)
+  {
+    if (completion_)
+      completion_();
+    release(phase);
+    return true;
+  }
+
+  // The slot may still hold an older phase, when its previous waiter left
+  // before release() reached it: only the end of this phase counts.
+  RTXX_TRACE(wait_begin, this, 0);
+  const slot &s = slots_[ticket];
+  if (!detail::spin_until(
+          [&] {
+            return s.phase.load(std::memory_order_acquire) == phase + 1;
+          },
+          spin_))
+    sleep(phase);
+  RTXX_TRACE(wait_end, this, 0);
+  return false;
+}
+
+void barrier::release(std::uint32_t phase) noexcept
+{
+  RTXX_TRACE(post, this, 0);
+#if defined(RTXX_USE_ALCHEMY)
+  // Tasks of the next phase wait for the other bit, set one phase ago.
+  rt_event_clear(&event_, 1u << (phase & 1), nullptr);
+#endif
+
+  // Ready the next phase before any task can leave this one.
+  remaining_.store(count_, std::memory_order_relaxed);
+  phase_.store(phase + 1, std::memory_order_seq_cst);
+  for (unsigned i = 1; i != count_; ++i)
+    slots_[i].phase.store(phase + 1, std::memory_order_release);
+
+#if defined(RTXX_USE_POSIX)
+  if (sleepers_.load(std::memory_order_seq_cst))
+    detail::futex_wake(&phase_, INT_MAX, false);
+#elif defined(RTXX_USE_ALCHEMY)
+  rt_event_signal(&event_, 1u << ((phase + 1) & 1));
+#endif
+}
+
+void barrier::sleep(std::uint32_t phase) noexcept
+{
+#if defined(RTXX_USE_POSIX)
+  sleepers_.fetch_add(1, std::memory_order_seq_cst);
+  while (phase_.load(std::memory_order_acquire) == phase)
+    detail::futex_wait(&phase_, phase, nullptr, false);
+  sleepers_.fetch_sub(1, std::memory_order_relaxed);
+#elif defined(RTXX_USE_ALCHEMY)
+  unsigned int mask;
+  while (phase_.load(std::memory_order_acquire) == phase)
+    rt_event_wait(&event_, 1u << ((phase + 1) & 1), &mask, EV_ANY,
+                  TM_INFINITE);
+#endif
+}
+
+} // namespace rtxx
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <rtxx/clock.hpp>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#if defined(RTXX_USE_SIM)
+#include <rtxx/impl/sim.hpp>
+#endif
+
+namespace rtxx
+{
+namespace detail
+{
+/// Read CLOCK_MONOTONIC without throwing.
+inline std::int64_t monotonic_ns() noexcept
+{
+#if defined(RTXX_USE_SIM)
+  return sim::detail::now();
+#elif defined(RTXX_USE_POSIX)
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_nsec + static_cast<std::int64_t>(ts.tv_sec) * 1'000'000'000LL;
+#elif defined(RTXX_USE_ALCHEMY)
+  return rt_timer_ticks2ns(rt_timer_read());
+#endif
+}
+
+/// Get the clock of a time point accepted by timed waits.
+template <typename Clock> constexpr clockid_t wait_clockid() noexcept
+{
+#if defined(RTXX_USE_POSIX)
+  static_assert(std::is_same<Clock, monotonic_clock>::value ||
+                    std::is_same<Clock, realtime_clock>::value,
+                "only monotonic_clock and realtime_clock are supported");
+#else
+  static_assert(std::is_same<Clock, monotonic_clock>::value,
+                "only monotonic_clock is supported");
+#endif
+  return Clock::clockid;
+}
+
+#if defined(RTXX_USE_POSIX)
+/// Move an absolute time from one clock to another.
+/** Used where the C library cannot wait on \c from directly. The result
+ *  is off by the time between the two clock reads.
+ */
+inline struct timespec convert_timespec(clockid_t from, clockid_t to,
+                                        const struct timespec &t) noexcept
+{
+#if defined(RTXX_USE_SIM)
+  // Both clocks read the virtual time.
+  (void)from;
+  (void)to;
+  return t;
+#else
+  if (from == to)
+    return t;
+
+  struct timespec now_from, now_to;
+  clock_gettime(from, &now_from);
+  clock_gettime(to, &now_to);
+  const auto ns = (t.tv_sec - now_from.tv_sec + now_to.tv_sec) * 1'000'000'000LL +
+                  (t.tv_nsec - now_from.tv_nsec + now_to.tv_nsec);
+  return duration_to_timespec(chrono::nanoseconds(ns));
+#endif
+}
+#endif
+} // namespace detail
+
+constexpr deadline::deadline(monotonic_clock::time_point t) noexcept
+    : t_(t), ts_(detail::duration_to_timespec(t.time_since_epoch()))
+{
+}
+
+deadline deadline::after(chrono::nanoseconds rel_time)
+{
+  return deadline(monotonic_clock::now() + rel_time);
+}
+
+constexpr monotonic_clock::time_point deadline::when() const noexcept
+{
+  return t_;
+}
+
+constexpr const struct timespec *deadline::as_timespec() const noexcept
+{
+  return &ts_;
+}
+
+bool deadline::expired() const { return monotonic_clock::now() >= t_; }
+
+chrono::nanoseconds deadline::remaining() const
+{
+  const auto left = t_ - monotonic_clock::now();
+  return left.count() > 0 ? left : chrono::nanoseconds(0);
+}
+
+std::uint64_t tsc_clock::read_counter() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  std::uint64_t v;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+  return v;
+#else
+  return 0;
+#endif
+}
+
+tsc_clock::time_point tsc_clock::now() noexcept
+{
+  const auto &c = detail::tsc_state();
+  if (!c.use_counter)
+    return time_point(duration(detail::monotonic_ns()));
+
+  const std::uint64_t delta = read_counter() - c.base_counter;
+  const auto ns = static_cast<rep>(
+      (static_cast<unsigned __int128>(delta) * c.mult) >> 32);
+  return time_point(duration(c.base_ns + ns));
+}
+
+monotonic_clock::time_point tsc_clock::to_monotonic(time_point t) noexcept
+{
+  return monotonic_clock::time_point(t.time_since_epoch());
+}
+
+tsc_clock::time_point
+tsc_clock::from_monotonic(monotonic_clock::time_point t) noexcept
+{
+  return time_point(t.time_since_epoch());
+}
+
+bool tsc_clock::uses_counter() noexcept
+{
+  return detail::tsc_state().use_counter;
+}
+
+void tsc_clock::calibrate() noexcept { detail::tsc_state(); }
+
+} // namespace rtxx
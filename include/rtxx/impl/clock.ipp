@@ -1,13 +1,24 @@
 #pragma once
 
+#include <cerrno>
 #include <rtxx/clock.hpp>
 #include <rtxx/error.hpp>
 
+#if defined(RTXX_USE_SIM)
+#include <rtxx/impl/sim.hpp>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
 namespace rtxx
 {
 monotonic_clock::time_point monotonic_clock::now()
 {
-#if defined(RTXX_USE_POSIX)
+#if defined(RTXX_USE_SIM)
+  return time_point(duration(sim::detail::now()));
+#elif defined(RTXX_USE_POSIX)
   struct timespec ts;
   if (-1 == clock_gettime(clockid, &ts))
     throw system_error(errno, system_category(), "clock_gettime");
@@ -22,13 +33,90 @@ monotonic_clock::time_point monotonic_clock::now()
 #if defined(RTXX_USE_POSIX)
 realtime_clock::time_point realtime_clock::now()
 {
+#if defined(RTXX_USE_SIM)
+  return time_point(duration(sim::detail::now()));
+#else
   struct timespec ts;
   if (-1 == clock_gettime(clockid, &ts))
     throw system_error(errno, system_category(), "clock_gettime");
 
   rep r = ts.tv_nsec + static_cast<rep>(ts.tv_sec) * 1'000'000'000LL;
   return time_point(duration(r));
+#endif
 }
 #endif
 
+namespace detail
+{
+/// Checks if the counter ticks at a constant rate in all power states.
+inline bool tsc_is_invariant() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+    return false;
+  return edx & (1u << 8);
+#elif defined(__aarch64__)
+  // The generic timer's virtual counter has a fixed frequency.
+  return true;
+#else
+  return false;
+#endif
+}
+
+/// Read the counter and CLOCK_MONOTONIC as close together as possible.
+inline void tsc_sample(std::uint64_t &counter, std::int64_t &ns) noexcept
+{
+  std::uint64_t best = UINT64_MAX;
+  for (int i = 0; i != 5; ++i)
+  {
+    const auto before = tsc_clock::read_counter();
+    const auto t = monotonic_ns();
+    const auto after = tsc_clock::read_counter();
+    if (after - before < best)
+    {
+      best = after - before;
+      counter = before + (after - before) / 2;
+      ns = t;
+    }
+  }
+}
+
+inline tsc_calibration tsc_calibrate() noexcept
+{
+  tsc_calibration c{};
+#if defined(RTXX_USE_SIM)
+  // tsc_clock follows the virtual time.
+  return c;
+#else
+  if (!tsc_is_invariant())
+    return c;
+
+  std::uint64_t c0, c1;
+  std::int64_t t0, t1;
+  tsc_sample(c0, t0);
+
+  const struct timespec interval = {.tv_sec = 0, .tv_nsec = 10'000'000};
+  while (nanosleep(&interval, nullptr) == -1 && errno == EINTR)
+    ;
+
+  tsc_sample(c1, t1);
+  if (c1 <= c0 || t1 <= t0)
+    return c;
+
+  c.use_counter = true;
+  c.base_counter = c1;
+  c.base_ns = t1;
+  c.mult = (static_cast<unsigned __int128>(t1 - t0) << 32) / (c1 - c0);
+  return c;
+#endif
+}
+
+const tsc_calibration &tsc_state() noexcept
+{
+  static const tsc_calibration c = tsc_calibrate();
+  return c;
+}
+} // namespace detail
+
 } // namespace rtxx
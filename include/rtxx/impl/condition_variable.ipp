@@ -3,7 +3,9 @@
 #include <cstring>
 #include <rtxx/condition_variable.hpp>
 #include <rtxx/error.hpp>
+#include <rtxx/log.hpp>
 #include <rtxx/mutex.hpp>
+#include <rtxx/trace.hpp>
 
 namespace rtxx
 {
@@ -11,14 +13,29 @@ using chrono::duration;
 using chrono::time_point;
 using namespace rtxx::detail;
 
-condition_variable::condition_variable()
+condition_variable::condition_variable() : condition_variable(options{}) {}
+
+condition_variable::condition_variable(const options &opt)
 {
   int err;
 
-#if defined(RTXX_USE_POSIX)
-  err = pthread_cond_init(&c_, nullptr);
+#if defined(RTXX_USE_SIM)
+  err = opt.process_shared ? ENOTSUP : 0;
+#elif defined(RTXX_USE_POSIX)
+  pthread_condattr_t attr;
+  err = pthread_condattr_init(&attr);
+  if (!err)
+    err = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  if (!err && opt.process_shared)
+    err = pthread_condattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  if (!err)
+    err = pthread_cond_init(&c_, &attr);
+  pthread_condattr_destroy(&attr);
 #elif defined(RTXX_USE_ALCHEMY)
-  err = -rt_cond_create(&c_, nullptr);
+  if (opt.process_shared)
+    err = ENOTSUP;
+  else
+    err = -rt_cond_create(&c_, nullptr);
 #endif
 
   if (err)
@@ -29,7 +46,9 @@ condition_variable::~condition_variable()
 {
   int err;
 
-#if defined(RTXX_USE_POSIX)
+#if defined(RTXX_USE_SIM)
+  err = c_.head ? EBUSY : 0;
+#elif defined(RTXX_USE_POSIX)
   err = pthread_cond_destroy(&c_);
 #elif defined(RTXX_USE_ALCHEMY)
   err = -rt_cond_delete(&c_);
@@ -37,15 +56,19 @@ condition_variable::~condition_variable()
 
   if (err)
   {
-    fprintf(stderr, "pthread_cond_destroy: %s\n", strerror(err));
+    log::error("pthread_cond_destroy: %s", strerror(err));
   }
 }
 
 void condition_variable::notify_all()
 {
+  RTXX_TRACE(post, this, 0);
   int err;
 
-#if defined(RTXX_USE_POSIX)
+#if defined(RTXX_USE_SIM)
+  sim::detail::notify(c_, true);
+  err = 0;
+#elif defined(RTXX_USE_POSIX)
   err = pthread_cond_broadcast(&c_);
 #elif defined(RTXX_USE_ALCHEMY)
   err = -rt_cond_broadcast(&c_);
@@ -57,9 +80,13 @@ void condition_variable::notify_all()
 
 void condition_variable::notify_one()
 {
+  RTXX_TRACE(post, this, 0);
   int err;
 
-#if defined(RTXX_USE_POSIX)
+#if defined(RTXX_USE_SIM)
+  sim::detail::notify(c_, false);
+  err = 0;
+#elif defined(RTXX_USE_POSIX)
   err = pthread_cond_signal(&c_);
 #elif defined(RTXX_USE_ALCHEMY)
   err = -rt_cond_signal(&c_);
@@ -73,11 +100,21 @@ bool condition_variable::wait(std::unique_lock<mutex> &lock)
 {
   int err;
 
-#if defined(RTXX_USE_POSIX)
+  RTXX_TRACE(lock_release, lock.mutex(), 0);
+  RTXX_TRACE(wait_begin, this, 0);
+  if (lock.mutex()->stats_)
+    lock.mutex()->profile_released();
+#if defined(RTXX_USE_SIM)
+  err = sim::detail::cond_wait(c_, *lock.mutex()->native_handle(), -1);
+#elif defined(RTXX_USE_POSIX)
   err = pthread_cond_wait(&c_, lock.mutex()->native_handle());
 #elif defined(RTXX_USE_ALCHEMY)
   err = -rt_cond_wait(&c_, lock.mutex()->native_handle(), TM_INFINITE);
 #endif
+  RTXX_TRACE(wait_end, this, 0);
+  RTXX_TRACE(lock_acquire, lock.mutex(), 0);
+  if (lock.mutex()->stats_)
+    lock.mutex()->profile_reacquired();
 
   if (err == 0)
     return true;
@@ -90,14 +127,40 @@ bool condition_variable::wait(std::unique_lock<mutex> &lock)
 
 bool condition_variable::wait_until(std::unique_lock<mutex> &lock,
                                     const struct timespec *abs_time)
+{
+  // Alchemy ignores the clock, it has a single timeline.
+  return clock_wait(lock, CLOCK_REALTIME, abs_time);
+}
+
+bool condition_variable::clock_wait(std::unique_lock<mutex> &lock,
+                                    clockid_t clock,
+                                    const struct timespec *abs_time)
 {
   int err;
 
-#if defined(RTXX_USE_POSIX)
-  err = pthread_cond_timedwait(&c_, lock.mutex()->native_handle(), abs_time);
+  RTXX_TRACE(lock_release, lock.mutex(), 0);
+  RTXX_TRACE(wait_begin, this, 0);
+  if (lock.mutex()->stats_)
+    lock.mutex()->profile_released();
+#if defined(RTXX_USE_SIM)
+  (void)clock;
+  err = sim::detail::cond_wait(c_, *lock.mutex()->native_handle(),
+                               sim::detail::to_ns(abs_time));
+#elif defined(RTXX_USE_POSIX) && defined(RTXX_HAVE_CLOCKWAIT)
+  err = pthread_cond_clockwait(&c_, lock.mutex()->native_handle(), clock,
+                               abs_time);
+#elif defined(RTXX_USE_POSIX)
+  const struct timespec ts =
+      detail::convert_timespec(clock, CLOCK_MONOTONIC, *abs_time);
+  err = pthread_cond_timedwait(&c_, lock.mutex()->native_handle(), &ts);
 #elif defined(RTXX_USE_ALCHEMY)
-  err = -rt_cond_wait(&c_, lock.mutex()->native_handle(), TM_INFINITE);
+  (void)clock;
+  err = -rt_cond_wait_timed(&c_, lock.mutex()->native_handle(), abs_time);
 #endif
+  RTXX_TRACE(wait_end, this, err == ETIMEDOUT);
+  RTXX_TRACE(lock_acquire, lock.mutex(), 0);
+  if (lock.mutex()->stats_)
+    lock.mutex()->profile_reacquired();
 
   if (err == 0)
     return true;
@@ -6,39 +6,39 @@
 
 namespace rtxx
 {
+template <typename... Initializers>
+constexpr condition_variable::options::options(Initializers &&... init) noexcept
+{
+  (init(this), ...);
+}
+
 template <typename Rep, typename Period>
 bool condition_variable::wait_for(std::unique_lock<mutex> &lock,
                                   chrono::duration<Rep, Period> const &rel_time)
 {
-#ifdef RTXX_USE_POSIX
-  return wait_until(lock, realtime_clock::now() + rel_time);
-#elif defined(RTXX_USE_ALCHEMY)
   return wait_until(lock, monotonic_clock::now() + rel_time);
-#endif
 }
 
-#ifdef RTXX_USE_POSIX
 template <typename Clock, typename Duration>
 bool condition_variable::wait_until(
     std::unique_lock<mutex> &lock,
     chrono::time_point<Clock, Duration> const &abs_time)
 {
-  static_assert(std::is_same<Clock, realtime_clock>(),
-                "Currently only realtime_clock is supported");
   const auto ts = detail::duration_to_timespec(abs_time.time_since_epoch());
-  return wait_until(lock, &ts);
+  return clock_wait(lock, detail::wait_clockid<Clock>(), &ts);
 }
-#elif defined(RTXX_USE_ALCHEMY)
-template <typename Clock, typename Duration>
-bool condition_variable::wait_until(
-    std::unique_lock<mutex> &lock,
-    chrono::time_point<Clock, Duration> const &abs_time)
+
+inline bool condition_variable::wait_until(std::unique_lock<mutex> &lock,
+                                           const deadline &d)
 {
-  static_assert(std::is_same<Clock, monotonic_clock>(),
-                "Currently only monotonic clock is supported");
-  const auto ts = detail::duration_to_timespec(abs_time.time_since_epoch());
-  return wait_until(lock, &ts);
+  return clock_wait(lock, CLOCK_MONOTONIC, d.as_timespec());
+}
+
+inline bool condition_variable::wait_until(std::unique_lock<mutex> &lock,
+                                           clockid_t clock,
+                                           const struct timespec *abs_time)
+{
+  return clock_wait(lock, clock, abs_time);
 }
-#endif
 
 } // namespace rtxx
\ No newline at end of file
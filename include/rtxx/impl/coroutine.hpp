@@ -0,0 +1,365 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <exception>
+#include <functional>
+#include <new>
+#include <rtxx/coroutine.hpp>
+#include <utility>
+
+#if defined(RTXX_USE_SIM)
+#include <rtxx/impl/sim.hpp>
+#elif defined(RTXX_USE_POSIX)
+#include <rtxx/impl/futex.hpp>
+#elif defined(RTXX_USE_ALCHEMY)
+#include <alchemy/task.h>
+#include <alchemy/timer.h>
+#endif
+
+namespace rtxx
+{
+namespace detail
+{
+/// Scheduler spawning or running coroutines on the calling thread.
+inline co_scheduler *&current_scheduler() noexcept
+{
+  thread_local co_scheduler *s = nullptr;
+  return s;
+}
+
+/// Coroutine being resumed on the calling thread.
+inline co_task::promise_type *&current_coroutine() noexcept
+{
+  thread_local co_task::promise_type *p = nullptr;
+  return p;
+}
+
+/// Sets the current scheduler for the lifetime of the object.
+struct scheduler_scope
+{
+  explicit scheduler_scope(co_scheduler *s) noexcept
+      : prev(std::exchange(current_scheduler(), s))
+  {
+  }
+  ~scheduler_scope() { current_scheduler() = prev; }
+
+  co_scheduler *prev;
+};
+
+/// Room kept in front of each frame for its scheduler.
+constexpr std::size_t frame_header = alignof(std::max_align_t);
+} // namespace detail
+
+inline void *co_task::promise_type::operator new(std::size_t size)
+{
+  co_scheduler *s = detail::current_scheduler();
+  if (!s)
+    throw std::bad_alloc();
+
+  void *p = s->frames_.allocate(size + detail::frame_header);
+  *static_cast<co_scheduler **>(p) = s;
+  return static_cast<unsigned char *>(p) + detail::frame_header;
+}
+
+inline void co_task::promise_type::operator delete(void *p,
+                                                   std::size_t size) noexcept
+{
+  void *base = static_cast<unsigned char *>(p) - detail::frame_header;
+  co_scheduler *s = *static_cast<co_scheduler **>(base);
+  s->frames_.deallocate(base, size + detail::frame_header);
+}
+
+inline co_task co_task::promise_type::get_return_object() noexcept
+{
+  return co_task(handle_type::from_promise(*this));
+}
+
+inline void co_task::promise_type::unhandled_exception() noexcept
+{
+  std::terminate();
+}
+
+inline co_task::co_task(co_task &&other) noexcept
+    : h_(std::exchange(other.h_, nullptr))
+{
+}
+
+inline co_task::~co_task()
+{
+  if (h_)
+    h_.destroy();
+}
+
+inline void co_semaphore::post()
+{
+  sem_.post();
+
+#if defined(RTXX_USE_POSIX) && !defined(RTXX_USE_SIM)
+  // Orders the post before reading the listener, as co_scheduler orders
+  // setting it before polling the semaphore.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (auto *bell = listener_.load(std::memory_order_relaxed))
+  {
+    bell->fetch_add(1, std::memory_order_release);
+    detail::futex_wake(bell, 1, false);
+  }
+#endif
+}
+
+template <typename... Initializers>
+constexpr co_scheduler::options::options(Initializers &&... init) noexcept
+{
+  (init(this), ...);
+}
+
+inline co_scheduler::co_scheduler(const options &opt)
+    : frames_(opt.frame_size + detail::frame_header, opt.max_coroutines),
+      poll_interval_(opt.poll_interval)
+{
+  ready_.reserve(opt.max_coroutines);
+  waiters_.reserve(opt.max_coroutines);
+}
+
+inline co_scheduler::~co_scheduler()
+{
+  for (auto &e : ready_)
+    e.h.destroy();
+  for (auto &w : waiters_)
+  {
+    if (w.notified)
+      unlisten(w.listener);
+    w.h.destroy();
+  }
+}
+
+template <typename F, typename... Args>
+void co_scheduler::spawn(F &&f, Args &&... args)
+{
+  const detail::scheduler_scope scope(this);
+  co_task t = std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+
+  const auto h = std::exchange(t.h_, nullptr);
+  h.promise().sched = this;
+  ++live_;
+  schedule(h, monotonic_clock::now());
+}
+
+inline void co_scheduler::run()
+{
+  const detail::scheduler_scope scope(this);
+
+  for (;;)
+  {
+    // Read before stop_ and the semaphores, so that a stop() or post()
+    // coming after them moves the doorbell and cuts the sleep short.
+    const auto bell = doorbell_.load(std::memory_order_acquire);
+    if (stop_.load(std::memory_order_acquire) ||
+        (ready_.empty() && waiters_.empty()))
+      break;
+
+    const auto now = monotonic_clock::now();
+    poll(now);
+
+    if (!ready_.empty() && ready_.front().release <= now)
+    {
+      std::pop_heap(ready_.begin(), ready_.end());
+      const auto h = ready_.back().h;
+      ready_.pop_back();
+
+      detail::current_coroutine() = &h.promise();
+      h.resume();
+      detail::current_coroutine() = nullptr;
+
+      if (h.done())
+      {
+        h.destroy();
+        --live_;
+      }
+      continue;
+    }
+
+    auto wake = ready_.empty() ? monotonic_clock::time_point::max()
+                               : ready_.front().release;
+    for (const auto &w : waiters_)
+      wake = std::min(wake, w.notified ? w.deadline : now + poll_interval_);
+    sleep_until(wake, bell);
+  }
+}
+
+inline void co_scheduler::stop() noexcept
+{
+  stop_.store(true, std::memory_order_release);
+  ring();
+}
+
+inline void co_scheduler::ring() noexcept
+{
+  doorbell_.fetch_add(1, std::memory_order_release);
+#if defined(RTXX_USE_POSIX) && !defined(RTXX_USE_SIM)
+  detail::futex_wake(&doorbell_, 1, false);
+#endif
+}
+
+inline void co_scheduler::schedule(co_task::handle_type h,
+                                   monotonic_clock::time_point release) noexcept
+{
+  ready_.push_back(entry{release, seq_++, h});
+  std::push_heap(ready_.begin(), ready_.end());
+}
+
+inline void co_scheduler::wait(co_task::handle_type h, semaphore &sem,
+                               listener_type *listener,
+                               monotonic_clock::time_point deadline,
+                               bool *acquired) noexcept
+{
+  waiters_.push_back(
+      waiter{h, &sem, listener, deadline, acquired, listen(listener)});
+}
+
+inline void co_scheduler::poll(monotonic_clock::time_point now) noexcept
+{
+  for (std::size_t i = 0; i < waiters_.size();)
+  {
+    waiter &w = waiters_[i];
+    const bool acquired = w.sem->try_wait();
+    if (!acquired && now < w.deadline)
+    {
+      ++i;
+      continue;
+    }
+
+    *w.acquired = acquired;
+    schedule(w.h, now);
+    listener_type *listener = w.notified ? w.listener : nullptr;
+    w = waiters_.back();
+    waiters_.pop_back();
+    if (listener)
+      unlisten(listener);
+  }
+}
+
+inline bool
+co_scheduler::listen([[maybe_unused]] listener_type *listener) noexcept
+{
+#if defined(RTXX_USE_POSIX) && !defined(RTXX_USE_SIM)
+  if (!listener)
+    return false;
+
+  // Another scheduler already listening keeps the semaphore, this one
+  // polls it.
+  std::atomic<std::uint32_t> *expected = nullptr;
+  if (!listener->compare_exchange_strong(expected, &doorbell_) &&
+      expected != &doorbell_)
+    return false;
+
+  // Orders setting the listener before the next poll, see
+  // co_semaphore::post().
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  return true;
+#else
+  return false;
+#endif
+}
+
+inline void
+co_scheduler::unlisten([[maybe_unused]] listener_type *listener) noexcept
+{
+#if defined(RTXX_USE_POSIX) && !defined(RTXX_USE_SIM)
+  for (const auto &w : waiters_)
+    if (w.listener == listener && w.notified)
+      return;
+
+  std::atomic<std::uint32_t> *expected = &doorbell_;
+  listener->compare_exchange_strong(expected, nullptr);
+#endif
+}
+
+inline void co_scheduler::sleep_until(
+    monotonic_clock::time_point t, [[maybe_unused]] std::uint32_t bell) noexcept
+{
+  const auto ns = t.time_since_epoch();
+#if defined(RTXX_USE_SIM)
+  sim::detail::sleep_until(
+      chrono::duration_cast<chrono::nanoseconds>(ns).count());
+#elif defined(RTXX_USE_POSIX)
+  // Spurious returns are fine, run() checks everything again.
+  const auto ts = detail::duration_to_timespec(ns);
+  detail::futex_wait_bitset(&doorbell_, bell,
+                            t == monotonic_clock::time_point::max() ? nullptr
+                                                                    : &ts,
+                            FUTEX_BITSET_MATCH_ANY, false, false);
+#elif defined(RTXX_USE_ALCHEMY)
+  rt_task_sleep_until(rt_timer_ns2ticks(
+      chrono::duration_cast<chrono::nanoseconds>(ns).count()));
+#else
+#error "not implemented"
+#endif
+}
+
+namespace this_coroutine
+{
+inline void set_periodic(monotonic_clock::time_point start,
+                         chrono::nanoseconds interval) noexcept
+{
+  co_task::promise_type *p = detail::current_coroutine();
+  assert(p && interval.count() > 0);
+  p->release = start - interval;
+  p->period = interval;
+}
+
+inline void wait_period::await_suspend(co_task::handle_type h) noexcept
+{
+  auto &p = h.promise();
+  assert(p.period.count() > 0);
+
+  auto next = p.release + p.period;
+  const auto now = monotonic_clock::now();
+  if (next <= now)
+  {
+    // Resume at once, from the last release point which has passed.
+    missed = static_cast<unsigned>((now - next) / p.period);
+    next += missed * p.period;
+  }
+
+  p.release = next;
+  p.sched->schedule(h, next);
+}
+
+inline void sleep_until::await_suspend(co_task::handle_type h) noexcept
+{
+  h.promise().sched->schedule(h, time);
+}
+
+inline void acquire::await_suspend(co_task::handle_type h) noexcept
+{
+  h.promise().sched->wait(h, sem, listener, deadline, &acquired);
+}
+} // namespace this_coroutine
+
+constexpr auto max_coroutines(std::size_t n)
+{
+  return [n](co_scheduler::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->max_coroutines = n;
+  };
+}
+
+constexpr auto frame_size(std::size_t bytes)
+{
+  return [bytes](co_scheduler::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->frame_size = bytes;
+  };
+}
+
+constexpr auto poll_interval(chrono::nanoseconds interval)
+{
+  return [interval](co_scheduler::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->poll_interval = interval;
+  };
+}
+
+} // namespace rtxx
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cassert>
+#include <rtxx/cpu_mask.hpp>
+
+namespace rtxx
+{
+inline cpu_mask::cpu_mask(std::initializer_list<int> cpus) noexcept : set_{}
+{
+  for (int cpu : cpus)
+    set(cpu);
+}
+
+inline cpu_mask::cpu_mask(const cpu_set_t &set) noexcept : set_(set) {}
+
+inline void cpu_mask::set(int cpu) noexcept
+{
+  if (cpu >= 0 && cpu < max_cpus)
+    CPU_SET(cpu, &set_);
+}
+
+inline void cpu_mask::reset(int cpu) noexcept
+{
+  if (cpu >= 0 && cpu < max_cpus)
+    CPU_CLR(cpu, &set_);
+}
+
+inline bool cpu_mask::test(int cpu) const noexcept
+{
+  return cpu >= 0 && cpu < max_cpus && CPU_ISSET(cpu, &set_);
+}
+
+inline int cpu_mask::count() const noexcept { return CPU_COUNT(&set_); }
+
+inline bool cpu_mask::empty() const noexcept { return count() == 0; }
+
+inline int cpu_mask::first() const noexcept { return next(-1); }
+
+inline int cpu_mask::next(int cpu) const noexcept
+{
+  for (++cpu; cpu < max_cpus; ++cpu)
+    if (CPU_ISSET(cpu, &set_))
+      return cpu;
+  return -1;
+}
+
+inline cpu_mask &cpu_mask::operator&=(const cpu_mask &other) noexcept
+{
+  CPU_AND(&set_, &set_, &other.set_);
+  return *this;
+}
+
+inline cpu_mask &cpu_mask::operator|=(const cpu_mask &other) noexcept
+{
+  CPU_OR(&set_, &set_, &other.set_);
+  return *this;
+}
+
+inline cpu_mask &cpu_mask::operator-=(const cpu_mask &other) noexcept
+{
+  cpu_set_t both;
+  CPU_AND(&both, &set_, &other.set_);
+  CPU_XOR(&set_, &set_, &both);
+  return *this;
+}
+
+inline cpu_mask operator&(cpu_mask a, const cpu_mask &b) noexcept
+{
+  return a &= b;
+}
+
+inline cpu_mask operator|(cpu_mask a, const cpu_mask &b) noexcept
+{
+  return a |= b;
+}
+
+inline cpu_mask operator-(cpu_mask a, const cpu_mask &b) noexcept
+{
+  return a -= b;
+}
+
+inline bool operator==(const cpu_mask &a, const cpu_mask &b) noexcept
+{
+  return CPU_EQUAL(a.native_handle(), b.native_handle());
+}
+
+inline bool operator!=(const cpu_mask &a, const cpu_mask &b) noexcept
+{
+  return !(a == b);
+}
+
+constexpr auto affinity(const cpu_mask &cpus)
+{
+  return [cpus](auto *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->affinity = cpus;
+  };
+}
+} // namespace rtxx
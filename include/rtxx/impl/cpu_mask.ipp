@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <rtxx/cpu_mask.hpp>
+
+namespace rtxx
+{
+cpu_mask cpu_mask::parse(const char *list)
+{
+  error_code ec;
+  cpu_mask m = parse(list, ec);
+  if (ec)
+    throw system_error(ec, "cpu_mask::parse");
+  return m;
+}
+
+cpu_mask cpu_mask::parse(const char *list, error_code &ec) noexcept
+{
+  cpu_mask m;
+  const char *p = list;
+
+  auto skip_space = [&p] {
+    while (std::isspace(static_cast<unsigned char>(*p)))
+      ++p;
+  };
+  auto number = [&p](long &value) {
+    if (!std::isdigit(static_cast<unsigned char>(*p)))
+      return false;
+    char *end;
+    value = std::strtol(p, &end, 10);
+    p = end;
+    return value < max_cpus;
+  };
+  auto invalid = [&ec] {
+    ec.assign(EINVAL, system_category());
+    return cpu_mask();
+  };
+
+  skip_space();
+  while (*p)
+  {
+    long lo, hi;
+    if (!number(lo))
+      return invalid();
+    hi = lo;
+    if (*p == '-')
+    {
+      ++p;
+      if (!number(hi) || hi < lo)
+        return invalid();
+    }
+
+    for (long cpu = lo; cpu <= hi; ++cpu)
+      m.set(int(cpu));
+
+    if (*p == ',')
+      ++p;
+    else
+    {
+      skip_space();
+      if (*p)
+        return invalid();
+    }
+  }
+
+  ec.clear();
+  return m;
+}
+} // namespace rtxx
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <rtxx/cyclic_executor.hpp>
+#include <rtxx/error.hpp>
+#include <rtxx/log.hpp>
+
+namespace rtxx
+{
+cyclic_executor::cyclic_executor() = default;
+
+cyclic_executor::~cyclic_executor()
+{
+  if (task_)
+    stop();
+}
+
+std::size_t cyclic_executor::add_job(const char *name,
+                                     chrono::nanoseconds period,
+                                     chrono::nanoseconds offset,
+                                     std::function<void()> fn)
+{
+  if (task_)
+    throw system_error(make_error_code(errc::device_or_resource_busy),
+                       "cyclic_executor::add_job");
+
+  jobs_.push_back(job{name, period, offset, std::move(fn)});
+  return jobs_.size() - 1;
+}
+
+void cyclic_executor::build_schedule(error_code &ec)
+{
+  frames_.clear();
+  frame_begin_.clear();
+
+  if (jobs_.empty())
+    return ec.assign(EINVAL, system_category());
+
+  std::vector<std::size_t> order(jobs_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [this](std::size_t a, std::size_t b) {
+                     return jobs_[a].period < jobs_[b].period;
+                   });
+
+  chrono::nanoseconds::rep minor = 0;
+  for (std::size_t i = 0; i != order.size(); ++i)
+  {
+    const job &j = jobs_[order[i]];
+    if (j.period.count() <= 0 || j.offset.count() < 0 || j.offset >= j.period)
+      return ec.assign(EINVAL, system_category());
+
+    if (i > 0 && j.period.count() % jobs_[order[i - 1]].period.count() != 0)
+      return ec.assign(EINVAL, system_category());
+
+    minor = std::gcd(minor, j.period.count());
+    minor = std::gcd(minor, j.offset.count());
+  }
+
+  minor_ = chrono::nanoseconds(minor);
+  major_ = jobs_[order.back()].period;
+
+  const auto nframes = major_ / minor_;
+  for (chrono::nanoseconds::rep k = 0; k != nframes; ++k)
+  {
+    frame_begin_.push_back(frames_.size());
+    for (auto i : order)
+    {
+      const job &j = jobs_[i];
+      if ((k * minor_) % j.period == j.offset)
+        frames_.push_back(i);
+    }
+  }
+  frame_begin_.push_back(frames_.size());
+  ec.clear();
+}
+
+void cyclic_executor::start(const task::options &opt)
+{
+  error_code ec;
+  start(opt, ec);
+  if (ec)
+    throw system_error(ec, "cyclic_executor::start");
+}
+
+void cyclic_executor::start(const task::options &opt, error_code &ec)
+{
+  if (task_)
+    return ec.assign(EBUSY, system_category());
+
+  build_schedule(ec);
+  if (ec)
+    return;
+
+  counters_.reset(new counters[jobs_.size()]);
+  frame_overruns_.store(0, std::memory_order_relaxed);
+  stop_.store(false, std::memory_order_relaxed);
+
+  try
+  {
+    task_.reset(new task(opt, [this] { run(); }));
+  }
+  catch (const system_error &e)
+  {
+    ec = e.code();
+  }
+}
+
+void cyclic_executor::stop()
+{
+  stop_.store(true, std::memory_order_relaxed);
+  if (task_)
+  {
+    task_->join();
+    task_.reset();
+  }
+}
+
+void cyclic_executor::run() noexcept
+{
+  const std::size_t nframes = frame_begin_.size() - 1;
+  auto release = monotonic_clock::now() + minor_;
+
+  error_code ec;
+  this_task::set_periodic(release, minor_, ec);
+  if (ec)
+  {
+    log::error("cyclic_executor::run: %s", ec.message().c_str());
+    return;
+  }
+
+  for (unsigned long frame = 0; !stop_.load(std::memory_order_relaxed);
+       ++frame, release += minor_)
+  {
+    const unsigned missed = this_task::wait_period(ec);
+    if (ec && ec != errc::timed_out)
+    {
+      log::error("cyclic_executor::run: %s", ec.message().c_str());
+      return;
+    }
+
+    if (missed)
+    {
+      frame_overruns_.fetch_add(missed, std::memory_order_relaxed);
+      for (unsigned m = 0; m != missed; ++m, ++frame, release += minor_)
+      {
+        const auto k = frame % nframes;
+        for (auto i = frame_begin_[k]; i != frame_begin_[k + 1]; ++i)
+          counters_[frames_[i]].skipped.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    const auto k = frame % nframes;
+    for (auto i = frame_begin_[k]; i != frame_begin_[k + 1]; ++i)
+    {
+      const job &j = jobs_[frames_[i]];
+      counters &c = counters_[frames_[i]];
+
+      const auto st = monotonic_clock::now();
+      j.fn();
+      const auto nd = monotonic_clock::now();
+
+      const auto exec = (nd - st).count();
+      if (exec > c.max_exec_time.load(std::memory_order_relaxed))
+        c.max_exec_time.store(exec, std::memory_order_relaxed);
+
+      if (nd > release + j.period)
+        c.overruns.fetch_add(1, std::memory_order_relaxed);
+      c.runs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+bool cyclic_executor::running() const noexcept { return task_ != nullptr; }
+
+chrono::nanoseconds cyclic_executor::minor_frame() const noexcept
+{
+  return minor_;
+}
+
+chrono::nanoseconds cyclic_executor::major_frame() const noexcept
+{
+  return major_;
+}
+
+std::size_t cyclic_executor::job_count() const noexcept
+{
+  return jobs_.size();
+}
+
+const char *cyclic_executor::job_name(std::size_t job) const
+{
+  return jobs_.at(job).name;
+}
+
+cyclic_executor::job_stats cyclic_executor::stats(std::size_t job) const
+{
+  if (job >= jobs_.size() || !counters_)
+    throw system_error(make_error_code(errc::invalid_argument),
+                       "cyclic_executor::stats");
+
+  const counters &c = counters_[job];
+  return {
+      c.runs.load(std::memory_order_relaxed),
+      c.overruns.load(std::memory_order_relaxed),
+      c.skipped.load(std::memory_order_relaxed),
+      chrono::nanoseconds(c.max_exec_time.load(std::memory_order_relaxed)),
+  };
+}
+
+unsigned long cyclic_executor::frame_overruns() const noexcept
+{
+  return frame_overruns_.load(std::memory_order_relaxed);
+}
+
+} // namespace rtxx
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstring>
+#include <rtxx/error.hpp>
+#include <rtxx/event_flags.hpp>
+#include <rtxx/impl/futex.hpp>
+#include <rtxx/log.hpp>
+#include <rtxx/trace.hpp>
+
+namespace rtxx
+{
+event_flags::event_flags(mask_type init) : event_flags(init, options{}) {}
+
+#if defined(RTXX_USE_POSIX)
+event_flags::event_flags(mask_type init, const options &opt)
+    : flags_(init), shared_(opt.process_shared)
+{
+}
+
+event_flags::~event_flags() = default;
+
+event_flags::mask_type event_flags::set(mask_type flags)
+{
+  const mask_type old = flags_.fetch_or(flags, std::memory_order_seq_cst);
+  const mask_type raised = flags & ~old;
+  if (raised && waiters_.load(std::memory_order_seq_cst))
+  {
+    RTXX_TRACE(post, this, 0);
+    detail::futex_wake_bitset(&flags_, raised, shared_);
+  }
+  return old;
+}
+
+event_flags::mask_type event_flags::clear(mask_type flags)
+{
+  return flags_.fetch_and(~flags, std::memory_order_release);
+}
+
+event_flags::mask_type event_flags::get() const
+{
+  return flags_.load(std::memory_order_acquire);
+}
+
+event_flags::mask_type event_flags::clock_wait(mask_type mask, bool all,
+                                               clockid_t clock,
+                                               const struct timespec *abs_timeout)
+{
+  if (!mask)
+    throw system_error(make_error_code(errc::invalid_argument),
+                       "event_flags::wait");
+
+  // The missing flags, or none once the wait is satisfied.
+  auto missing = [mask, all](mask_type f) -> mask_type {
+    if (all)
+      return mask & ~f;
+    return f & mask ? 0 : mask;
+  };
+
+  mask_type f = flags_.load(std::memory_order_acquire);
+  if (!missing(f))
+    return all ? mask : f & mask;
+
+  RTXX_TRACE(wait_begin, this, 0);
+  waiters_.fetch_add(1, std::memory_order_seq_cst);
+  int err = 0;
+  for (;;)
+  {
+    f = flags_.load(std::memory_order_seq_cst);
+    const mask_type bits = missing(f);
+    if (!bits || err == ETIMEDOUT)
+      break;
+
+    // Only a set() of one of the missing flags wakes this task.
+    err = detail::futex_wait_bitset(&flags_, f, abs_timeout, bits,
+                                    clock == CLOCK_REALTIME, shared_);
+    if (err && err != EAGAIN && err != EINTR && err != ETIMEDOUT)
+    {
+      waiters_.fetch_sub(1, std::memory_order_relaxed);
+      RTXX_TRACE(wait_end, this, 1);
+      throw system_error(err, system_category(), "event_flags::wait");
+    }
+  }
+  waiters_.fetch_sub(1, std::memory_order_relaxed);
+
+  const bool satisfied = !missing(f);
+  RTXX_TRACE(wait_end, this, !satisfied);
+  if (!satisfied)
+    return 0;
+  return all ? mask : f & mask;
+}
+
+#elif defined(RTXX_USE_ALCHEMY)
+
+event_flags::event_flags(mask_type init, const options &opt)
+{
+  if (opt.process_shared)
+    throw system_error(ENOTSUP, system_category(), "event_flags::event_flags");
+
+  int err = rt_event_create(&event_, nullptr, init, EV_PRIO);
+  if (err)
+    throw system_error(-err, system_category(), "event_flags::event_flags");
+}
+
+event_flags::~event_flags()
+{
+  int err = rt_event_delete(&event_);
+  if (err)
+    log::error("event_flags::~event_flags: %s", strerror(-err));
+}
+
+event_flags::mask_type event_flags::set(mask_type flags)
+{
+  const mask_type old = get();
+  RTXX_TRACE(post, this, 0);
+  int err = rt_event_signal(&event_, flags);
+  if (err)
+    throw system_error(-err, system_category(), "event_flags::set");
+  return old;
+}
+
+event_flags::mask_type event_flags::clear(mask_type flags)
+{
+  unsigned int old;
+  int err = rt_event_clear(&event_, flags, &old);
+  if (err)
+    throw system_error(-err, system_category(), "event_flags::clear");
+  return old;
+}
+
+event_flags::mask_type event_flags::get() const
+{
+  RT_EVENT_INFO info;
+  int err = rt_event_inquire(const_cast<RT_EVENT *>(&event_), &info);
+  if (err)
+    throw system_error(-err, system_category(), "event_flags::get");
+  return info.value;
+}
+
+event_flags::mask_type event_flags::clock_wait(mask_type mask, bool all,
+                                               clockid_t,
+                                               const struct timespec *abs_timeout)
+{
+  if (!mask)
+    throw system_error(make_error_code(errc::invalid_argument),
+                       "event_flags::wait");
+
+  unsigned int got;
+  RTXX_TRACE(wait_begin, this, 0);
+  int err = rt_event_wait_timed(&event_, mask, &got, all ? EV_ALL : EV_ANY,
+                                abs_timeout);
+  RTXX_TRACE(wait_end, this, err != 0);
+
+  if (err == -ETIMEDOUT || err == -EWOULDBLOCK)
+    return 0;
+  if (err)
+    throw system_error(-err, system_category(), "event_flags::wait");
+  return all ? mask : got & mask;
+}
+
+#else
+#error "not implemented"
+#endif
+} // namespace rtxx
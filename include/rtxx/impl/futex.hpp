@@ -0,0 +1,70 @@
+#pragma once
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+
+namespace rtxx
+{
+namespace detail
+{
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+              "futex words must be plain 32-bit integers");
+
+/// Sleep while \c *word equals \c expected, at most \c timeout if not null.
+/** \c shared selects a futex usable across processes.
+ *  @returns 0, or an errno value such as \c EAGAIN or \c ETIMEDOUT
+ */
+inline int futex_wait(std::atomic<std::uint32_t> *word, std::uint32_t expected,
+                      const struct timespec *timeout, bool shared) noexcept
+{
+  const int op = shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE;
+  if (syscall(SYS_futex, word, op, expected, timeout, nullptr, 0) == -1)
+    return errno;
+  return 0;
+}
+
+/// Wake at most \c count tasks sleeping on \c *word.
+inline void futex_wake(std::atomic<std::uint32_t> *word, int count,
+                       bool shared) noexcept
+{
+  const int op = shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE;
+  syscall(SYS_futex, word, op, count, nullptr, nullptr, 0);
+}
+
+/// Sleep while \c *word equals \c expected, until a wake whose bitset
+/// intersects \c bits.
+/** \c abs_timeout, if not null, is an absolute time on \c CLOCK_MONOTONIC,
+ *  or on \c CLOCK_REALTIME when \c realtime is set. \c bits must not be
+ *  zero.
+ *  @returns 0, or an errno value such as \c EAGAIN or \c ETIMEDOUT
+ */
+inline int futex_wait_bitset(std::atomic<std::uint32_t> *word,
+                             std::uint32_t expected,
+                             const struct timespec *abs_timeout,
+                             std::uint32_t bits, bool realtime,
+                             bool shared) noexcept
+{
+  int op = shared ? FUTEX_WAIT_BITSET : FUTEX_WAIT_BITSET_PRIVATE;
+  if (realtime)
+    op |= FUTEX_CLOCK_REALTIME;
+  if (syscall(SYS_futex, word, op, expected, abs_timeout, nullptr, bits) == -1)
+    return errno;
+  return 0;
+}
+
+/// Wake all tasks sleeping on \c *word with a bitset intersecting \c bits.
+inline void futex_wake_bitset(std::atomic<std::uint32_t> *word,
+                              std::uint32_t bits, bool shared) noexcept
+{
+  const int op = shared ? FUTEX_WAKE_BITSET : FUTEX_WAKE_BITSET_PRIVATE;
+  syscall(SYS_futex, word, op, INT_MAX, nullptr, nullptr, bits);
+}
+} // namespace detail
+} // namespace rtxx
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cassert>
+#include <new>
+#include <rtxx/inplace_function.hpp>
+#include <utility>
+
+namespace rtxx
+{
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename F>
+const typename inplace_function<R(Args...), Capacity>::vtable
+    inplace_function<R(Args...), Capacity>::vtable_for = {
+        [](void *self, Args &&... args) -> R {
+          return (*static_cast<F *>(self))(std::forward<Args>(args)...);
+        },
+        [](void *dst, void *src) noexcept {
+          ::new (dst) F(std::move(*static_cast<F *>(src)));
+          static_cast<F *>(src)->~F();
+        },
+        [](void *self) noexcept { static_cast<F *>(self)->~F(); },
+};
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename F, typename>
+inplace_function<R(Args...), Capacity>::inplace_function(F &&f)
+{
+  using callable = std::decay_t<F>;
+  static_assert(sizeof(callable) <= Capacity,
+                "callable does not fit in inplace_function, increase its "
+                "capacity");
+  static_assert(alignof(callable) <= alignof(std::max_align_t),
+                "callable is over-aligned for inplace_function");
+  static_assert(std::is_nothrow_move_constructible<callable>::value,
+                "inplace_function requires a nothrow move constructible "
+                "callable");
+
+  ::new (static_cast<void *>(storage_)) callable(std::forward<F>(f));
+  vt_ = &vtable_for<callable>;
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inplace_function<R(Args...), Capacity>::inplace_function(
+    inplace_function &&other) noexcept
+{
+  if (other.vt_)
+  {
+    other.vt_->move(storage_, other.storage_);
+    vt_ = std::exchange(other.vt_, nullptr);
+  }
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inplace_function<R(Args...), Capacity> &
+inplace_function<R(Args...), Capacity>::operator=(
+    inplace_function &&other) noexcept
+{
+  if (this != &other)
+  {
+    reset();
+    if (other.vt_)
+    {
+      other.vt_->move(storage_, other.storage_);
+      vt_ = std::exchange(other.vt_, nullptr);
+    }
+  }
+  return *this;
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inplace_function<R(Args...), Capacity>::~inplace_function()
+{
+  reset();
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+R inplace_function<R(Args...), Capacity>::operator()(Args... args) const
+{
+  assert(vt_);
+  return vt_->invoke(storage_, std::forward<Args>(args)...);
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+void inplace_function<R(Args...), Capacity>::reset() noexcept
+{
+  if (vt_)
+    vt_->destroy(storage_);
+  vt_ = nullptr;
+}
+
+} // namespace rtxx
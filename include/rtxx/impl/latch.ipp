@@ -0,0 +1,73 @@
+#pragma once
+
+#include <climits>
+#include <cstring>
+#include <rtxx/error.hpp>
+#include <rtxx/impl/futex.hpp>
+#include <rtxx/latch.hpp>
+#include <rtxx/log.hpp>
+#include <rtxx/trace.hpp>
+
+namespace rtxx
+{
+latch::latch(unsigned count) : latch(count, options{}) {}
+
+latch::latch(unsigned count, const options &opt)
+    : count_(count), spin_(opt.spin.count())
+{
+#if defined(RTXX_USE_ALCHEMY)
+  int err = rt_event_create(&event_, nullptr, count ? 0 : 1, EV_PRIO);
+  if (err)
+    throw system_error(-err, system_category(), "latch::latch");
+#endif
+}
+
+latch::~latch()
+{
+#if defined(RTXX_USE_ALCHEMY)
+  int err = rt_event_delete(&event_);
+  if (err)
+    log::error("latch::~latch: %s", strerror(-err));
+#endif
+}
+
+void latch::count_down(unsigned n) noexcept
+{
+  if (count_.fetch_sub(n, std::memory_order_seq_cst) != n)
+    return;
+
+  RTXX_TRACE(post, this, 0);
+#if defined(RTXX_USE_POSIX)
+  if (sleepers_.load(std::memory_order_seq_cst))
+    detail::futex_wake(&count_, INT_MAX, false);
+#elif defined(RTXX_USE_ALCHEMY)
+  rt_event_signal(&event_, 1);
+#endif
+}
+
+void latch::wait() noexcept
+{
+  if (detail::spin_until([this] { return try_wait(); }, spin_))
+    return;
+
+  RTXX_TRACE(wait_begin, this, 0);
+#if defined(RTXX_USE_POSIX)
+  sleepers_.fetch_add(1, std::memory_order_seq_cst);
+  for (std::uint32_t c; (c = count_.load(std::memory_order_acquire)) != 0;)
+    detail::futex_wait(&count_, c, nullptr, false);
+  sleepers_.fetch_sub(1, std::memory_order_relaxed);
+#elif defined(RTXX_USE_ALCHEMY)
+  unsigned int mask;
+  while (!try_wait())
+    rt_event_wait(&event_, 1, &mask, EV_ANY, TM_INFINITE);
+#endif
+  RTXX_TRACE(wait_end, this, 0);
+}
+
+void latch::arrive_and_wait(unsigned n) noexcept
+{
+  count_down(n);
+  wait();
+}
+
+} // namespace rtxx
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <rtxx/latency_histogram.hpp>
+
+namespace rtxx
+{
+constexpr std::size_t
+latency_snapshot::bucket_index(std::uint64_t value) noexcept
+{
+  if (value < sub_bucket_count)
+    return value;
+
+  const unsigned msb = 63 - __builtin_clzll(value);
+  const unsigned shift = msb - sub_bucket_bits;
+  return (shift + 1) * sub_bucket_count +
+         ((value >> shift) & (sub_bucket_count - 1));
+}
+
+constexpr std::uint64_t
+latency_snapshot::bucket_lower(std::size_t index) noexcept
+{
+  if (index < sub_bucket_count)
+    return index;
+
+  const unsigned shift = index / sub_bucket_count - 1;
+  return (sub_bucket_count + index % sub_bucket_count) << shift;
+}
+
+constexpr std::uint64_t
+latency_snapshot::bucket_upper(std::size_t index) noexcept
+{
+  if (index + 1 == bucket_count)
+    return UINT64_MAX;
+  return bucket_lower(index + 1) - 1;
+}
+
+inline chrono::nanoseconds latency_snapshot::min() const noexcept
+{
+  return chrono::nanoseconds(min_);
+}
+
+inline chrono::nanoseconds latency_snapshot::max() const noexcept
+{
+  return chrono::nanoseconds(max_);
+}
+
+inline void latency_histogram::bump(std::atomic<std::uint64_t> &counter,
+                                    std::uint64_t n) noexcept
+{
+  counter.store(counter.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+}
+
+inline void latency_histogram::record(chrono::nanoseconds value) noexcept
+{
+  const std::uint64_t v = value.count() > 0 ? value.count() : 0;
+
+  bump(buckets_[latency_snapshot::bucket_index(v)], 1);
+  bump(sum_, v);
+  if (v < min_.load(std::memory_order_relaxed))
+    min_.store(v, std::memory_order_relaxed);
+  if (v > max_.load(std::memory_order_relaxed))
+    max_.store(v, std::memory_order_relaxed);
+
+  // Published last, so that a reader never sees more values counted than
+  // have been put in buckets.
+  count_.store(count_.load(std::memory_order_relaxed) + 1,
+               std::memory_order_release);
+}
+
+} // namespace rtxx
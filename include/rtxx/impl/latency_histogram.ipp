@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cmath>
+#include <rtxx/latency_histogram.hpp>
+
+namespace rtxx
+{
+chrono::nanoseconds latency_snapshot::mean() const noexcept
+{
+  if (count_ == 0)
+    return chrono::nanoseconds(0);
+  return chrono::nanoseconds(sum_ / count_);
+}
+
+chrono::nanoseconds latency_snapshot::percentile(double p) const noexcept
+{
+  if (count_ == 0)
+    return chrono::nanoseconds(0);
+
+  if (p < 0)
+    p = 0;
+  if (p > 1)
+    p = 1;
+
+  auto rank = static_cast<std::uint64_t>(std::ceil(p * count_));
+  if (rank == 0)
+    rank = 1;
+
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i != bucket_count; ++i)
+  {
+    seen += buckets_[i];
+    if (seen >= rank)
+    {
+      const auto upper = bucket_upper(i);
+      return chrono::nanoseconds(upper < max_ ? upper : max_);
+    }
+  }
+  return chrono::nanoseconds(max_);
+}
+
+latency_snapshot latency_histogram::snapshot() const noexcept
+{
+  latency_snapshot s;
+
+  s.count_ = count_.load(std::memory_order_acquire);
+  s.sum_ = sum_.load(std::memory_order_relaxed);
+  s.min_ = min_.load(std::memory_order_relaxed);
+  s.max_ = max_.load(std::memory_order_relaxed);
+
+  std::uint64_t total = 0;
+  for (std::size_t i = 0; i != latency_snapshot::bucket_count; ++i)
+  {
+    s.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += s.buckets_[i];
+  }
+
+  // Values recorded while copying are counted in the buckets only.
+  if (total > s.count_)
+    s.count_ = total;
+  if (s.count_ == 0)
+    s.min_ = 0;
+
+  return s;
+}
+
+} // namespace rtxx
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cassert>
+#include <rtxx/log.hpp>
+
+namespace rtxx
+{
+namespace log
+{
+template <typename... Initializers>
+constexpr options::options(Initializers &&... init) noexcept
+{
+  (init(this), ...);
+}
+} // namespace log
+
+constexpr auto log_buffer_size(std::size_t bytes)
+{
+  return [bytes](log::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->buffer_size = bytes;
+  };
+}
+
+constexpr auto log_fd(int fd)
+{
+  return [fd](log::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->fd = fd;
+  };
+}
+
+constexpr auto log_period(chrono::nanoseconds period)
+{
+  return [period](log::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->period = period;
+  };
+}
+
+constexpr auto log_level(log::level lv)
+{
+  return [lv](log::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->min_level = lv;
+  };
+}
+
+} // namespace rtxx
@@ -0,0 +1,507 @@
+#pragma once
+
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <rtxx/log.hpp>
+#include <utility>
+
+namespace rtxx
+{
+namespace log
+{
+namespace detail
+{
+/// Largest record, in words.
+constexpr std::size_t max_record_words =
+    header_words + max_args * (1 + (string_max + 7) / 8);
+
+/// Longest formatted line, longer ones are truncated.
+constexpr std::size_t max_line = 1024;
+
+/// Record buffer of a thread, written by it and read by the drain.
+struct ring
+{
+  explicit ring(std::size_t bytes)
+  {
+    std::size_t words = 1;
+    while (words < bytes / 8 || words < max_record_words)
+      words <<= 1;
+    mask = words - 1;
+    buf.reset(new std::uint64_t[words]);
+  }
+
+  /// Index of the next word to read, written by the drain only.
+  alignas(RTXX_CACHELINE_SIZE) std::atomic<std::uint64_t> head{0};
+
+  /// Index of the next word to write, written by the owner only.
+  alignas(RTXX_CACHELINE_SIZE) std::atomic<std::uint64_t> tail{0};
+  /// Owner's last observed value of \c head.
+  std::uint64_t head_cache{0};
+  /// Records dropped because the buffer was full.
+  std::atomic<unsigned long> overflows{0};
+
+  std::size_t mask;
+  std::unique_ptr<std::uint64_t[]> buf;
+
+  /// Next ring of the registry, guarded by its lock and changed by the
+  /// drain only once unlinked.
+  ring *next{};
+  /// Set when the owner exited, guarded by the registry lock.
+  bool orphaned{false};
+};
+
+/// Process-wide logging state.
+/** \c lock is taken by the logging threads, and only held to walk or
+ *  change the list of rings. \c drain_lock serializes the drains, which
+ *  format and write outside \c lock.
+ */
+struct registry
+{
+  std::mutex lock;
+  std::mutex drain_lock;
+  ring *rings{};
+  options opt{};
+  task *drain{};
+  std::atomic<bool> running{false};
+  std::atomic<bool> stop{false};
+  std::atomic<level> min_level{level::info};
+  /// Overflows of freed rings.
+  unsigned long retired{0};
+  /// Overflows already reported in the output, guarded by drain_lock.
+  unsigned long reported{0};
+
+  /// Output buffer, guarded by drain_lock.
+  char batch[8192];
+  std::size_t batch_used{0};
+};
+
+inline registry &state() noexcept
+{
+  static registry r;
+  return r;
+}
+
+/// Owner of the ring of the current thread, retired when the thread exits.
+struct thread_ring
+{
+  ring *r{};
+
+  ~thread_ring();
+};
+
+inline thread_ring &current() noexcept
+{
+  thread_local thread_ring t;
+  return t;
+}
+
+inline void write_all(int fd, const char *p, std::size_t n) noexcept
+{
+  while (n > 0)
+  {
+    const ssize_t w = ::write(fd, p, n);
+    if (w < 0 && errno == EINTR)
+      continue;
+    if (w <= 0)
+      return;
+    p += w;
+    n -= w;
+  }
+}
+
+/// Format one argument with the conversion \c spec, \c conv is its last char.
+inline int format_arg(char *out, std::size_t size, char *spec,
+                      std::size_t spec_len, char conv, unsigned kind,
+                      const std::uint64_t *&arg) noexcept
+{
+  // spec holds '%', flags, width and precision; append our own length
+  // modifier and conversion.
+  auto finish = [&](const char *tail) {
+    std::strcpy(spec + spec_len, tail);
+    return spec;
+  };
+
+  const bool integer_conv = std::strchr("diouxXc", conv) != nullptr;
+  const bool real_conv = std::strchr("fFeEgGaA", conv) != nullptr;
+
+  switch (kind)
+  {
+  case arg_sint:
+  case arg_uint:
+  {
+    const std::uint64_t v = *arg++;
+    if (real_conv)
+    {
+      const double d = kind == arg_sint ? double(static_cast<long long>(v))
+                                        : double(v);
+      const char tail[] = {conv, 0};
+      return snprintf(out, size, finish(tail), d);
+    }
+    if (conv == 'c')
+      return snprintf(out, size, finish("c"), int(v));
+    const char tail[] = {'l', 'l', integer_conv ? conv : 'd', 0};
+    return snprintf(out, size, finish(tail), static_cast<long long>(v));
+  }
+  case arg_real:
+  {
+    double d;
+    std::memcpy(&d, arg++, sizeof(d));
+    const char tail[] = {real_conv ? conv : 'g', 0};
+    return snprintf(out, size, finish(tail), d);
+  }
+  case arg_pointer:
+    return snprintf(out, size, finish("p"),
+                    reinterpret_cast<void *>(std::uintptr_t(*arg++)));
+  case arg_string:
+  {
+    const int len = int(*arg++);
+    const char *s = reinterpret_cast<const char *>(arg);
+    arg += (len + 7) / 8;
+    if (conv != 's')
+      return snprintf(out, size, "%.*s", len, s);
+    // Bound the copy, which is not null-terminated.
+    std::size_t n = spec_len;
+    if (!std::strchr(spec, '.'))
+      n += snprintf(spec + n, 16, ".%d", len);
+    std::strcpy(spec + n, "s");
+    return snprintf(out, size, spec, s);
+  }
+  default:
+    return 0;
+  }
+}
+
+/// Format a record as one line, returns its length.
+inline std::size_t format(const std::uint64_t *rec, char *out,
+                          std::size_t size) noexcept
+{
+  static const char levels[] = {'D', 'I', 'W', 'E'};
+
+  const unsigned lv = (rec[0] >> 32) & 0xff;
+  const unsigned nargs = (rec[0] >> 40) & 0xff;
+  const char *fmt = reinterpret_cast<const char *>(std::uintptr_t(rec[2]));
+  const std::uint64_t kinds = rec[3];
+  const std::uint64_t *arg = rec + header_words;
+
+  const std::size_t room = size - 1; // keep one byte for the newline
+  std::size_t n = 0;
+  auto advance = [&](int r) {
+    if (r > 0)
+      n = std::min(room, n + std::size_t(r));
+  };
+
+  advance(snprintf(out, size, "%llu.%06llu %c ",
+                   static_cast<unsigned long long>(rec[1] / 1000000000),
+                   static_cast<unsigned long long>(rec[1] % 1000000000 / 1000),
+                   levels[lv & 3]));
+
+  unsigned i = 0;
+  for (const char *p = fmt; *p && n < room;)
+  {
+    if (*p != '%')
+    {
+      out[n++] = *p++;
+      continue;
+    }
+    if (p[1] == '%')
+    {
+      out[n++] = '%';
+      p += 2;
+      continue;
+    }
+
+    char spec[32];
+    std::size_t spec_len = 0;
+    spec[spec_len++] = *p++;
+    while (*p && std::strchr("-+ #0123456789.", *p) && spec_len < 16)
+      spec[spec_len++] = *p++;
+    while (*p && std::strchr("hlLqjzt", *p))
+      ++p;
+    if (!*p)
+      break;
+    const char conv = *p++;
+    spec[spec_len] = 0;
+
+    if (i == nargs)
+    {
+      advance(snprintf(out + n, size - n, "%s%c", spec, conv));
+      continue;
+    }
+    const unsigned kind = (kinds >> (4 * i++)) & 0xf;
+    advance(format_arg(out + n, size - n, spec, spec_len, conv, kind, arg));
+  }
+
+  out[n++] = '\n';
+  return n;
+}
+
+/// Append the records of a ring to the batch. Called with the drain lock
+/// held.
+inline void drain_ring(registry &st, ring &r) noexcept
+{
+  std::uint64_t rec[max_record_words];
+  auto head = r.head.load(std::memory_order_relaxed);
+  const auto tail = r.tail.load(std::memory_order_acquire);
+
+  while (head != tail)
+  {
+    const std::size_t words = r.buf[head & r.mask] & 0xffffffff;
+    for (std::size_t i = 0; i != words; ++i)
+      rec[i] = r.buf[(head + i) & r.mask];
+    head += words;
+
+    if (sizeof(st.batch) - st.batch_used < max_line)
+    {
+      write_all(st.opt.fd, st.batch, st.batch_used);
+      st.batch_used = 0;
+    }
+    st.batch_used += format(rec, st.batch + st.batch_used, max_line);
+  }
+  r.head.store(head, std::memory_order_release);
+}
+
+/// Drain every ring, free the orphaned ones and write the batch. Called
+/// with the drain lock held.
+/** The registry lock is only held to unlink the orphaned rings, so that
+ *  logging threads never wait for formatting or I/O. Rings stay valid
+ *  meanwhile, as only a drain frees them.
+ */
+inline void drain_all(registry &st) noexcept
+{
+  ring *live, *orphans = nullptr;
+  unsigned long dropped;
+  {
+    std::lock_guard<std::mutex> lock(st.lock);
+    for (ring **link = &st.rings; *link;)
+    {
+      ring *r = *link;
+      if (r->orphaned)
+      {
+        st.retired += r->overflows.load(std::memory_order_relaxed);
+        *link = r->next;
+        r->next = orphans;
+        orphans = r;
+      }
+      else
+      {
+        link = &r->next;
+      }
+    }
+    live = st.rings;
+    dropped = st.retired;
+  }
+
+  for (ring *r = live; r; r = r->next)
+  {
+    drain_ring(st, *r);
+    dropped += r->overflows.load(std::memory_order_relaxed);
+  }
+  while (ring *r = orphans)
+  {
+    drain_ring(st, *r);
+    orphans = r->next;
+    delete r;
+  }
+
+  if (dropped != st.reported)
+  {
+    char line[64];
+    const int n = snprintf(line, sizeof(line), "rtxx::log: %lu dropped\n",
+                           dropped - st.reported);
+    st.reported = dropped;
+    if (sizeof(st.batch) - st.batch_used < sizeof(line))
+    {
+      write_all(st.opt.fd, st.batch, st.batch_used);
+      st.batch_used = 0;
+    }
+    std::memcpy(st.batch + st.batch_used, line, n);
+    st.batch_used += n;
+  }
+
+  write_all(st.opt.fd, st.batch, st.batch_used);
+  st.batch_used = 0;
+}
+
+inline thread_ring::~thread_ring()
+{
+  if (!r)
+    return;
+
+  registry &st = state();
+  {
+    std::lock_guard<std::mutex> lock(st.lock);
+    r->orphaned = true;
+  }
+  if (!st.running.load(std::memory_order_relaxed))
+  {
+    std::lock_guard<std::mutex> lock(st.drain_lock);
+    drain_all(st);
+  }
+}
+
+inline void run() noexcept
+{
+  registry &st = state();
+  const auto ts = rtxx::detail::duration_to_timespec(st.opt.period);
+  while (!st.stop.load(std::memory_order_relaxed))
+  {
+    {
+      std::lock_guard<std::mutex> lock(st.drain_lock);
+      drain_all(st);
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, nullptr) == EINTR)
+      ;
+  }
+}
+
+bool enabled(level lv) noexcept
+{
+  return lv >= state().min_level.load(std::memory_order_relaxed);
+}
+
+void submit(std::uint64_t *rec, std::size_t words) noexcept
+{
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  rec[1] = std::uint64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+
+  registry &st = state();
+  if (!st.running.load(std::memory_order_acquire))
+  {
+    char line[max_line];
+    write_all(st.opt.fd, line, format(rec, line, sizeof(line)));
+    return;
+  }
+
+  ring *r = current().r;
+  if (!r)
+  {
+    try
+    {
+      attach();
+    }
+    catch (const std::bad_alloc &)
+    {
+      return;
+    }
+    r = current().r;
+  }
+
+  const auto tail = r->tail.load(std::memory_order_relaxed);
+  if (r->mask + 1 - (tail - r->head_cache) < words)
+  {
+    r->head_cache = r->head.load(std::memory_order_acquire);
+    if (r->mask + 1 - (tail - r->head_cache) < words)
+    {
+      r->overflows.store(r->overflows.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+      return;
+    }
+  }
+
+  for (std::size_t i = 0; i != words; ++i)
+    r->buf[(tail + i) & r->mask] = rec[i];
+  r->tail.store(tail + words, std::memory_order_release);
+}
+} // namespace detail
+
+void start(const options &opt, const task::options &task_opt, error_code &ec)
+{
+  detail::registry &st = detail::state();
+  std::lock_guard<std::mutex> lock(st.lock);
+  if (st.drain)
+    return ec.assign(EBUSY, system_category());
+
+  st.opt = opt;
+  st.min_level.store(opt.min_level, std::memory_order_relaxed);
+  st.stop.store(false, std::memory_order_relaxed);
+  try
+  {
+    st.drain = new task(task_opt, [] { detail::run(); });
+  }
+  catch (const system_error &e)
+  {
+    ec = e.code();
+    return;
+  }
+  catch (const std::bad_alloc &)
+  {
+    return ec.assign(ENOMEM, system_category());
+  }
+  st.running.store(true, std::memory_order_release);
+  ec.clear();
+}
+
+void start(const options &opt, const task::options &task_opt)
+{
+  error_code ec;
+  start(opt, task_opt, ec);
+  if (ec)
+    throw system_error(ec, "log::start");
+}
+
+void stop()
+{
+  detail::registry &st = detail::state();
+  task *drain;
+  {
+    std::lock_guard<std::mutex> lock(st.lock);
+    drain = std::exchange(st.drain, nullptr);
+  }
+  if (!drain)
+    return;
+
+  st.stop.store(true, std::memory_order_relaxed);
+  drain->join();
+  delete drain;
+
+  std::lock_guard<std::mutex> lock(st.drain_lock);
+  st.running.store(false, std::memory_order_release);
+  detail::drain_all(st);
+}
+
+bool running() noexcept
+{
+  return detail::state().running.load(std::memory_order_relaxed);
+}
+
+void flush()
+{
+  detail::registry &st = detail::state();
+  std::lock_guard<std::mutex> lock(st.drain_lock);
+  detail::drain_all(st);
+}
+
+void attach()
+{
+  detail::thread_ring &t = detail::current();
+  if (t.r)
+    return;
+
+  detail::registry &st = detail::state();
+  std::lock_guard<std::mutex> lock(st.lock);
+  t.r = new detail::ring(st.opt.buffer_size);
+  t.r->next = st.rings;
+  st.rings = t.r;
+}
+
+unsigned long overflows() noexcept
+{
+  detail::registry &st = detail::state();
+  std::lock_guard<std::mutex> lock(st.lock);
+  unsigned long n = st.retired;
+  for (auto r = st.rings; r; r = r->next)
+    n += r->overflows.load(std::memory_order_relaxed);
+  return n;
+}
+} // namespace log
+} // namespace rtxx
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstring>
+#include <rtxx/log.hpp>
+#include <type_traits>
+
+namespace rtxx
+{
+namespace log
+{
+namespace detail
+{
+/// Type of an encoded argument, 4 bits each in the record header.
+enum arg_kind : unsigned
+{
+  arg_sint = 1,
+  arg_uint,
+  arg_real,
+  arg_pointer,
+  arg_string,
+};
+
+/// Words before the arguments: size/level/count, timestamp, format, kinds.
+constexpr std::size_t header_words = 4;
+
+template <typename T, typename = void> struct arg_traits
+{
+  static constexpr unsigned kind = 0;
+};
+
+template <typename T>
+struct arg_traits<T, std::enable_if_t<std::is_integral<T>::value>>
+{
+  static constexpr unsigned kind =
+      std::is_signed<T>::value ? arg_sint : arg_uint;
+};
+
+template <typename T>
+struct arg_traits<T, std::enable_if_t<std::is_enum<T>::value>>
+    : arg_traits<std::underlying_type_t<T>>
+{
+};
+
+template <typename T>
+struct arg_traits<T, std::enable_if_t<std::is_floating_point<T>::value>>
+{
+  static constexpr unsigned kind = arg_real;
+};
+
+template <typename T> struct arg_traits<T *, void>
+{
+  static constexpr unsigned kind =
+      std::is_same<std::remove_cv_t<T>, char>::value ? arg_string
+                                                     : arg_pointer;
+};
+
+/// Largest number of words an argument of type \c T takes.
+template <typename T> constexpr std::size_t arg_words()
+{
+  return arg_traits<std::decay_t<T>>::kind == arg_string
+             ? 1 + (string_max + 7) / 8
+             : 1;
+}
+
+template <typename T> void encode(std::uint64_t *&p, const T &value) noexcept
+{
+  using U = std::decay_t<T>;
+  constexpr unsigned kind = arg_traits<U>::kind;
+  static_assert(kind != 0, "unsupported log argument type");
+
+  if constexpr (kind == arg_string)
+  {
+    const char *s = value;
+    if (!s)
+      s = "(null)";
+    const std::size_t len = strnlen(s, string_max);
+    *p++ = len;
+    std::memcpy(p, s, len);
+    p += (len + 7) / 8;
+  }
+  else if constexpr (kind == arg_pointer)
+  {
+    *p++ = reinterpret_cast<std::uintptr_t>(value);
+  }
+  else if constexpr (kind == arg_real)
+  {
+    const double d = value;
+    std::memcpy(p++, &d, sizeof(d));
+  }
+  else if constexpr (kind == arg_sint)
+  {
+    *p++ = static_cast<std::uint64_t>(static_cast<long long>(value));
+  }
+  else
+  {
+    *p++ = static_cast<std::uint64_t>(value);
+  }
+}
+
+/// Checks if messages of level \c lv are kept.
+RTXX_DECL bool enabled(level lv) noexcept;
+
+/// Queue or write an encoded record, filling in its timestamp.
+RTXX_DECL void submit(std::uint64_t *rec, std::size_t words) noexcept;
+} // namespace detail
+
+template <typename... Args>
+void write(level lv, const char *fmt, const Args &... args) noexcept
+{
+  static_assert(sizeof...(Args) <= max_args, "too many log arguments");
+
+  if (!detail::enabled(lv))
+    return;
+
+  std::uint64_t rec[detail::header_words + (detail::arg_words<Args>() + ... + 0)];
+  std::uint64_t *p = rec + detail::header_words;
+  std::uint64_t kinds = 0;
+  [[maybe_unused]] unsigned i = 0;
+  ((kinds |= std::uint64_t(detail::arg_traits<std::decay_t<Args>>::kind)
+             << (4 * i++),
+    detail::encode(p, args)),
+   ...);
+
+  const std::size_t words = p - rec;
+  rec[0] = words | std::uint64_t(lv) << 32 | std::uint64_t(sizeof...(Args))
+                                                 << 40;
+  rec[2] = reinterpret_cast<std::uintptr_t>(fmt);
+  rec[3] = kinds;
+  detail::submit(rec, words);
+}
+} // namespace log
+} // namespace rtxx
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <rtxx/memory_resource.hpp>
+
+namespace rtxx
+{
+monotonic_arena::monotonic_arena(std::size_t size)
+    : buffer_(static_cast<unsigned char *>(::operator new(size))), size_(size),
+      owned_(true)
+{
+  std::memset(buffer_, 0, size_);
+}
+
+monotonic_arena::monotonic_arena(void *buffer, std::size_t size) noexcept
+    : buffer_(static_cast<unsigned char *>(buffer)), size_(size), owned_(false)
+{
+}
+
+monotonic_arena::~monotonic_arena()
+{
+  if (owned_)
+    ::operator delete(buffer_);
+}
+
+void monotonic_arena::release() noexcept { used_ = 0; }
+
+void *monotonic_arena::do_allocate(std::size_t bytes, std::size_t align)
+{
+  const auto base = reinterpret_cast<std::uintptr_t>(buffer_);
+  const auto begin = (base + used_ + align - 1) & ~(std::uintptr_t(align) - 1);
+  if (begin - base > size_ || bytes > size_ - (begin - base))
+    throw std::bad_alloc();
+
+  used_ = begin - base + bytes;
+  return reinterpret_cast<void *>(begin);
+}
+
+void monotonic_arena::do_deallocate(void *, std::size_t, std::size_t) {}
+
+bool monotonic_arena::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept
+{
+  return this == &other;
+}
+
+pool_resource::pool_resource(std::size_t block_size, std::size_t block_count)
+    : stride_((std::max(block_size, sizeof(block)) + alignof(std::max_align_t) -
+               1) &
+              ~(alignof(std::max_align_t) - 1)),
+      count_(block_count), available_(block_count),
+      buffer_(static_cast<unsigned char *>(::operator new(stride_ * count_)))
+{
+  std::memset(buffer_, 0, stride_ * count_);
+  for (std::size_t i = count_; i != 0; --i)
+  {
+    auto b = reinterpret_cast<block *>(buffer_ + (i - 1) * stride_);
+    b->next = free_;
+    free_ = b;
+  }
+}
+
+pool_resource::~pool_resource() { ::operator delete(buffer_); }
+
+void *pool_resource::do_allocate(std::size_t bytes, std::size_t align)
+{
+  if (bytes > stride_ || align > alignof(std::max_align_t) || !free_)
+    throw std::bad_alloc();
+
+  block *b = free_;
+  free_ = b->next;
+  --available_;
+  return b;
+}
+
+void pool_resource::do_deallocate(void *p, std::size_t, std::size_t)
+{
+  auto b = static_cast<block *>(p);
+  b->next = free_;
+  free_ = b;
+  ++available_;
+}
+
+bool pool_resource::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept
+{
+  return this == &other;
+}
+
+namespace detail
+{
+alloc_guard_state &alloc_guard() noexcept
+{
+  thread_local alloc_guard_state state{alloc_guard_mode::off, false, nullptr};
+  return state;
+}
+
+void check_allocation() noexcept
+{
+  alloc_guard_state &g = alloc_guard();
+  if (!g.armed)
+    return;
+
+  if (g.count)
+    g.count->store(g.count->load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+
+  if (g.mode == alloc_guard_mode::abort)
+  {
+    g.armed = false;
+    fprintf(stderr, "rtxx: heap allocation in a task after its warm-up\n");
+    std::abort();
+  }
+}
+} // namespace detail
+
+} // namespace rtxx
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <rtxx/error.hpp>
+#include <rtxx/log.hpp>
+#include <rtxx/message_queue.hpp>
+
+namespace rtxx
+{
+namespace detail
+{
+#if defined(RTXX_USE_POSIX)
+
+struct message_queue_base::node
+{
+  node *next;
+  int prio;
+};
+
+constexpr std::size_t align_up(std::size_t n, std::size_t align)
+{
+  return (n + align - 1) / align * align;
+}
+
+/// Size of a slot header, so that payloads stay suitably aligned.
+inline constexpr std::size_t node_header_size =
+    align_up(sizeof(void *) + sizeof(int), alignof(std::max_align_t));
+
+message_queue_base::message_queue_base(std::size_t msg_size,
+                                       std::size_t capacity)
+    : stride_(node_header_size + align_up(msg_size, alignof(std::max_align_t))),
+      storage_(new unsigned char[stride_ * capacity]), free_count_(capacity),
+      used_count_(0)
+{
+  for (std::size_t i = capacity; i-- > 0;)
+  {
+    auto n = ::new (storage_.get() + i * stride_) node{free_, 0};
+    free_ = n;
+  }
+}
+
+message_queue_base::~message_queue_base() = default;
+
+message_queue_base::node *message_queue_base::to_node(void *slot) noexcept
+{
+  return reinterpret_cast<node *>(static_cast<unsigned char *>(slot) -
+                                  node_header_size);
+}
+
+void *message_queue_base::to_slot(node *n) noexcept
+{
+  return reinterpret_cast<unsigned char *>(n) + node_header_size;
+}
+
+void *message_queue_base::loan(const struct timespec *abs_timeout)
+{
+  if (!abs_timeout)
+    free_count_.wait();
+  else if (!free_count_.wait_until(CLOCK_MONOTONIC, abs_timeout))
+    return nullptr;
+
+  std::lock_guard<mutex> guard(lock_);
+  node *n = free_;
+  free_ = n->next;
+  return to_slot(n);
+}
+
+void message_queue_base::commit(void *slot, int prio)
+{
+  node *n = to_node(slot);
+  n->next = nullptr;
+  n->prio = prio;
+
+  {
+    std::lock_guard<mutex> guard(lock_);
+    if (!head_)
+    {
+      head_ = tail_ = n;
+    }
+    else if (tail_->prio >= prio)
+    {
+      tail_->next = n;
+      tail_ = n;
+    }
+    else if (head_->prio < prio)
+    {
+      n->next = head_;
+      head_ = n;
+    }
+    else
+    {
+      node *p = head_;
+      while (p->next->prio >= prio)
+        p = p->next;
+      n->next = p->next;
+      p->next = n;
+    }
+  }
+
+  used_count_.post();
+}
+
+void message_queue_base::cancel(void *slot)
+{
+  node *n = to_node(slot);
+  {
+    std::lock_guard<mutex> guard(lock_);
+    n->next = free_;
+    free_ = n;
+  }
+  free_count_.post();
+}
+
+void *message_queue_base::receive(const struct timespec *abs_timeout)
+{
+  if (!abs_timeout)
+    used_count_.wait();
+  else if (!used_count_.wait_until(CLOCK_MONOTONIC, abs_timeout))
+    return nullptr;
+
+  std::lock_guard<mutex> guard(lock_);
+  node *n = head_;
+  head_ = n->next;
+  if (!head_)
+    tail_ = nullptr;
+  return to_slot(n);
+}
+
+void message_queue_base::release(void *slot) { cancel(slot); }
+
+#elif defined(RTXX_USE_ALCHEMY)
+
+message_queue_base::message_queue_base(std::size_t msg_size,
+                                       std::size_t capacity)
+    : msg_size_(msg_size)
+{
+  // Leave room for the per-block header of the queue's memory pool.
+  const std::size_t poolsize = capacity * (msg_size + 4 * sizeof(void *));
+  int err = rt_queue_create(&q_, nullptr, poolsize, capacity, Q_PRIO);
+  if (err)
+    throw system_error(-err, system_category(), "message_queue::message_queue");
+}
+
+message_queue_base::~message_queue_base()
+{
+  int err = rt_queue_delete(&q_);
+  if (err)
+    log::error("message_queue::~message_queue: %s", strerror(-err));
+}
+
+void *message_queue_base::loan(const struct timespec *)
+{
+  return rt_queue_alloc(&q_, msg_size_);
+}
+
+void message_queue_base::commit(void *slot, int prio)
+{
+  int err = rt_queue_send(&q_, slot, msg_size_, prio > 0 ? Q_URGENT : Q_NORMAL);
+  if (err < 0)
+    throw system_error(-err, system_category(), "message_queue::commit");
+}
+
+void message_queue_base::cancel(void *slot)
+{
+  int err = rt_queue_free(&q_, slot);
+  if (err)
+    throw system_error(-err, system_category(), "message_queue::cancel");
+}
+
+void *message_queue_base::receive(const struct timespec *abs_timeout)
+{
+  void *buf;
+  ssize_t n = abs_timeout ? rt_queue_receive_timed(&q_, &buf, abs_timeout)
+                          : rt_queue_receive(&q_, &buf, TM_INFINITE);
+  if (n == -ETIMEDOUT || n == -EWOULDBLOCK)
+    return nullptr;
+
+  if (n < 0)
+    throw system_error(-n, system_category(), "message_queue::receive");
+  return buf;
+}
+
+void message_queue_base::release(void *slot) { cancel(slot); }
+
+#else
+#error "not implemented"
+#endif
+} // namespace detail
+} // namespace rtxx
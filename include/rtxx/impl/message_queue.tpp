@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstring>
+#include <new>
+#include <rtxx/message_queue.hpp>
+#include <utility>
+
+namespace rtxx
+{
+namespace detail
+{
+/// A timeout which has already expired, used for non-blocking calls.
+inline constexpr struct timespec expired_timeout = {.tv_sec = 0, .tv_nsec = 0};
+} // namespace detail
+
+template <typename T>
+typename message_queue<T>::slot message_queue<T>::make_slot(void *p) noexcept
+{
+  if (!p)
+    return slot();
+  return slot(this, ::new (p) T);
+}
+
+template <typename T> typename message_queue<T>::slot message_queue<T>::loan()
+{
+  return make_slot(message_queue_base::loan(nullptr));
+}
+
+template <typename T>
+typename message_queue<T>::slot message_queue<T>::try_loan()
+{
+  return make_slot(message_queue_base::loan(&detail::expired_timeout));
+}
+
+template <typename T> void message_queue<T>::send(const T &msg, int prio)
+{
+  void *p = message_queue_base::loan(nullptr);
+  if (!p)
+    throw system_error(make_error_code(errc::not_enough_memory),
+                       "message_queue::send");
+  std::memcpy(p, &msg, sizeof(T));
+  message_queue_base::commit(p, prio);
+}
+
+template <typename T> bool message_queue<T>::try_send(const T &msg, int prio)
+{
+  void *p = message_queue_base::loan(&detail::expired_timeout);
+  if (!p)
+    return false;
+  std::memcpy(p, &msg, sizeof(T));
+  message_queue_base::commit(p, prio);
+  return true;
+}
+
+template <typename T>
+bool message_queue<T>::receive(T &msg, const struct timespec *abs_timeout)
+{
+  void *p = message_queue_base::receive(abs_timeout);
+  if (!p)
+    return false;
+  std::memcpy(&msg, p, sizeof(T));
+  message_queue_base::release(p);
+  return true;
+}
+
+template <typename T> void message_queue<T>::receive(T &msg)
+{
+  receive(msg, nullptr);
+}
+
+template <typename T> bool message_queue<T>::try_receive(T &msg)
+{
+  return receive(msg, &detail::expired_timeout);
+}
+
+template <typename T>
+template <typename Rep, typename Period>
+bool message_queue<T>::receive_for(
+    T &msg, chrono::duration<Rep, Period> const &rel_time)
+{
+  return receive_until(msg, monotonic_clock::now() + rel_time);
+}
+
+template <typename T>
+template <typename Clock, typename Duration>
+bool message_queue<T>::receive_until(
+    T &msg, chrono::time_point<Clock, Duration> const &abs_time)
+{
+  const clockid_t clock = detail::wait_clockid<Clock>();
+  auto ts = detail::duration_to_timespec(abs_time.time_since_epoch());
+#if defined(RTXX_USE_POSIX)
+  if (clock != CLOCK_MONOTONIC)
+    ts = detail::convert_timespec(clock, CLOCK_MONOTONIC, ts);
+#else
+  (void)clock;
+#endif
+  return receive(msg, &ts);
+}
+
+template <typename T>
+bool message_queue<T>::receive_until(T &msg, const deadline &d)
+{
+  return receive(msg, d.as_timespec());
+}
+
+} // namespace rtxx
@@ -1,17 +1,68 @@
 #pragma once
 
+#include <cassert>
 #include <rtxx/mutex.hpp>
 
 namespace rtxx
 {
 inline bool mutex::try_lock_for(chrono::nanoseconds duration)
 {
-#if defined(RTXX_USE_POSIX)
-  return try_lock_until(realtime_clock::now() + duration);
-#elif defined(RTXX_USE_ALCHEMY)
   return try_lock_until(monotonic_clock::now() + duration);
-#endif
+}
+
+inline bool mutex::try_lock_until(const deadline &d)
+{
+  return clock_lock(CLOCK_MONOTONIC, d.as_timespec());
 }
 
 inline mutex::native_handle_type mutex::native_handle() { return &i_; }
+
+inline bool mutex::previous_owner_died() const noexcept { return owner_died_; }
+
+template <typename... Initializers>
+constexpr mutex::options::options(Initializers &&... init) noexcept
+{
+  (init(this), ...);
+}
+
+constexpr auto priority_inherit()
+{
+  return [](mutex::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->protocol = mutex::protocol_type::inherit;
+  };
+}
+
+constexpr auto priority_ceiling(int ceiling)
+{
+  return [ceiling](mutex::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->protocol = mutex::protocol_type::protect;
+    opt->ceiling = ceiling;
+  };
+}
+
+constexpr auto robust(bool enable)
+{
+  return [enable](mutex::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->robust = enable;
+  };
+}
+
+constexpr auto adaptive_spin(unsigned count)
+{
+  return [count](mutex::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->spin_count = count;
+  };
+}
+
+constexpr auto profile(bool enable)
+{
+  return [enable](mutex::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->profile = enable;
+  };
+}
 } // namespace rtxx
@@ -1,29 +1,188 @@
 #pragma once
 
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <mutex>
 #include <rtxx/error.hpp>
+#include <rtxx/impl/cpu_relax.hpp>
+#include <rtxx/log.hpp>
 #include <rtxx/mutex.hpp>
+#include <rtxx/seqlock.hpp>
+#include <rtxx/trace.hpp>
 
 namespace rtxx
 {
-mutex::mutex()
+namespace detail
+{
+/// Thread which held a profiled mutex longest.
+struct mutex_holder
+{
+  std::int64_t hold{0};
+  long tid{0};
+  char name[16]{};
+};
+
+/// Statistics of a profiled mutex.
+/** Everything but \c timeouts is written by the owner of the mutex only,
+ *  so single-writer counters and histograms suffice.
+ */
+struct alignas(RTXX_CACHELINE_SIZE) mutex_stats
 {
+  const char *name;
+  const mutex *object;
+
+  std::atomic<std::uint64_t> acquisitions{0};
+  std::atomic<std::uint64_t> contended{0};
+  std::atomic<std::uint64_t> timeouts{0};
+
+  /// When the current owner locked the mutex.
+  std::int64_t acquired_at{0};
+
+  latency_histogram wait;
+  latency_histogram hold;
+
+  /// Owner's copy of longest.load().hold.
+  std::int64_t longest_hold{0};
+  seqlock<mutex_holder> longest;
+
+  /// Links of the registry, guarded by its lock.
+  mutex_stats *prev{};
+  mutex_stats *next{};
+};
+
+/// Process-wide list of profiled mutexes.
+struct mutex_registry
+{
+  std::mutex lock;
+  mutex_stats *head{};
+};
+
+inline mutex_registry &mutex_profiles() noexcept
+{
+  static mutex_registry r;
+  return r;
+}
+
+inline std::int64_t profile_now() noexcept
+{
+#if defined(RTXX_USE_SIM)
+  return sim::detail::now();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return std::int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+inline void bump(std::atomic<std::uint64_t> &counter) noexcept
+{
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+}
+} // namespace detail
+
+mutex::mutex() : mutex(options{}) {}
+
+mutex::mutex(const options &opt) : spin_count_(opt.spin_count)
+{
+  if (opt.profile && opt.process_shared)
+    throw system_error(EINVAL, system_category(), "mutex::mutex");
+
   int err = 0;
-#if defined(RTXX_USE_POSIX)
-  err = pthread_mutex_init(&i_, nullptr);
+#if defined(RTXX_USE_SIM)
+  if (opt.robust || opt.process_shared)
+    err = ENOTSUP;
+  else if (opt.protocol == protocol_type::inherit)
+    i_.protocol = sim::detail::protocol_inherit;
+  else if (opt.protocol == protocol_type::protect)
+  {
+    i_.protocol = sim::detail::protocol_protect;
+    i_.ceiling = opt.ceiling;
+  }
+#elif defined(RTXX_USE_POSIX)
+  pthread_mutexattr_t attr;
+  err = pthread_mutexattr_init(&attr);
+  if (err)
+    throw system_error(err, system_category(), "mutex::mutex");
+
+  switch (opt.protocol)
+  {
+  case protocol_type::none:
+    break;
+  case protocol_type::inherit:
+    err = pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    break;
+  case protocol_type::protect:
+    err = pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_PROTECT);
+    if (!err)
+      err = pthread_mutexattr_setprioceiling(&attr, opt.ceiling);
+    break;
+  }
+
+  if (!err && opt.robust)
+    err = pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+
+  if (!err && opt.process_shared)
+    err = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+
+  if (!err)
+    err = pthread_mutex_init(&i_, &attr);
+
+  pthread_mutexattr_destroy(&attr);
 #elif defined(RTXX_USE_ALCHEMY)
-  err = -rt_mutex_create(&i_, nullptr);
+  if (opt.protocol == protocol_type::protect || opt.robust ||
+      opt.process_shared)
+    err = ENOTSUP;
+  else
+    err = -rt_mutex_create(&i_, nullptr);
 #else
 #error "no implementation selected"
 #endif
   if (err)
     throw system_error(err, system_category(), "mutex::mutex");
+
+  if (opt.profile)
+  {
+    stats_ = new detail::mutex_stats;
+    stats_->name = opt.name;
+    stats_->object = this;
+
+    auto &reg = detail::mutex_profiles();
+    std::lock_guard<std::mutex> lock(reg.lock);
+    stats_->next = reg.head;
+    if (reg.head)
+      reg.head->prev = stats_;
+    reg.head = stats_;
+  }
 }
 
 mutex::~mutex()
 {
+  if (stats_)
+  {
+    auto &reg = detail::mutex_profiles();
+    {
+      std::lock_guard<std::mutex> lock(reg.lock);
+      if (stats_->prev)
+        stats_->prev->next = stats_->next;
+      else
+        reg.head = stats_->next;
+      if (stats_->next)
+        stats_->next->prev = stats_->prev;
+    }
+    delete stats_;
+  }
+
   int err;
-#if defined(RTXX_USE_POSIX)
+#if defined(RTXX_USE_SIM)
+  err = i_.owner ? EBUSY : 0;
+#elif defined(RTXX_USE_POSIX)
   err = pthread_mutex_destroy(&i_);
 #elif defined(RTXX_USE_ALCHEMY)
   err = -rt_mutex_delete(&i_);
@@ -31,72 +190,208 @@ mutex::~mutex()
 #error "no implementation selected"
 #endif
   if (err)
-    fprintf(stderr, "mutex::~mutex: %s", strerror(err));
+    log::error("mutex::~mutex: %s", strerror(err));
+}
+
+bool mutex::try_lock_until(monotonic_clock::time_point time_limit)
+{
+  const struct timespec ts =
+      detail::duration_to_timespec(time_limit.time_since_epoch());
+  return clock_lock(CLOCK_MONOTONIC, &ts);
 }
 
 #if defined(RTXX_USE_POSIX)
 bool mutex::try_lock_until(realtime_clock::time_point time_limit)
-#elif defined(RTXX_USE_ALCHEMY)
-bool mutex::try_lock_until(monotonic_clock::time_point time_limit)
-#endif
 {
   const struct timespec ts =
       detail::duration_to_timespec(time_limit.time_since_epoch());
+  return clock_lock(CLOCK_REALTIME, &ts);
+}
+#endif
+
+bool mutex::clock_lock(clockid_t clock, const struct timespec *abs_time)
+{
+  RTXX_TRACE(lock_request, this, 0);
+
+  std::int64_t start = 0;
+  if (stats_)
+  {
+    if (lock_result(try_lock_native(), "mutex::try_lock_until"))
+    {
+      RTXX_TRACE(lock_acquire, this, 0);
+      profile_acquired(0, false);
+      return true;
+    }
+    start = detail::profile_now();
+  }
+
   int err;
-#if defined(RTXX_USE_POSIX)
+#if defined(RTXX_USE_SIM)
+  (void)clock;
+  err = sim::detail::lock(i_, sim::detail::to_ns(abs_time));
+#elif defined(RTXX_USE_POSIX) && defined(RTXX_HAVE_CLOCKWAIT)
+  err = pthread_mutex_clocklock(&i_, clock, abs_time);
+#elif defined(RTXX_USE_POSIX)
+  const struct timespec ts =
+      detail::convert_timespec(clock, CLOCK_REALTIME, *abs_time);
   err = pthread_mutex_timedlock(&i_, &ts);
 #elif defined(RTXX_USE_ALCHEMY)
-  err = -rt_mutex_acquire_timed(&i_, &ts);
+  (void)clock;
+  err = -rt_mutex_acquire_timed(&i_, abs_time);
 #else
 #error "no implementation selected"
 #endif
 
-  if (!err)
-    return true;
-
-  if (err == ETIMEDOUT || err == EWOULDBLOCK)
-    return false;
-
-  throw system_error(err, system_category(), "mutex::try_lock_until");
+  const bool locked = lock_result(err, "mutex::try_lock_until");
+  RTXX_TRACE(lock_acquire, this, !locked);
+  if (stats_)
+  {
+    if (locked)
+      profile_acquired(start, true);
+    else
+      stats_->timeouts.fetch_add(1, std::memory_order_relaxed);
+  }
+  return locked;
 }
 
-bool mutex::try_lock()
+int mutex::try_lock_native() noexcept
 {
-  int err;
-#if defined(RTXX_USE_POSIX)
-  err = pthread_mutex_trylock(&i_);
+#if defined(RTXX_USE_SIM)
+  return sim::detail::try_lock(i_);
+#elif defined(RTXX_USE_POSIX)
+  return pthread_mutex_trylock(&i_);
 #elif defined(RTXX_USE_ALCHEMY)
-  err = -rt_mutex_acquire(&i_, TM_NONBLOCK);
+  return -rt_mutex_acquire(&i_, TM_NONBLOCK);
 #else
 #error "no implementation selected"
 #endif
-  if (err == EWOULDBLOCK || err == EBUSY)
-    return false;
-
-  if (!err)
-    return true;
+}
 
-  throw system_error(err, system_category(), "mutex::try_lock");
+bool mutex::try_lock()
+{
+  const bool locked = lock_result(try_lock_native(), "mutex::try_lock");
+  if (locked)
+  {
+    RTXX_TRACE(lock_acquire, this, 0);
+    if (stats_)
+      profile_acquired(0, false);
+  }
+  return locked;
 }
 
 void mutex::lock()
 {
-  int err;
-#if defined(RTXX_USE_POSIX)
-  err = pthread_mutex_lock(&i_);
+  RTXX_TRACE(lock_request, this, 0);
+
+  // A profiled lock tries once more up front, to tell contended
+  // acquisitions apart.
+  std::int64_t start = 0;
+  if (stats_)
+  {
+    if (lock_result(try_lock_native(), "mutex::lock"))
+    {
+      RTXX_TRACE(lock_acquire, this, 0);
+      profile_acquired(0, false);
+      return;
+    }
+    start = detail::profile_now();
+  }
+
+  bool locked = false;
+  for (unsigned i = 0; !locked && i != spin_count_; ++i)
+  {
+    locked = lock_result(try_lock_native(), "mutex::lock");
+    if (!locked)
+      detail::cpu_relax();
+  }
+
+  if (!locked)
+  {
+    int err;
+#if defined(RTXX_USE_SIM)
+    err = sim::detail::lock(i_, -1);
+#elif defined(RTXX_USE_POSIX)
+    err = pthread_mutex_lock(&i_);
 #elif defined(RTXX_USE_ALCHEMY)
-  err = -rt_mutex_acquire(&i_, TM_INFINITE);
+    err = -rt_mutex_acquire(&i_, TM_INFINITE);
 #else
 #error "no implementation selected"
 #endif
-  if (err)
-    throw system_error(err, system_category(), "mutex::lock");
+    lock_result(err, "mutex::lock");
+  }
+  RTXX_TRACE(lock_acquire, this, 0);
+  if (stats_)
+    profile_acquired(start, true);
+}
+
+void mutex::profile_acquired(std::int64_t start, bool contended) noexcept
+{
+  const auto now = detail::profile_now();
+  detail::bump(stats_->acquisitions);
+  if (contended)
+  {
+    detail::bump(stats_->contended);
+    stats_->wait.record(chrono::nanoseconds(now - start));
+  }
+  stats_->acquired_at = now;
+}
+
+void mutex::profile_released() noexcept
+{
+  const auto held = detail::profile_now() - stats_->acquired_at;
+  stats_->hold.record(chrono::nanoseconds(held));
+  if (held > stats_->longest_hold)
+  {
+    // Rare once warmed up: the thread name costs a system call.
+    detail::mutex_holder h;
+    h.hold = held;
+    h.tid = syscall(SYS_gettid);
+    pthread_getname_np(pthread_self(), h.name, sizeof(h.name));
+    stats_->longest_hold = held;
+    stats_->longest.store(h);
+  }
+}
+
+void mutex::profile_reacquired() noexcept
+{
+  stats_->acquired_at = detail::profile_now();
+}
+
+bool mutex::lock_result(int err, const char *what)
+{
+  if (!err)
+  {
+    owner_died_ = false;
+    return true;
+  }
+
+#if defined(RTXX_USE_POSIX) && !defined(RTXX_USE_SIM)
+  if (err == EOWNERDEAD)
+  {
+    err = pthread_mutex_consistent(&i_);
+    if (err)
+      throw system_error(err, system_category(), what);
+    owner_died_ = true;
+    return true;
+  }
+#endif
+
+  if (err == ETIMEDOUT || err == EWOULDBLOCK || err == EBUSY)
+    return false;
+
+  throw system_error(err, system_category(), what);
 }
 
 void mutex::unlock()
 {
+  RTXX_TRACE(lock_release, this, 0);
+  if (stats_)
+    profile_released();
+
   int err;
-#if defined(RTXX_USE_POSIX)
+#if defined(RTXX_USE_SIM)
+  err = sim::detail::unlock(i_);
+#elif defined(RTXX_USE_POSIX)
   err = pthread_mutex_unlock(&i_);
 #elif defined(RTXX_USE_ALCHEMY)
   err = -rt_mutex_release(&i_);
@@ -108,4 +403,76 @@ void mutex::unlock()
     throw system_error(err, system_category(), "mutex::unlock");
 }
 
+mutex::stats mutex::statistics() const
+{
+  if (!stats_)
+    throw system_error(make_error_code(errc::invalid_argument),
+                       "mutex::statistics");
+
+  stats st;
+  st.name = stats_->name;
+  st.object = this;
+  st.acquisitions = stats_->acquisitions.load(std::memory_order_relaxed);
+  st.contended = stats_->contended.load(std::memory_order_relaxed);
+  st.timeouts = stats_->timeouts.load(std::memory_order_relaxed);
+  st.wait = stats_->wait.snapshot();
+  st.hold = stats_->hold.snapshot();
+
+  const detail::mutex_holder h = stats_->longest.load();
+  st.longest_hold = chrono::nanoseconds(h.hold);
+  std::memcpy(st.longest_holder, h.name, sizeof(st.longest_holder));
+  st.longest_holder_tid = h.tid;
+  return st;
+}
+
+namespace mutex_profiler
+{
+std::vector<mutex::stats> snapshot()
+{
+  std::vector<mutex::stats> out;
+  {
+    auto &reg = detail::mutex_profiles();
+    std::lock_guard<std::mutex> lock(reg.lock);
+    for (auto p = reg.head; p; p = p->next)
+      out.push_back(p->object->statistics());
+  }
+
+  std::stable_sort(out.begin(), out.end(),
+                   [](const mutex::stats &a, const mutex::stats &b) {
+                     if (a.total_wait() != b.total_wait())
+                       return a.total_wait() > b.total_wait();
+                     return a.acquisitions > b.acquisitions;
+                   });
+  return out;
+}
+
+void report(std::FILE *out)
+{
+  auto us = [](chrono::nanoseconds d) { return d.count() / 1000.0; };
+
+  std::fprintf(out,
+               "%-20s %12s %7s %10s %9s %9s %9s %9s %9s %s\n", "mutex",
+               "acquired", "cont%", "wait(us)", "wait p99", "wait max",
+               "hold p50", "hold p99", "hold max", "longest holder");
+  for (const auto &st : snapshot())
+  {
+    char name[32];
+    if (st.name)
+      std::snprintf(name, sizeof(name), "%s", st.name);
+    else
+      std::snprintf(name, sizeof(name), "%p", static_cast<const void *>(st.object));
+
+    std::fprintf(
+        out, "%-20s %12llu %6.2f%% %10.1f %9.1f %9.1f %9.1f %9.1f %9.1f %s/%ld\n",
+        name, static_cast<unsigned long long>(st.acquisitions),
+        st.acquisitions ? 100.0 * st.contended / st.acquisitions : 0.0,
+        us(st.total_wait()), us(st.wait.percentile(0.99)),
+        us(st.wait.max()), us(st.hold.percentile(0.5)),
+        us(st.hold.percentile(0.99)), us(st.hold.max()),
+        st.longest_holder[0] ? st.longest_holder : "?",
+        st.longest_holder_tid);
+  }
+}
+} // namespace mutex_profiler
+
 } // namespace rtxx
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cassert>
+#include <rtxx/config.hpp>
+
+namespace rtxx
+{
+/// Returns an initializer for the name option.
+/** Applies to the options of task, thread_pool, mutex and any other
+ *  options structures with a \c name field.
+ */
+RTXX_INLINE_DECL constexpr auto name(const char *name)
+{
+  return [name](auto *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->name = name;
+  };
+}
+} // namespace rtxx
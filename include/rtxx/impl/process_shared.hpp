@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cassert>
+#include <rtxx/config.hpp>
+
+namespace rtxx
+{
+/// Returns an initializer for the process_shared option.
+/** Applies to the options of mutex, semaphore and condition_variable. */
+RTXX_INLINE_DECL constexpr auto process_shared(bool enable = true)
+{
+  return [enable](auto *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->process_shared = enable;
+  };
+}
+} // namespace rtxx
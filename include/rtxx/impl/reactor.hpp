@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cassert>
+#include <rtxx/reactor.hpp>
+
+namespace rtxx
+{
+template <typename... Initializers>
+constexpr reactor::options::options(Initializers &&... init) noexcept
+{
+  (init(this), ...);
+}
+
+constexpr auto max_sources(std::size_t n)
+{
+  return [n](reactor::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->max_sources = n;
+  };
+}
+
+constexpr auto batch_size(std::size_t n)
+{
+  return [n](reactor::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->batch_size = n;
+  };
+}
+
+constexpr auto use_io_uring(bool enable)
+{
+  return [enable](reactor::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->use_io_uring = enable;
+  };
+}
+
+} // namespace rtxx
@@ -0,0 +1,452 @@
+#pragma once
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <rtxx/log.hpp>
+#include <rtxx/reactor.hpp>
+#include <utility>
+
+/// Defined when the kernel headers allow the io_uring backend
+/** Timed waits need IORING_FEAT_EXT_ARG, from the Linux 5.11 headers.
+ *  Without them the reactor always uses epoll.
+ */
+#if defined(IORING_FEAT_EXT_ARG) && defined(__NR_io_uring_setup) &&          \
+    defined(__NR_io_uring_enter)
+#define RTXX_HAVE_IO_URING
+#endif
+
+namespace rtxx
+{
+namespace detail
+{
+/// user_data of requests whose completion is ignored.
+constexpr std::uint64_t ignored_completion = ~std::uint64_t(0);
+} // namespace detail
+
+reactor::reactor(const options &opt)
+    : sources_(opt.max_sources + 1),
+      batch_size_(std::max<std::size_t>(opt.batch_size, 1))
+{
+  if (opt.use_io_uring && setup_uring(2 * sources_.size()))
+  {
+    backend_ = backend_type::io_uring;
+  }
+  else
+  {
+    epfd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd_ == -1)
+      throw system_error(errno, system_category(), "reactor::reactor");
+    events_.resize(batch_size_);
+  }
+
+  try
+  {
+    handler_type none;
+    const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd == -1)
+      throw system_error(errno, system_category(), "reactor::reactor");
+    stop_id_ = insert(fd, readable, kind::notifier, none, "reactor::reactor");
+  }
+  catch (...)
+  {
+    close_uring();
+    if (epfd_ != -1)
+      ::close(epfd_);
+    throw;
+  }
+}
+
+reactor::~reactor()
+{
+  for (auto &s : sources_)
+  {
+    if (s.type == kind::timer || s.type == kind::notifier)
+      ::close(s.fd);
+  }
+
+  close_uring();
+  if (epfd_ != -1)
+    ::close(epfd_);
+}
+
+bool reactor::setup_uring(unsigned entries) noexcept
+{
+#if defined(RTXX_HAVE_IO_URING)
+  struct io_uring_params p;
+  std::memset(&p, 0, sizeof(p));
+
+  const long fd = syscall(__NR_io_uring_setup, entries, &p);
+  if (fd < 0)
+    return false;
+  ring_.fd = static_cast<int>(fd);
+
+  // Timed waits need IORING_ENTER_EXT_ARG (Linux 5.11).
+  if (!(p.features & IORING_FEAT_SINGLE_MMAP) ||
+      !(p.features & IORING_FEAT_EXT_ARG))
+  {
+    close_uring();
+    return false;
+  }
+
+  ring_.ring_size =
+      std::max<std::size_t>(p.sq_off.array + p.sq_entries * sizeof(unsigned),
+                            p.cq_off.cqes +
+                                p.cq_entries * sizeof(struct io_uring_cqe));
+  ring_.ring = mmap(nullptr, ring_.ring_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_.fd, IORING_OFF_SQ_RING);
+  if (ring_.ring == MAP_FAILED)
+  {
+    ring_.ring = nullptr;
+    close_uring();
+    return false;
+  }
+
+  ring_.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+  ring_.sqes = mmap(nullptr, ring_.sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_.fd, IORING_OFF_SQES);
+  if (ring_.sqes == MAP_FAILED)
+  {
+    ring_.sqes = nullptr;
+    close_uring();
+    return false;
+  }
+
+  auto base = static_cast<unsigned char *>(ring_.ring);
+  ring_.sq_head = reinterpret_cast<unsigned *>(base + p.sq_off.head);
+  ring_.sq_tail = reinterpret_cast<unsigned *>(base + p.sq_off.tail);
+  ring_.sq_mask = reinterpret_cast<unsigned *>(base + p.sq_off.ring_mask);
+  ring_.sq_array = reinterpret_cast<unsigned *>(base + p.sq_off.array);
+  ring_.cq_head = reinterpret_cast<unsigned *>(base + p.cq_off.head);
+  ring_.cq_tail = reinterpret_cast<unsigned *>(base + p.cq_off.tail);
+  ring_.cq_mask = reinterpret_cast<unsigned *>(base + p.cq_off.ring_mask);
+  ring_.cqes = base + p.cq_off.cqes;
+  ring_.sq_entries = p.sq_entries;
+  return true;
+#else
+  (void)entries;
+  return false;
+#endif
+}
+
+void reactor::close_uring() noexcept
+{
+  if (ring_.sqes)
+    munmap(ring_.sqes, ring_.sqes_size);
+  if (ring_.ring)
+    munmap(ring_.ring, ring_.ring_size);
+  if (ring_.fd != -1)
+    ::close(ring_.fd);
+  ring_ = uring();
+}
+
+int reactor::uring_enter(unsigned min_complete,
+                         const struct timespec *timeout) noexcept
+{
+#if defined(RTXX_HAVE_IO_URING)
+  unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+  struct io_uring_getevents_arg arg;
+  std::memset(&arg, 0, sizeof(arg));
+  const void *argp = nullptr;
+  std::size_t argsz = 0;
+
+  if (timeout)
+  {
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = reinterpret_cast<std::uintptr_t>(timeout);
+    flags |= IORING_ENTER_EXT_ARG;
+    argp = &arg;
+    argsz = sizeof(arg);
+  }
+
+  const long r = syscall(__NR_io_uring_enter, ring_.fd, ring_.to_submit,
+                         min_complete, flags, argp, argsz);
+  if (r < 0)
+    return -errno;
+  ring_.to_submit -= std::min<unsigned>(r, ring_.to_submit);
+  return static_cast<int>(r);
+#else
+  (void)min_complete;
+  (void)timeout;
+  return -ENOSYS;
+#endif
+}
+
+void reactor::uring_push(std::uint8_t op, int fd, std::uint32_t events,
+                         std::uint64_t addr, std::uint64_t data,
+                         error_code &ec) noexcept
+{
+#if defined(RTXX_HAVE_IO_URING)
+  const unsigned tail = *ring_.sq_tail;
+  if (tail - __atomic_load_n(ring_.sq_head, __ATOMIC_ACQUIRE) ==
+      ring_.sq_entries)
+  {
+    const int r = uring_enter(0, nullptr);
+    if (r < 0)
+      return ec.assign(-r, system_category());
+    if (tail - __atomic_load_n(ring_.sq_head, __ATOMIC_ACQUIRE) ==
+        ring_.sq_entries)
+      return ec.assign(EBUSY, system_category());
+  }
+
+  const unsigned index = tail & *ring_.sq_mask;
+  auto sqe = static_cast<struct io_uring_sqe *>(ring_.sqes) + index;
+  std::memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = op;
+  sqe->fd = fd;
+  sqe->poll32_events = events;
+  sqe->addr = addr;
+  sqe->user_data = data;
+
+  ring_.sq_array[index] = index;
+  __atomic_store_n(ring_.sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ++ring_.to_submit;
+  ec.clear();
+#else
+  (void)op;
+  (void)fd;
+  (void)events;
+  (void)addr;
+  (void)data;
+  ec.assign(ENOSYS, system_category());
+#endif
+}
+
+reactor::source_id reactor::insert(int fd, std::uint32_t events, kind type,
+                                   handler_type &h, const char *what)
+{
+  auto it = std::find_if(sources_.begin(), sources_.end(),
+                         [](const source &s) { return s.type == kind::none; });
+  if (it == sources_.end())
+  {
+    if (type != kind::fd)
+      ::close(fd);
+    throw system_error(make_error_code(errc::no_buffer_space), what);
+  }
+
+  it->fd = fd;
+  it->events = events;
+  it->type = type;
+  it->handler = std::move(h);
+
+  const source_id id = it - sources_.begin();
+  error_code ec;
+  watch(id, ec);
+  if (ec)
+  {
+    if (type != kind::fd)
+      ::close(fd);
+    it->type = kind::none;
+    it->handler = handler_type();
+    throw system_error(ec, what);
+  }
+  return id;
+}
+
+void reactor::watch(source_id id, error_code &ec) noexcept
+{
+  const source &s = sources_[id];
+  const auto data = user_data(id, s.generation);
+
+#if defined(RTXX_HAVE_IO_URING)
+  if (backend_ == backend_type::io_uring)
+    return uring_push(IORING_OP_POLL_ADD, s.fd, s.events, 0, data, ec);
+#endif
+
+  struct epoll_event ev;
+  ev.events = s.events;
+  ev.data.u64 = data;
+  if (epoll_ctl(epfd_, EPOLL_CTL_ADD, s.fd, &ev) == -1)
+    return ec.assign(errno, system_category());
+  ec.clear();
+}
+
+reactor::source_id reactor::add_fd(int fd, std::uint32_t events,
+                                   handler_type h)
+{
+  return insert(fd, events, kind::fd, h, "reactor::add_fd");
+}
+
+reactor::source_id reactor::add_timer(monotonic_clock::time_point start,
+                                      chrono::nanoseconds period,
+                                      handler_type h)
+{
+  const int fd =
+      timerfd_create(monotonic_clock::clockid, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (fd == -1)
+    throw system_error(errno, system_category(), "reactor::add_timer");
+
+  struct itimerspec its;
+  its.it_value = detail::duration_to_timespec(start.time_since_epoch());
+  its.it_interval = detail::duration_to_timespec(period);
+  if (timerfd_settime(fd, TFD_TIMER_ABSTIME, &its, nullptr) == -1)
+  {
+    const int err = errno;
+    ::close(fd);
+    throw system_error(err, system_category(), "reactor::add_timer");
+  }
+
+  return insert(fd, readable, kind::timer, h, "reactor::add_timer");
+}
+
+reactor::source_id reactor::add_notifier(handler_type h)
+{
+  const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (fd == -1)
+    throw system_error(errno, system_category(), "reactor::add_notifier");
+
+  return insert(fd, readable, kind::notifier, h, "reactor::add_notifier");
+}
+
+void reactor::notify(source_id id)
+{
+  if (id >= sources_.size() || sources_[id].type != kind::notifier)
+    throw system_error(make_error_code(errc::invalid_argument),
+                       "reactor::notify");
+
+  const std::uint64_t one = 1;
+  if (::write(sources_[id].fd, &one, sizeof(one)) == -1 && errno != EAGAIN)
+    throw system_error(errno, system_category(), "reactor::notify");
+}
+
+void reactor::stop() noexcept
+{
+  const std::uint64_t one = 1;
+  if (::write(sources_[stop_id_].fd, &one, sizeof(one)) == -1)
+    log::error("reactor::stop: %s", strerror(errno));
+}
+
+void reactor::remove(source_id id)
+{
+  if (id >= sources_.size() || id == stop_id_ ||
+      sources_[id].type == kind::none)
+    throw system_error(make_error_code(errc::invalid_argument),
+                       "reactor::remove");
+
+  source &s = sources_[id];
+  error_code ec;
+#if defined(RTXX_HAVE_IO_URING)
+  if (backend_ == backend_type::io_uring)
+    uring_push(IORING_OP_POLL_REMOVE, -1, 0, user_data(id, s.generation),
+               detail::ignored_completion, ec);
+#endif
+  if (backend_ == backend_type::epoll &&
+      epoll_ctl(epfd_, EPOLL_CTL_DEL, s.fd, nullptr) == -1)
+    ec.assign(errno, system_category());
+
+  if (s.type != kind::fd)
+    ::close(s.fd);
+  s.fd = -1;
+  s.type = kind::none;
+  s.handler = handler_type();
+  ++s.generation;
+
+  if (ec)
+    throw system_error(ec, "reactor::remove");
+}
+
+bool reactor::dispatch(std::uint64_t data, std::uint32_t revents, bool rearm)
+{
+  const source_id id = data & 0xffffffff;
+  const auto gen = static_cast<std::uint32_t>(data >> 32);
+  if (data == detail::ignored_completion || id >= sources_.size() ||
+      sources_[id].type == kind::none || sources_[id].generation != gen)
+    return false;
+
+  source &s = sources_[id];
+  std::uint64_t value = revents;
+  bool call = true;
+
+  if (s.type != kind::fd)
+  {
+    // Timers and eventfds count what happened since the last read.
+    call = ::read(s.fd, &value, sizeof(value)) == sizeof(value);
+    if (id == stop_id_)
+    {
+      stopping_ = stopping_ || call;
+      call = false;
+    }
+  }
+
+  if (call)
+  {
+    // The handler may remove its own source, keep it alive meanwhile.
+    handler_type h = std::move(s.handler);
+    h(value);
+    if (s.type != kind::none && s.generation == gen)
+      s.handler = std::move(h);
+  }
+
+  if (rearm && s.type != kind::none && s.generation == gen)
+  {
+    error_code ec;
+    watch(id, ec);
+    if (ec)
+      throw system_error(ec, "reactor::dispatch");
+  }
+  return call;
+}
+
+std::size_t reactor::run_once(chrono::nanoseconds timeout)
+{
+  std::size_t called = 0;
+
+  if (backend_ == backend_type::epoll)
+  {
+    // epoll_wait() counts in milliseconds, round up.
+    const int ms =
+        timeout.count() < 0
+            ? -1
+            : static_cast<int>((timeout.count() + 999'999) / 1'000'000);
+    const int n = epoll_wait(epfd_, events_.data(), events_.size(), ms);
+    if (n == -1 && errno != EINTR)
+      throw system_error(errno, system_category(), "reactor::run_once");
+
+    for (int i = 0; i < n; ++i)
+      called += dispatch(events_[i].data.u64, events_[i].events, false);
+    return called;
+  }
+
+#if defined(RTXX_HAVE_IO_URING)
+  const struct timespec ts = detail::duration_to_timespec(timeout);
+  const int r = uring_enter(1, timeout.count() < 0 ? nullptr : &ts);
+  if (r < 0 && r != -ETIME && r != -EINTR && r != -EBUSY)
+    throw system_error(-r, system_category(), "reactor::run_once");
+
+  unsigned head = *ring_.cq_head;
+  const unsigned tail = __atomic_load_n(ring_.cq_tail, __ATOMIC_ACQUIRE);
+  for (std::size_t n = 0; head != tail && n != batch_size_; ++head, ++n)
+  {
+    const auto &cqe =
+        static_cast<struct io_uring_cqe *>(ring_.cqes)[head & *ring_.cq_mask];
+    const std::uint64_t data = cqe.user_data;
+    const int res = cqe.res;
+
+    // Hand the entry back before running the handler.
+    __atomic_store_n(ring_.cq_head, head + 1, __ATOMIC_RELEASE);
+    called += dispatch(data, res < 0 ? error : static_cast<std::uint32_t>(res),
+                       res >= 0);
+  }
+#endif
+  return called;
+}
+
+void reactor::run()
+{
+  stopping_ = false;
+  while (!stopping_)
+    run_once(chrono::nanoseconds(-1));
+}
+
+} // namespace rtxx
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cassert>
+#include <rtxx/runtime.hpp>
+
+namespace rtxx
+{
+namespace runtime
+{
+template <typename... Initializers>
+constexpr options::options(Initializers &&... init) noexcept
+{
+  (init(this), ...);
+}
+} // namespace runtime
+
+constexpr auto lock_memory(bool enable)
+{
+  return [enable](runtime::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->lock_memory = enable;
+  };
+}
+
+constexpr auto keep_heap(bool enable)
+{
+  return [enable](runtime::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->keep_heap = enable;
+  };
+}
+
+constexpr auto heap_reserve(std::size_t bytes)
+{
+  return [bytes](runtime::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->heap_reserve = bytes;
+  };
+}
+
+constexpr auto prefault_stacks(bool enable)
+{
+  return [enable](runtime::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->prefault_stacks = enable;
+  };
+}
+
+} // namespace rtxx
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <malloc.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <rtxx/runtime.hpp>
+
+namespace rtxx
+{
+namespace runtime
+{
+namespace detail
+{
+/// Options of the last successful init().
+inline options &state() noexcept
+{
+  static options opt{lock_memory(false), keep_heap(false)};
+  return opt;
+}
+} // namespace detail
+
+void init(const options &opt, error_code &ec)
+{
+  if (opt.lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) == -1)
+    return ec.assign(errno, system_category());
+
+#if defined(__GLIBC__)
+  if (opt.keep_heap)
+  {
+    if (!mallopt(M_TRIM_THRESHOLD, -1) || !mallopt(M_MMAP_MAX, 0) ||
+        !mallopt(M_ARENA_MAX, 1))
+      return ec.assign(EINVAL, system_category());
+  }
+#endif
+
+  if (opt.heap_reserve > 0)
+  {
+    auto p = static_cast<volatile char *>(std::malloc(opt.heap_reserve));
+    if (!p)
+      return ec.assign(ENOMEM, system_category());
+
+    const long page = sysconf(_SC_PAGESIZE);
+    for (std::size_t i = 0; i < opt.heap_reserve; i += page)
+      p[i] = 0;
+    std::free(const_cast<char *>(p));
+  }
+
+  detail::state() = opt;
+  ec.clear();
+}
+
+void init(const options &opt)
+{
+  error_code ec;
+  init(opt, ec);
+  if (ec)
+    throw system_error(ec, "runtime::init");
+}
+
+const options &current() noexcept { return detail::state(); }
+} // namespace runtime
+} // namespace rtxx
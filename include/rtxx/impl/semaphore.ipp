@@ -1,15 +1,71 @@
 #pragma once
 
 #include <cassert>
+#include <cstring>
 #include <rtxx/error.hpp>
+#include <rtxx/log.hpp>
 #include <rtxx/semaphore.hpp>
+#include <rtxx/trace.hpp>
 
 namespace rtxx
 {
-#if defined(RTXX_USE_POSIX)
 semaphore::semaphore(value_type init_value)
+    : semaphore(init_value, options{})
 {
-  int err = sem_init(&sem_, 0, init_value);
+}
+
+#if defined(RTXX_USE_SIM)
+semaphore::semaphore(value_type init_value, const options &opt)
+{
+  if (opt.process_shared)
+    throw system_error(ENOTSUP, system_category(), "semaphore::semaphore");
+  sem_.count = init_value;
+}
+
+semaphore::~semaphore()
+{
+  if (sem_.waiters.head)
+    log::error("semaphore::~semaphore: %s", strerror(EBUSY));
+}
+
+void semaphore::post()
+{
+  RTXX_TRACE(post, this, 0);
+  sim::detail::sem_post(sem_);
+}
+
+void semaphore::wait()
+{
+  RTXX_TRACE(wait_begin, this, 0);
+  sim::detail::sem_wait(sem_, -1);
+  RTXX_TRACE(wait_end, this, 0);
+}
+
+bool semaphore::try_wait() { return sim::detail::sem_try_wait(sem_); }
+
+bool semaphore::wait_until(const struct timespec *abs_timeout)
+{
+  return clock_wait(CLOCK_REALTIME, abs_timeout);
+}
+
+bool semaphore::clock_wait(clockid_t, const struct timespec *abs_timeout)
+{
+  RTXX_TRACE(wait_begin, this, 0);
+  const bool got =
+      sim::detail::sem_wait(sem_, sim::detail::to_ns(abs_timeout));
+  RTXX_TRACE(wait_end, this, !got);
+  return got;
+}
+
+semaphore::value_type semaphore::get_value() const
+{
+  return sim::detail::sem_value(sem_);
+}
+
+#elif defined(RTXX_USE_POSIX)
+semaphore::semaphore(value_type init_value, const options &opt)
+{
+  int err = sem_init(&sem_, opt.process_shared, init_value);
   if (err == -1)
     throw system_error(errno, system_category(), "semaphore::semaphore");
 }
@@ -18,11 +74,12 @@ semaphore::~semaphore()
 {
   int err = sem_destroy(&sem_);
   if (err == -1)
-    perror("semaphore::~semaphore");
+    log::error("semaphore::~semaphore: %s", strerror(errno));
 }
 
 void semaphore::post()
 {
+  RTXX_TRACE(post, this, 0);
   int err = sem_post(&sem_);
   if (err == -1)
     throw system_error(errno, system_category(), "semaphore::post");
@@ -30,7 +87,9 @@ void semaphore::post()
 
 void semaphore::wait()
 {
+  RTXX_TRACE(wait_begin, this, 0);
   int err = sem_wait(&sem_);
+  RTXX_TRACE(wait_end, this, 0);
   if (err == -1)
     throw system_error(errno, system_category(), "semaphore::wait");
 }
@@ -48,7 +107,20 @@ bool semaphore::try_wait()
 
 bool semaphore::wait_until(const struct timespec *abs_timeout)
 {
-  int r = sem_timedwait(&sem_, abs_timeout);
+  return clock_wait(CLOCK_REALTIME, abs_timeout);
+}
+
+bool semaphore::clock_wait(clockid_t clock, const struct timespec *abs_timeout)
+{
+  RTXX_TRACE(wait_begin, this, 0);
+#if defined(RTXX_HAVE_CLOCKWAIT)
+  int r = sem_clockwait(&sem_, clock, abs_timeout);
+#else
+  const struct timespec ts =
+      detail::convert_timespec(clock, CLOCK_REALTIME, *abs_timeout);
+  int r = sem_timedwait(&sem_, &ts);
+#endif
+  RTXX_TRACE(wait_end, this, r == -1);
   if (r == -1)
   {
     if (errno == ETIMEDOUT)
@@ -87,8 +159,11 @@ semaphore::value_type semaphore::get_value() const
 
 #elif defined(RTXX_USE_ALCHEMY)
 
-semaphore::semaphore(value_type init_value)
+semaphore::semaphore(value_type init_value, const options &opt)
 {
+  if (opt.process_shared)
+    throw system_error(ENOTSUP, system_category(), "semaphore::semaphore");
+
   int err = rt_sem_create(&sem_, nullptr, init_value, S_FIFO | S_PRIO);
   if (err != 0)
     throw system_error(-err, system_category(), "semaphore::semaphore");
@@ -99,12 +174,13 @@ semaphore::~semaphore()
   int err = rt_sem_delete(&sem_);
   if (err != 0)
   {
-    fprintf(stderr, "semaphore::~semaphore: %s\n", strerror(-err));
+    log::error("semaphore::~semaphore: %s", strerror(-err));
   }
 }
 
 void semaphore::post()
 {
+  RTXX_TRACE(post, this, 0);
   int err = rt_sem_v(&sem_);
   if (err != 0)
     throw system_error(-err, system_category(), "semaphore::post");
@@ -112,7 +188,9 @@ void semaphore::post()
 
 void semaphore::wait()
 {
+  RTXX_TRACE(wait_begin, this, 0);
   int err = rt_sem_p(&sem_, TM_INFINITE);
+  RTXX_TRACE(wait_end, this, 0);
   if (err != 0)
     throw system_error(-err, system_category(), "semaphore::wait");
 }
@@ -130,7 +208,15 @@ bool semaphore::try_wait()
 
 bool semaphore::wait_until(const struct timespec *abs_timeout)
 {
+  // Alchemy has a single timeline.
+  return clock_wait(CLOCK_MONOTONIC, abs_timeout);
+}
+
+bool semaphore::clock_wait(clockid_t, const struct timespec *abs_timeout)
+{
+  RTXX_TRACE(wait_begin, this, 0);
   int err = rt_sem_p_timed(&sem_, abs_timeout);
+  RTXX_TRACE(wait_end, this, err != 0);
 
   if (err == 0)
     return true;
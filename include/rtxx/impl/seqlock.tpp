@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstring>
+#include <rtxx/impl/cpu_relax.hpp>
+#include <rtxx/seqlock.hpp>
+
+namespace rtxx
+{
+template <typename T> seqlock<T>::seqlock() noexcept : seqlock(T()) {}
+
+template <typename T> seqlock<T>::seqlock(const T &value) noexcept
+{
+  word buf[word_count] = {};
+  std::memcpy(buf, &value, sizeof(T));
+  for (std::size_t i = 0; i != word_count; ++i)
+    words_[i].store(buf[i], std::memory_order_relaxed);
+}
+
+template <typename T> void seqlock<T>::store(const T &value) noexcept
+{
+  word buf[word_count] = {};
+  std::memcpy(buf, &value, sizeof(T));
+
+  const auto seq = seq_.load(std::memory_order_relaxed);
+  seq_.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  for (std::size_t i = 0; i != word_count; ++i)
+    words_[i].store(buf[i], std::memory_order_relaxed);
+
+  seq_.store(seq + 2, std::memory_order_release);
+}
+
+template <typename T> void seqlock<T>::copy_out(T &value) const noexcept
+{
+  word buf[word_count];
+  for (std::size_t i = 0; i != word_count; ++i)
+    buf[i] = words_[i].load(std::memory_order_relaxed);
+  std::memcpy(&value, buf, sizeof(T));
+}
+
+template <typename T> bool seqlock<T>::try_load(T &value) const noexcept
+{
+  const auto before = seq_.load(std::memory_order_acquire);
+  if (before & 1)
+    return false;
+
+  T copy;
+  copy_out(copy);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (seq_.load(std::memory_order_relaxed) != before)
+    return false;
+
+  value = copy;
+  return true;
+}
+
+template <typename T> T seqlock<T>::load() const noexcept
+{
+  T value;
+  while (!try_load(value))
+    detail::cpu_relax();
+  return value;
+}
+
+} // namespace rtxx
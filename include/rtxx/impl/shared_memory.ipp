@@ -0,0 +1,93 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <rtxx/log.hpp>
+#include <rtxx/shared_memory.hpp>
+
+namespace rtxx
+{
+shared_memory::shared_memory(const char *name, std::size_t size, mode m)
+    : size_(size)
+{
+  int fd = -1;
+  switch (m)
+  {
+  case mode::create:
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    created_ = true;
+    break;
+  case mode::open:
+    fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+    break;
+  case mode::open_or_create:
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    created_ = fd != -1;
+    if (fd == -1 && errno == EEXIST)
+      fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+    break;
+  }
+  if (fd == -1)
+    throw system_error(errno, system_category(), "shared_memory::shared_memory");
+
+  struct stat st;
+  int err = 0;
+  if (created_ && ftruncate(fd, size) == -1)
+    err = errno;
+  else if (!created_ && fstat(fd, &st) == 0 &&
+           static_cast<std::size_t>(st.st_size) < size)
+    err = EINVAL;
+
+  if (!err)
+  {
+    data_ = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE | MAP_LOCKED, fd, 0);
+    if (data_ == MAP_FAILED)
+    {
+      // MAP_LOCKED fails without the right to lock memory.
+      data_ = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, 0);
+    }
+    if (data_ == MAP_FAILED)
+    {
+      err = errno;
+      data_ = nullptr;
+    }
+  }
+
+  ::close(fd);
+  if (err)
+  {
+    if (created_)
+      shm_unlink(name);
+    throw system_error(err, system_category(), "shared_memory::shared_memory");
+  }
+}
+
+shared_memory::~shared_memory()
+{
+  if (data_ && munmap(data_, size_) == -1)
+    log::error("shared_memory::~shared_memory: %s", strerror(errno));
+}
+
+void shared_memory::remove(const char *name, error_code &ec) noexcept
+{
+  if (shm_unlink(name) == -1)
+    return ec.assign(errno, system_category());
+  ec.clear();
+}
+
+void shared_memory::remove(const char *name)
+{
+  error_code ec;
+  remove(name, ec);
+  if (ec)
+    throw system_error(ec, "shared_memory::remove");
+}
+
+} // namespace rtxx
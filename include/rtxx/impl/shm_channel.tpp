@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstring>
+#include <new>
+#include <rtxx/impl/futex.hpp>
+#include <rtxx/shm_channel.hpp>
+
+namespace rtxx
+{
+template <typename T>
+shm_channel<T>::shm_channel(const char *name, size_type capacity,
+                            shared_memory::mode m)
+    : shm_(name, slots_offset() + capacity * sizeof(T), m), mask_(capacity - 1)
+{
+  if (capacity < 2 || (capacity & mask_) != 0)
+  {
+    if (shm_.created())
+      shared_memory::remove(name);
+    throw system_error(make_error_code(errc::invalid_argument),
+                       "shm_channel::shm_channel");
+  }
+
+  header *h = hdr();
+  if (shm_.created())
+  {
+    // The segment is zero-filled, the opener checks magic last.
+    ::new (h) header{};
+    h->capacity = capacity;
+    h->msg_size = sizeof(T);
+    h->magic.store(magic_value, std::memory_order_release);
+  }
+  else if (h->magic.load(std::memory_order_acquire) != magic_value ||
+           h->capacity != capacity || h->msg_size != sizeof(T))
+  {
+    throw system_error(make_error_code(errc::invalid_argument),
+                       "shm_channel::shm_channel");
+  }
+}
+
+template <typename T> T *shm_channel<T>::try_loan() noexcept
+{
+  header *h = hdr();
+  const auto tail = h->tail.load(std::memory_order_relaxed);
+  if (tail - h->head.load(std::memory_order_acquire) > mask_)
+    return nullptr;
+  return slot(tail);
+}
+
+template <typename T> void shm_channel<T>::commit() noexcept
+{
+  header *h = hdr();
+  h->tail.store(h->tail.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+
+  // Pairs with the fence in wait(): either the consumer sees the new tail,
+  // or we see its waiting flag.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (h->waiting.load(std::memory_order_relaxed) &&
+      h->waiting.exchange(0, std::memory_order_relaxed))
+    detail::futex_wake(&h->waiting, 1, true);
+}
+
+template <typename T> bool shm_channel<T>::try_send(const T &msg) noexcept
+{
+  T *p = try_loan();
+  if (!p)
+    return false;
+  std::memcpy(p, &msg, sizeof(T));
+  commit();
+  return true;
+}
+
+template <typename T> const T *shm_channel<T>::try_peek() noexcept
+{
+  header *h = hdr();
+  const auto head = h->head.load(std::memory_order_relaxed);
+  if (head == h->tail.load(std::memory_order_acquire))
+    return nullptr;
+  return slot(head);
+}
+
+template <typename T> void shm_channel<T>::release() noexcept
+{
+  header *h = hdr();
+  h->head.store(h->head.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+}
+
+template <typename T> bool shm_channel<T>::try_receive(T &msg) noexcept
+{
+  const T *p = try_peek();
+  if (!p)
+    return false;
+  std::memcpy(&msg, p, sizeof(T));
+  release();
+  return true;
+}
+
+template <typename T>
+bool shm_channel<T>::wait(const struct timespec *timeout) noexcept
+{
+  header *h = hdr();
+  const auto head = h->head.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    if (head != h->tail.load(std::memory_order_acquire))
+      return true;
+
+    h->waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (head != h->tail.load(std::memory_order_relaxed))
+    {
+      h->waiting.store(0, std::memory_order_relaxed);
+      return true;
+    }
+
+    // A relative timeout restarts on EINTR, good enough for a consumer
+    // which only bounds how long it waits for data.
+    const int err = detail::futex_wait(&h->waiting, 1, timeout, true);
+    if (err == ETIMEDOUT)
+    {
+      h->waiting.store(0, std::memory_order_relaxed);
+      return head != h->tail.load(std::memory_order_acquire);
+    }
+  }
+}
+
+template <typename T> void shm_channel<T>::receive(T &msg) noexcept
+{
+  while (!try_receive(msg))
+    wait(nullptr);
+}
+
+template <typename T>
+template <typename Rep, typename Period>
+bool shm_channel<T>::receive_for(T &msg,
+                                 chrono::duration<Rep, Period> const &rel_time)
+{
+  if (try_receive(msg))
+    return true;
+  const auto ts = detail::duration_to_timespec(rel_time);
+  return wait(&ts) && try_receive(msg);
+}
+
+} // namespace rtxx
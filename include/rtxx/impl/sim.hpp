@@ -0,0 +1,645 @@
+#pragma once
+
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <rtxx/config.hpp>
+
+namespace rtxx
+{
+namespace sim
+{
+namespace detail
+{
+/// The virtual clock, read by monotonic_clock and realtime_clock.
+/** Written by the running thread only, with the scheduler lock held. */
+inline std::atomic<std::int64_t> &virtual_time() noexcept
+{
+  static std::atomic<std::int64_t> t{0};
+  return t;
+}
+
+inline std::int64_t now() noexcept
+{
+  return virtual_time().load(std::memory_order_relaxed);
+}
+
+/// Convert an absolute timeout to virtual nanoseconds, -1 for none.
+/** Both clocks read the same virtual timeline. */
+inline std::int64_t to_ns(const struct timespec *abs_time) noexcept
+{
+  if (!abs_time)
+    return -1;
+  return abs_time->tv_nsec +
+         static_cast<std::int64_t>(abs_time->tv_sec) * 1'000'000'000LL;
+}
+
+struct thread;
+
+/// Threads sorted by decreasing priority, first come first served among
+/// equal priorities.
+struct wait_queue
+{
+  thread *head{};
+};
+
+/// State of a simulated mutex.
+struct mutex_state
+{
+  thread *owner{};
+  wait_queue waiters;
+
+  /// mutex::protocol_type, and the ceiling of protocol_type::protect.
+  int protocol{0};
+  int ceiling{0};
+
+  /// Next mutex held by the same owner.
+  mutex_state *next_held{};
+};
+
+/// Values of mutex_state::protocol.
+constexpr int protocol_inherit = 1;
+constexpr int protocol_protect = 2;
+
+/// State of a simulated semaphore.
+struct semaphore_state
+{
+  unsigned count{0};
+  wait_queue waiters;
+};
+
+/// A host thread taking part in the simulation.
+/** Only the thread designated by scheduler::running executes, the others
+ *  sleep on their own host condition variable.
+ */
+struct thread
+{
+  /// Priority given at creation, and the one boosted by mutexes.
+  int base_priority{0};
+  int priority{0};
+
+  /// Queue the thread is in, the ready queue or the one it waits on.
+  wait_queue *queue{};
+  thread *next{};
+
+  /// Mutex the thread waits for, to propagate priority inheritance.
+  mutex_state *blocked_on{};
+
+  /// Timeout, -1 for none, and link in the timer list.
+  std::int64_t wake_at{-1};
+  thread *next_timer{};
+  bool timed_out{false};
+
+  /// Mutexes held, linked through mutex_state::next_held.
+  mutex_state *held{};
+
+  /// Threads joining this one.
+  wait_queue joiners;
+  bool finished{false};
+  bool detached{false};
+
+  std::condition_variable cv;
+};
+
+/// The single virtual CPU.
+struct scheduler
+{
+  std::mutex lock;
+  thread *running{};
+  wait_queue ready;
+
+  /// Threads with a timeout, earliest first.
+  thread *timers{};
+
+  std::uint64_t switches{0};
+};
+
+inline scheduler &state() noexcept
+{
+  static scheduler s;
+  return s;
+}
+
+inline thread *&current_thread() noexcept
+{
+  thread_local thread *t = nullptr;
+  return t;
+}
+
+/// Insert \c t behind the threads of the same priority, or ahead of them
+/// when \c front is set.
+inline void insert(wait_queue &q, thread *t, bool front = false) noexcept
+{
+  thread **p = &q.head;
+  while (*p && ((*p)->priority > t->priority ||
+                (!front && (*p)->priority == t->priority)))
+    p = &(*p)->next;
+  t->next = *p;
+  *p = t;
+  t->queue = &q;
+}
+
+inline void remove(wait_queue &q, thread *t) noexcept
+{
+  for (thread **p = &q.head; *p; p = &(*p)->next)
+  {
+    if (*p == t)
+    {
+      *p = t->next;
+      break;
+    }
+  }
+  t->next = nullptr;
+  t->queue = nullptr;
+}
+
+inline thread *pop(wait_queue &q) noexcept
+{
+  thread *t = q.head;
+  if (t)
+    remove(q, t);
+  return t;
+}
+
+inline void arm(scheduler &s, thread *t, std::int64_t wake_at) noexcept
+{
+  t->timed_out = false;
+  t->wake_at = wake_at;
+  if (wake_at < 0)
+    return;
+
+  thread **p = &s.timers;
+  while (*p && (*p)->wake_at <= wake_at)
+    p = &(*p)->next_timer;
+  t->next_timer = *p;
+  *p = t;
+}
+
+inline void disarm(scheduler &s, thread *t) noexcept
+{
+  if (t->wake_at < 0)
+    return;
+  for (thread **p = &s.timers; *p; p = &(*p)->next_timer)
+  {
+    if (*p == t)
+    {
+      *p = t->next_timer;
+      break;
+    }
+  }
+  t->next_timer = nullptr;
+  t->wake_at = -1;
+}
+
+inline void make_ready(scheduler &s, thread *t, bool front = false) noexcept
+{
+  insert(s.ready, t, front);
+}
+
+/// Recompute the priority of \c t from the mutexes it holds, and
+/// propagate the change along the chain of owners it waits for.
+inline void update_priority(thread *t) noexcept
+{
+  while (t)
+  {
+    int p = t->base_priority;
+    for (mutex_state *m = t->held; m; m = m->next_held)
+    {
+      if (m->protocol == protocol_inherit && m->waiters.head)
+        p = std::max(p, m->waiters.head->priority);
+      else if (m->protocol == protocol_protect)
+        p = std::max(p, m->ceiling);
+    }
+    if (p == t->priority)
+      return;
+
+    t->priority = p;
+    if (wait_queue *q = t->queue)
+    {
+      remove(*q, t);
+      insert(*q, t);
+    }
+    t = t->blocked_on ? t->blocked_on->owner : nullptr;
+  }
+}
+
+/// Make the threads whose timeout is due ready.
+inline void expire(scheduler &s) noexcept
+{
+  while (s.timers && s.timers->wake_at <= now())
+  {
+    thread *t = s.timers;
+    s.timers = t->next_timer;
+    t->next_timer = nullptr;
+    t->wake_at = -1;
+    t->timed_out = true;
+
+    mutex_state *m = t->blocked_on;
+    t->blocked_on = nullptr;
+    if (t->queue)
+      remove(*t->queue, t);
+    make_ready(s, t);
+    if (m)
+      update_priority(m->owner);
+  }
+}
+
+/// Give the CPU to the next ready thread, advancing the virtual time when
+/// none is ready. Returns once \c self, if not null, runs again.
+inline void dispatch(scheduler &s, std::unique_lock<std::mutex> &lk,
+                     thread *self)
+{
+  thread *next = pop(s.ready);
+  while (!next)
+  {
+    if (!s.timers)
+    {
+      s.running = nullptr;
+      if (!self)
+        return;
+      std::fprintf(stderr, "rtxx: simulation deadlock, every task is "
+                           "blocked without timeout\n");
+      std::abort();
+    }
+    virtual_time().store(s.timers->wake_at, std::memory_order_relaxed);
+    expire(s);
+    next = pop(s.ready);
+  }
+
+  if (next != s.running)
+    ++s.switches;
+  s.running = next;
+  if (next != self)
+    next->cv.notify_one();
+  if (self)
+    self->cv.wait(lk, [&s, self] { return s.running == self; });
+}
+
+/// Detach the calling host thread from the simulation.
+inline void leave(thread *self)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  self->finished = true;
+  while (thread *j = pop(self->joiners))
+    make_ready(s, j);
+
+  current_thread() = nullptr;
+  const bool detached = self->detached;
+  dispatch(s, lk, nullptr);
+  if (detached)
+    delete self;
+}
+
+/// Owner of the state of a host thread which joined the simulation by
+/// calling into it.
+struct adopted_thread
+{
+  thread *t{};
+
+  ~adopted_thread()
+  {
+    if (t)
+    {
+      t->detached = true;
+      leave(t);
+    }
+  }
+};
+
+/// Get the calling thread, making it join the simulation if needed.
+/** A thread joining waits for the CPU behind the ready threads. */
+inline thread *self(scheduler &s, std::unique_lock<std::mutex> &lk)
+{
+  thread *&t = current_thread();
+  if (t)
+    return t;
+
+  thread_local adopted_thread adopted;
+  adopted.t = t = new thread;
+  if (!s.running)
+  {
+    s.running = t;
+    return t;
+  }
+  make_ready(s, t);
+  t->cv.wait(lk, [&s, t] { return s.running == t; });
+  return t;
+}
+
+/// Let a higher priority thread made ready run first.
+inline void preempt(scheduler &s, std::unique_lock<std::mutex> &lk,
+                    thread *self)
+{
+  if (s.ready.head && s.ready.head->priority > self->priority)
+  {
+    make_ready(s, self, true);
+    dispatch(s, lk, self);
+  }
+}
+
+/// Sleep on \c q until woken or until \c wake_at if not -1.
+/** @returns false on timeout */
+inline bool block(scheduler &s, std::unique_lock<std::mutex> &lk,
+                  thread *self, wait_queue *q, std::int64_t wake_at)
+{
+  if (wake_at >= 0 && wake_at <= now())
+    return false;
+
+  if (q)
+    insert(*q, self);
+  arm(s, self, wake_at);
+  dispatch(s, lk, self);
+  return !self->timed_out;
+}
+
+/// Make the first thread of \c q ready, returns it.
+inline thread *wake_one(scheduler &s, wait_queue &q) noexcept
+{
+  thread *t = pop(q);
+  if (t)
+  {
+    disarm(s, t);
+    make_ready(s, t);
+  }
+  return t;
+}
+
+inline void acquire(mutex_state &m, thread *t) noexcept
+{
+  m.owner = t;
+  m.next_held = t->held;
+  t->held = &m;
+  update_priority(t);
+}
+
+/// Release \c m, handing it over to its first waiter.
+inline void release(scheduler &s, mutex_state &m) noexcept
+{
+  thread *prev = m.owner;
+  for (mutex_state **p = &prev->held; *p; p = &(*p)->next_held)
+  {
+    if (*p == &m)
+    {
+      *p = m.next_held;
+      break;
+    }
+  }
+  m.next_held = nullptr;
+  m.owner = nullptr;
+
+  if (thread *next = pop(m.waiters))
+  {
+    disarm(s, next);
+    next->blocked_on = nullptr;
+    acquire(m, next);
+    make_ready(s, next);
+  }
+  update_priority(prev);
+}
+
+/// Lock \c m, until \c wake_at if not -1.
+/** @returns 0, \c ETIMEDOUT or \c EDEADLK */
+inline int lock(mutex_state &m, std::int64_t wake_at)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  thread *me = self(s, lk);
+  if (!m.owner)
+  {
+    acquire(m, me);
+    return 0;
+  }
+  if (m.owner == me)
+    return EDEADLK;
+
+  // The mutex is handed over by release(), so waking up means owning it.
+  me->blocked_on = &m;
+  if (wake_at >= 0 && wake_at <= now())
+  {
+    me->blocked_on = nullptr;
+    return ETIMEDOUT;
+  }
+  insert(m.waiters, me);
+  update_priority(m.owner);
+  return block(s, lk, me, nullptr, wake_at) ? 0 : ETIMEDOUT;
+}
+
+/// @returns 0 or \c EBUSY
+inline int try_lock(mutex_state &m)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  thread *me = self(s, lk);
+  if (m.owner)
+    return EBUSY;
+  acquire(m, me);
+  return 0;
+}
+
+/// @returns 0 or \c EPERM
+inline int unlock(mutex_state &m)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  thread *me = self(s, lk);
+  if (m.owner != me)
+    return EPERM;
+  release(s, m);
+  preempt(s, lk, me);
+  return 0;
+}
+
+/// Wait on \c q with \c m released, until \c wake_at if not -1.
+/** The mutex is locked again on return.
+ *  @returns 0, \c ETIMEDOUT or \c EPERM
+ */
+inline int cond_wait(wait_queue &q, mutex_state &m, std::int64_t wake_at)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  thread *me = self(s, lk);
+  if (m.owner != me)
+    return EPERM;
+  if (wake_at >= 0 && wake_at <= now())
+    return ETIMEDOUT;
+
+  insert(q, me);
+  release(s, m);
+  const bool woken = block(s, lk, me, nullptr, wake_at);
+
+  if (m.owner)
+  {
+    me->blocked_on = &m;
+    insert(m.waiters, me);
+    update_priority(m.owner);
+    block(s, lk, me, nullptr, -1);
+  }
+  else
+  {
+    acquire(m, me);
+  }
+  return woken ? 0 : ETIMEDOUT;
+}
+
+/// Wake one or all of the threads of \c q.
+inline void notify(wait_queue &q, bool all)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  thread *me = self(s, lk);
+  while (wake_one(s, q) && all)
+    ;
+  preempt(s, lk, me);
+}
+
+/// Take a unit of \c sem, until \c wake_at if not -1.
+/** @returns false on timeout */
+inline bool sem_wait(semaphore_state &sem, std::int64_t wake_at)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  thread *me = self(s, lk);
+  if (sem.count)
+  {
+    --sem.count;
+    return true;
+  }
+  // post() hands its unit over to the first waiter.
+  return block(s, lk, me, &sem.waiters, wake_at);
+}
+
+inline bool sem_try_wait(semaphore_state &sem)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  self(s, lk);
+  if (!sem.count)
+    return false;
+  --sem.count;
+  return true;
+}
+
+inline void sem_post(semaphore_state &sem)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  thread *me = self(s, lk);
+  if (!wake_one(s, sem.waiters))
+    ++sem.count;
+  preempt(s, lk, me);
+}
+
+inline unsigned sem_value(const semaphore_state &sem)
+{
+  std::lock_guard<std::mutex> lk(state().lock);
+  return sem.count;
+}
+
+/// Create the state of a task, made ready by start().
+inline thread *spawn(int priority)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  self(s, lk);
+  thread *t = new thread;
+  t->base_priority = t->priority = priority;
+  return t;
+}
+
+/// Make a task created by spawn() ready, once its host thread exists.
+inline void start(thread *t)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  thread *me = self(s, lk);
+  make_ready(s, t);
+  preempt(s, lk, me);
+}
+
+/// Wait for the CPU, from the host thread of a task.
+inline void enter(thread *t)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  current_thread() = t;
+  t->cv.wait(lk, [&s, t] { return s.running == t; });
+}
+
+/// Wait for a task to finish.
+/** @returns 0 or \c EDEADLK */
+inline int join(thread *t)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  thread *me = self(s, lk);
+  if (t == me)
+    return EDEADLK;
+  while (!t->finished)
+    block(s, lk, me, &t->joiners, -1);
+  return 0;
+}
+
+/// Let a task free its state when it finishes.
+inline void detach(thread *t)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  if (t->finished)
+    delete t;
+  else
+    t->detached = true;
+}
+
+/// Sleep until \c wake_at.
+inline void sleep_until(std::int64_t wake_at)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  thread *me = self(s, lk);
+  block(s, lk, me, nullptr, wake_at);
+}
+
+/// Let the other ready threads of the same priority run.
+inline void yield()
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  thread *me = self(s, lk);
+  make_ready(s, me);
+  dispatch(s, lk, me);
+}
+
+/// Run for \c cpu nanoseconds of virtual time, preempted by the higher
+/// priority threads whose timeout falls meanwhile.
+inline void consume(std::int64_t cpu)
+{
+  scheduler &s = state();
+  std::unique_lock<std::mutex> lk(s.lock);
+  thread *me = self(s, lk);
+  while (cpu > 0)
+  {
+    const std::int64_t t = now();
+    if (!s.timers || s.timers->wake_at > t + cpu)
+    {
+      virtual_time().store(t + cpu, std::memory_order_relaxed);
+      break;
+    }
+
+    const std::int64_t next = std::max(s.timers->wake_at, t);
+    cpu -= next - t;
+    virtual_time().store(next, std::memory_order_relaxed);
+    expire(s);
+    preempt(s, lk, me);
+  }
+}
+} // namespace detail
+} // namespace sim
+} // namespace rtxx
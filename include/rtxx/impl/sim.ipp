@@ -0,0 +1,22 @@
+#pragma once
+
+#include <rtxx/sim.hpp>
+
+namespace rtxx
+{
+namespace sim
+{
+void consume(chrono::nanoseconds cpu) { detail::consume(cpu.count()); }
+
+void sleep_until(monotonic_clock::time_point abs_time)
+{
+  detail::sleep_until(abs_time.time_since_epoch().count());
+}
+
+std::uint64_t context_switches() noexcept
+{
+  std::lock_guard<std::mutex> lk(detail::state().lock);
+  return detail::state().switches;
+}
+} // namespace sim
+} // namespace rtxx
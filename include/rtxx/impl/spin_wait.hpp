@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/impl/cpu_relax.hpp>
+
+namespace rtxx
+{
+namespace detail
+{
+/// Busy-wait until \c done() holds, for at most \c spin nanoseconds.
+/** The clock is read every few iterations only.
+ *  @returns the last value of \c done()
+ */
+template <typename Done>
+inline bool spin_until(Done &&done, std::int64_t spin) noexcept
+{
+  if (done())
+    return true;
+  if (spin <= 0)
+    return false;
+
+  const auto end = monotonic_ns() + spin;
+  do
+  {
+    for (int i = 0; i != 64; ++i)
+    {
+      cpu_relax();
+      if (done())
+        return true;
+    }
+  } while (monotonic_ns() < end);
+  return false;
+}
+} // namespace detail
+
+/// Returns an initializer for the spin option.
+/** Applies to the options of barrier and latch. */
+RTXX_INLINE_DECL constexpr auto spin_time(chrono::nanoseconds spin)
+{
+  return [spin](auto *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->spin = spin;
+  };
+}
+} // namespace rtxx
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <new>
+#include <rtxx/spsc_queue.hpp>
+#include <utility>
+
+namespace rtxx
+{
+template <typename T, std::size_t N> spsc_queue<T, N>::~spsc_queue()
+{
+  if constexpr (!std::is_trivially_destructible<T>::value)
+  {
+    const auto tail = tail_.load(std::memory_order_acquire);
+    for (auto i = head_.load(std::memory_order_relaxed); i != tail; ++i)
+      slot(i)->~T();
+  }
+}
+
+template <typename T, std::size_t N>
+typename spsc_queue<T, N>::size_type
+spsc_queue<T, N>::free_slots(size_type wanted) noexcept
+{
+  const auto tail = tail_.load(std::memory_order_relaxed);
+  if (N - (tail - head_cache_) < wanted)
+    head_cache_ = head_.load(std::memory_order_acquire);
+  return N - (tail - head_cache_);
+}
+
+template <typename T, std::size_t N>
+typename spsc_queue<T, N>::size_type
+spsc_queue<T, N>::used_slots(size_type wanted) noexcept
+{
+  const auto head = head_.load(std::memory_order_relaxed);
+  if (tail_cache_ - head < wanted)
+    tail_cache_ = tail_.load(std::memory_order_acquire);
+  return tail_cache_ - head;
+}
+
+template <typename T, std::size_t N>
+template <typename... Args>
+bool spsc_queue<T, N>::try_emplace(Args &&... args)
+{
+  if (free_slots(1) == 0)
+    return false;
+
+  const auto tail = tail_.load(std::memory_order_relaxed);
+  ::new (static_cast<void *>(&buf_[tail & mask]))
+      T(std::forward<Args>(args)...);
+  tail_.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T, std::size_t N>
+bool spsc_queue<T, N>::try_push(const T &value)
+{
+  return try_emplace(value);
+}
+
+template <typename T, std::size_t N> bool spsc_queue<T, N>::try_push(T &&value)
+{
+  return try_emplace(std::move(value));
+}
+
+template <typename T, std::size_t N>
+typename spsc_queue<T, N>::size_type
+spsc_queue<T, N>::try_push_n(const T *first, size_type n)
+{
+  n = std::min(n, free_slots(n));
+
+  const auto tail = tail_.load(std::memory_order_relaxed);
+  for (size_type i = 0; i != n; ++i)
+    ::new (static_cast<void *>(&buf_[(tail + i) & mask])) T(first[i]);
+  tail_.store(tail + n, std::memory_order_release);
+  return n;
+}
+
+template <typename T, std::size_t N> bool spsc_queue<T, N>::try_pop(T &value)
+{
+  if (used_slots(1) == 0)
+    return false;
+
+  const auto head = head_.load(std::memory_order_relaxed);
+  T *p = slot(head);
+  value = std::move(*p);
+  p->~T();
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T, std::size_t N>
+typename spsc_queue<T, N>::size_type spsc_queue<T, N>::try_pop_n(T *out,
+                                                                 size_type n)
+{
+  n = std::min(n, used_slots(n));
+
+  const auto head = head_.load(std::memory_order_relaxed);
+  for (size_type i = 0; i != n; ++i)
+  {
+    T *p = slot(head + i);
+    out[i] = std::move(*p);
+    p->~T();
+  }
+  head_.store(head + n, std::memory_order_release);
+  return n;
+}
+
+template <typename T, std::size_t N>
+bool spsc_queue<T, N>::empty() const noexcept
+{
+  return size() == 0;
+}
+
+template <typename T, std::size_t N>
+typename spsc_queue<T, N>::size_type spsc_queue<T, N>::size() const noexcept
+{
+  const auto head = head_.load(std::memory_order_acquire);
+  const auto tail = tail_.load(std::memory_order_acquire);
+  return tail - head;
+}
+
+template <typename T, std::size_t N> void blocking_spsc_queue<T, N>::notify()
+{
+  // Pairs with the fence in wait_nonempty(): either the consumer sees the
+  // new element, or we see that it is going to sleep.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting_.load(std::memory_order_relaxed) &&
+      waiting_.exchange(false, std::memory_order_acq_rel))
+    sem_.post();
+}
+
+template <typename T, std::size_t N>
+template <typename Wait>
+bool blocking_spsc_queue<T, N>::wait_nonempty(Wait &&wait)
+{
+  while (this->empty())
+  {
+    waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (!this->empty() || !wait())
+    {
+      // If the producer already cleared the flag, its post is on the way and
+      // must be consumed before the next sleep.
+      if (!waiting_.exchange(false, std::memory_order_acq_rel))
+        sem_.wait();
+      return !this->empty();
+    }
+  }
+  return true;
+}
+
+template <typename T, std::size_t N>
+bool blocking_spsc_queue<T, N>::try_push(const T &value)
+{
+  const bool ok = base::try_push(value);
+  if (ok)
+    notify();
+  return ok;
+}
+
+template <typename T, std::size_t N>
+bool blocking_spsc_queue<T, N>::try_push(T &&value)
+{
+  const bool ok = base::try_push(std::move(value));
+  if (ok)
+    notify();
+  return ok;
+}
+
+template <typename T, std::size_t N>
+template <typename... Args>
+bool blocking_spsc_queue<T, N>::try_emplace(Args &&... args)
+{
+  const bool ok = base::try_emplace(std::forward<Args>(args)...);
+  if (ok)
+    notify();
+  return ok;
+}
+
+template <typename T, std::size_t N>
+typename blocking_spsc_queue<T, N>::size_type
+blocking_spsc_queue<T, N>::try_push_n(const T *first, size_type n)
+{
+  n = base::try_push_n(first, n);
+  if (n)
+    notify();
+  return n;
+}
+
+template <typename T, std::size_t N> void blocking_spsc_queue<T, N>::pop(T &value)
+{
+  wait_nonempty([this] {
+    sem_.wait();
+    return true;
+  });
+  this->try_pop(value);
+}
+
+template <typename T, std::size_t N>
+typename blocking_spsc_queue<T, N>::size_type
+blocking_spsc_queue<T, N>::pop_n(T *out, size_type n)
+{
+  wait_nonempty([this] {
+    sem_.wait();
+    return true;
+  });
+  return this->try_pop_n(out, n);
+}
+
+template <typename T, std::size_t N>
+template <typename Rep, typename Period>
+bool blocking_spsc_queue<T, N>::pop_for(
+    T &value, chrono::duration<Rep, Period> const &rel_time)
+{
+  return wait_nonempty([&] { return sem_.wait_for(rel_time); }) &&
+         this->try_pop(value);
+}
+
+template <typename T, std::size_t N>
+template <typename Clock, typename Duration>
+bool blocking_spsc_queue<T, N>::pop_until(
+    T &value, chrono::time_point<Clock, Duration> const &abs_time)
+{
+  return wait_nonempty([&] { return sem_.wait_until(abs_time); }) &&
+         this->try_pop(value);
+}
+
+template <typename T, std::size_t N>
+bool blocking_spsc_queue<T, N>::pop_until(T &value, const deadline &d)
+{
+  return wait_nonempty([&] { return sem_.wait_until(d); }) &&
+         this->try_pop(value);
+}
+
+} // namespace rtxx
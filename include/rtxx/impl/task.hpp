@@ -23,17 +23,6 @@ inline bool task::joinable() const
 #endif
 }
 
-namespace this_task
-{
-
-unsigned wait_period(error_code &ec)
-{
-  return detail::current_task()->wait_period(ec);
-}
-
-unsigned wait_period() { return detail::current_task()->wait_period(); }
-} // namespace this_task
-
 constexpr auto priority(int value)
 {
   assert(value >= 0 && value < 100);
@@ -44,25 +33,26 @@ constexpr auto priority(int value)
   };
 }
 
-constexpr auto name(const char *name)
+constexpr auto stack_size(int size)
 {
-  return [name](task::options *opt) RTXX_CONSTEXPR_LAMBDA {
+  return [size](task::options *opt) RTXX_CONSTEXPR_LAMBDA {
     assert(opt);
-    opt->name = name;
+    opt->stack_size = size;
   };
 }
 
-constexpr auto stack_size(int size)
+constexpr auto stack(void *base, int size)
 {
-  return [size](task::options *opt) RTXX_CONSTEXPR_LAMBDA {
+  return [base, size](task::options *opt) RTXX_CONSTEXPR_LAMBDA {
     assert(opt);
+    opt->stack = base;
     opt->stack_size = size;
   };
 }
 
 constexpr auto cpu_set(const cpu_set_t *set)
 {
-  return [set](task::options *opt) RTXX_CONSTEXPR_LAMBDA {
+  return [set](auto *opt) RTXX_CONSTEXPR_LAMBDA {
     assert(opt);
     opt->cpu_set = set;
   };
@@ -76,13 +66,68 @@ constexpr auto schedpolicy(int sched)
   };
 }
 
-task::native_handle_type task::native_handle()
+constexpr auto deadline_scheduling(chrono::nanoseconds runtime,
+                                   chrono::nanoseconds period,
+                                   chrono::nanoseconds deadline)
 {
-#if defined(RTXX_USE_POSIX)
-  return h_;
-#elif defined(RTXX_USE_ALCHEMY)
-  return &task_;
-#endif
+  return [runtime, period, deadline](task::options *opt)
+             RTXX_CONSTEXPR_LAMBDA {
+               assert(opt);
+               opt->schedpolicy = SCHED_DEADLINE;
+               opt->sched_runtime = runtime;
+               opt->sched_period = period;
+               opt->sched_deadline = deadline.count() ? deadline : period;
+             };
+}
+
+constexpr auto on_overrun(overrun_policy policy)
+{
+  return [policy](task::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->overrun = policy;
+  };
+}
+
+constexpr auto on_deadline_miss(void (*fn)(task &, unsigned))
+{
+  return [fn](task::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->deadline_miss = fn;
+  };
+}
+
+constexpr auto execution_budget(chrono::nanoseconds budget,
+                                void (*exceeded)(task &))
+{
+  return [budget, exceeded](task::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->budget = budget;
+    opt->budget_exceeded = exceeded;
+  };
+}
+
+constexpr auto record_latency(bool enable)
+{
+  return [enable](task::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->record_latency = enable;
+  };
+}
+
+constexpr auto memory_resource(std::pmr::memory_resource *resource)
+{
+  return [resource](task::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->memory_resource = resource;
+  };
+}
+
+constexpr auto alloc_guard(alloc_guard_mode mode)
+{
+  return [mode](task::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->alloc_guard = mode;
+  };
 }
 
 } // namespace rtxx
@@ -1,13 +1,21 @@
 #pragma once
 
+#include <alloca.h>
+#include <pthread.h>
+#include <sys/syscall.h>
 #include <sys/timerfd.h>
 #include <unistd.h>
 
 #include <cassert>
 #include <csignal>
+#include <cstdio>
 #include <cstring>
 #include <rtxx/clock.hpp>
+#include <rtxx/impl/futex.hpp>
+#include <rtxx/log.hpp>
+#include <rtxx/runtime.hpp>
 #include <rtxx/task.hpp>
+#include <rtxx/trace.hpp>
 
 namespace rtxx
 {
@@ -17,6 +25,129 @@ enum task_flag : unsigned long
   task_auto_join = 0x0001,
 };
 
+namespace detail
+{
+/// Byte written over prefaulted stacks, to find their high-water mark.
+constexpr unsigned char stack_fill = 0xa5;
+
+/// Bytes left untouched below the frame prefaulting the stack.
+constexpr std::size_t stack_prefault_margin = 16 * 1024;
+
+/// Get the usable stack of the calling thread, guard area excluded.
+inline bool stack_bounds(unsigned char *&lo, unsigned char *&hi) noexcept
+{
+  pthread_attr_t attr;
+  if (pthread_getattr_np(pthread_self(), &attr))
+    return false;
+
+  void *addr = nullptr;
+  std::size_t size = 0, guard = 0;
+  const bool ok = !pthread_attr_getstack(&attr, &addr, &size) &&
+                  !pthread_attr_getguardsize(&attr, &guard) && size > guard;
+  pthread_attr_destroy(&attr);
+  if (!ok)
+    return false;
+
+  lo = static_cast<unsigned char *>(addr) + guard;
+  hi = static_cast<unsigned char *>(addr) + size;
+  return true;
+}
+
+/// Touch and fill the stack between \c lo and the caller's frame.
+/** @returns the lowest filled address, or \c nullptr if the stack is too
+ *  small.
+ */
+__attribute__((noinline)) inline unsigned char *
+prefault_stack(unsigned char *lo) noexcept
+{
+  unsigned char here;
+  if (&here < lo + 2 * stack_prefault_margin)
+    return nullptr;
+
+  const std::size_t n = &here - lo - stack_prefault_margin;
+  auto p = static_cast<unsigned char *>(alloca(n));
+  std::memset(p, stack_fill, n);
+  asm volatile("" : : "r"(p) : "memory");
+  return p;
+}
+
+/// Get the number of bytes used above the untouched part of the fill.
+inline std::size_t stack_usage(const unsigned char *fill,
+                               const unsigned char *hi) noexcept
+{
+  while (fill != hi && *fill == stack_fill)
+    ++fill;
+  return hi - fill;
+}
+
+/// Smallest runtime accepted by the kernel for SCHED_DEADLINE.
+constexpr chrono::nanoseconds::rep deadline_min_runtime = 1024;
+
+/// Layout of the first version of struct sched_attr, which older C
+/// libraries do not declare.
+struct deadline_attr
+{
+  std::uint32_t size;
+  std::uint32_t sched_policy;
+  std::uint64_t sched_flags;
+  std::int32_t sched_nice;
+  std::uint32_t sched_priority;
+  std::uint64_t sched_runtime;
+  std::uint64_t sched_deadline;
+  std::uint64_t sched_period;
+};
+
+/// Move the calling thread to SCHED_DEADLINE.
+/** @returns 0 or an error number. */
+inline int set_deadline_scheduling(chrono::nanoseconds::rep runtime,
+                                   chrono::nanoseconds::rep deadline,
+                                   chrono::nanoseconds::rep period) noexcept
+{
+#ifdef SYS_sched_setattr
+  deadline_attr attr{};
+  attr.size = sizeof(attr);
+  attr.sched_policy = SCHED_DEADLINE;
+  attr.sched_runtime = runtime;
+  attr.sched_deadline = deadline;
+  attr.sched_period = period;
+  if (syscall(SYS_sched_setattr, 0, &attr, 0))
+    return errno;
+  return 0;
+#else
+  (void)runtime;
+  (void)deadline;
+  (void)period;
+  return ENOSYS;
+#endif
+}
+
+/// Read a number from a file of /proc.
+inline bool read_proc_value(const char *path, long long &value) noexcept
+{
+  std::FILE *f = std::fopen(path, "r");
+  if (!f)
+    return false;
+  const bool ok = std::fscanf(f, "%lld", &value) == 1;
+  std::fclose(f);
+  return ok;
+}
+
+/// Get the bandwidth the kernel leaves to deadline tasks, in CPUs.
+inline double deadline_capacity() noexcept
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (cpus < 1)
+    cpus = 1;
+
+  long long runtime = 950000, period = 1000000;
+  read_proc_value("/proc/sys/kernel/sched_rt_runtime_us", runtime);
+  read_proc_value("/proc/sys/kernel/sched_rt_period_us", period);
+  if (runtime < 0 || period <= 0)
+    return double(cpus);
+  return double(cpus) * double(runtime) / double(period);
+}
+} // namespace detail
+
 namespace this_task
 {
 namespace detail
@@ -31,7 +162,11 @@ task *&current_task()
 void yield(error_code &ec)
 {
   int err;
-#if defined(RTXX_USE_POSIX)
+#if defined(RTXX_USE_SIM)
+  (void)err;
+  (void)ec;
+  sim::detail::yield();
+#elif defined(RTXX_USE_POSIX)
   err = pthread_yield();
   if (err != 0)
   {
@@ -46,6 +181,27 @@ void yield(error_code &ec)
 #endif
 }
 
+unsigned wait_period(error_code &ec)
+{
+  return detail::current_task()->wait_period(ec);
+}
+
+unsigned wait_period() { return detail::current_task()->wait_period(); }
+
+std::pmr::memory_resource *memory_resource() noexcept
+{
+  task *t = detail::current_task();
+  if (t && t->resource_)
+    return t->resource_;
+  return std::pmr::get_default_resource();
+}
+
+void end_warmup() noexcept
+{
+  auto &guard = rtxx::detail::alloc_guard();
+  guard.armed = guard.mode != alloc_guard_mode::off;
+}
+
 void yield()
 {
   error_code ec;
@@ -74,7 +230,7 @@ task::~task()
     int err = ::close(tfd_);
     if (err)
     {
-      fprintf(stderr, "task::~task: %s\n", strerror(errno));
+      log::error("task::~task: %s", strerror(errno));
     }
   }
 
@@ -95,7 +251,16 @@ void task::join(error_code &ec)
 {
   int err;
 
-#if defined(RTXX_USE_POSIX)
+#if defined(RTXX_USE_SIM)
+  // The task leaves the simulation before its thread ends.
+  err = sim::detail::join(sim_);
+  if (err)
+    return ec.assign(err, system_category());
+  err = pthread_join(h_, nullptr);
+  h_ = 0;
+  delete sim_;
+  sim_ = nullptr;
+#elif defined(RTXX_USE_POSIX)
   void *rv;
   err = pthread_join(h_, &rv);
   h_ = 0;
@@ -114,6 +279,11 @@ void task::set_periodic(clockid_t clock, const struct itimerspec *its,
 {
   assert(clock == CLOCK_MONOTONIC || clock == CLOCK_REALTIME);
 
+#if defined(RTXX_USE_SIM)
+  // Releases are computed on the virtual clock, no timer is needed.
+  (void)ec;
+  clk_ = clock;
+#else
   if (clk_ != clock)
   {
     if (tfd_ != -1)
@@ -133,6 +303,14 @@ void task::set_periodic(clockid_t clock, const struct itimerspec *its,
   int err = timerfd_settime(tfd_, TFD_TIMER_ABSTIME, its, nullptr);
   if (err)
     ec.assign(errno, system_category());
+#endif
+
+  release_ = its->it_value.tv_nsec +
+             static_cast<chrono::nanoseconds::rep>(its->it_value.tv_sec) *
+                 1'000'000'000LL;
+  period_ = its->it_interval.tv_nsec +
+            static_cast<chrono::nanoseconds::rep>(its->it_interval.tv_sec) *
+                1'000'000'000LL;
 }
 #elif defined(RTXX_USE_ALCHEMY)
 void task::set_periodic(RTIME start, RTIME interval, error_code &ec)
@@ -141,6 +319,10 @@ void task::set_periodic(RTIME start, RTIME interval, error_code &ec)
   err = rt_task_set_periodic(&task_, start, interval);
   if (err)
     ec.assign(-err, system_category());
+
+  release_ = start == TM_NOW ? rt_timer_ticks2ns(rt_timer_read())
+                             : rt_timer_ticks2ns(start);
+  period_ = rt_timer_ticks2ns(interval);
 }
 
 #endif
@@ -148,21 +330,329 @@ void task::set_periodic(RTIME start, RTIME interval, error_code &ec)
 unsigned task::wait_period(error_code &ec)
 {
   assert(this == this_task::detail::current_task());
+  this_task::end_warmup();
+  end_cycle();
 
 #if defined(RTXX_USE_POSIX)
+  if (tfd_ == -1 && dl_period_)
+  {
+    const unsigned missed = yield_period(ec);
+    begin_cycle();
+    return missed;
+  }
+#endif
+
+  // Releases left behind by overrun_policy::catch_up run without blocking.
+  if (pending_)
+  {
+    --pending_;
+    record_wakeup(0);
+    begin_cycle();
+    return 0;
+  }
+
+  RTXX_TRACE(wait_begin, this, 0);
+#if defined(RTXX_USE_SIM)
+  if (!period_)
+  {
+    RTXX_TRACE(wait_end, this, 1);
+    ec.assign(EINVAL, system_category());
+    return 0;
+  }
+  if (sim::detail::now() < release_)
+    sim::detail::sleep_until(release_);
+  RTXX_TRACE(wait_end, this, 0);
+  const unsigned missed = (sim::detail::now() - release_) / period_;
+#elif defined(RTXX_USE_POSIX)
   uint64_t buf;
-  int n = ::read(tfd_, &buf, sizeof(buf));
-  assert(n == sizeof(buf));
-  return buf - 1;
+  ssize_t n;
+  while ((n = ::read(tfd_, &buf, sizeof(buf))) == -1 && errno == EINTR)
+    ;
+  RTXX_TRACE(wait_end, this, 0);
+  if (n != sizeof(buf))
+  {
+    ec.assign(n == -1 ? errno : EIO, system_category());
+    return 0;
+  }
+  const unsigned missed = buf - 1;
 #elif defined(RTXX_USE_ALCHEMY)
-  unsigned long buf;
+  unsigned long buf = 0;
   int err = rt_task_wait_period(&buf);
-  if (err)
+  RTXX_TRACE(wait_end, this, 0);
+  if (err && err != -ETIMEDOUT)
+  {
     ec.assign(-err, system_category());
-  return buf;
+    return 0;
+  }
+  const unsigned missed = buf;
+#endif
+
+  const unsigned result = handle_wakeup(missed, ec);
+  begin_cycle();
+  return result;
+}
+
+unsigned task::handle_wakeup(unsigned missed, error_code &ec)
+{
+  if (!missed)
+  {
+    record_wakeup(0);
+    return 0;
+  }
+
+  if (deadline_miss_)
+    deadline_miss_(*this, missed);
+
+  switch (policy_)
+  {
+  case overrun_policy::skip:
+    record_wakeup(missed);
+    break;
+  case overrun_policy::catch_up:
+    // Run now for the oldest missed release, then once for each other.
+    overruns_.store(overruns_.load(std::memory_order_relaxed) + missed,
+                    std::memory_order_relaxed);
+    pending_ = missed;
+    record_wakeup(0);
+    return 0;
+  case overrun_policy::stretch:
+    record_wakeup(missed);
+    restart_period(ec);
+    break;
+  }
+
+#if defined(RTXX_USE_ALCHEMY)
+  if (!ec)
+    ec.assign(ETIMEDOUT, system_category());
+#endif
+  return missed;
+}
+
+void task::restart_period(error_code &ec)
+{
+#if defined(RTXX_USE_SIM)
+  (void)ec;
+  release_ = sim::detail::now() + period_;
+#elif defined(RTXX_USE_POSIX)
+  struct timespec now;
+  clock_gettime(clk_, &now);
+  const auto next = now.tv_nsec +
+                    static_cast<chrono::nanoseconds::rep>(now.tv_sec) *
+                        1'000'000'000LL +
+                    period_;
+  const struct itimerspec its = {
+      .it_interval = detail::duration_to_timespec(chrono::nanoseconds(period_)),
+      .it_value = detail::duration_to_timespec(chrono::nanoseconds(next)),
+  };
+  if (timerfd_settime(tfd_, TFD_TIMER_ABSTIME, &its, nullptr))
+    return ec.assign(errno, system_category());
+  release_ = next;
+#elif defined(RTXX_USE_ALCHEMY)
+  const RTIME interval = rt_timer_ns2ticks(period_);
+  const RTIME start = rt_timer_read() + interval;
+  int err = rt_task_set_periodic(nullptr, start, interval);
+  if (err)
+    return ec.assign(-err, system_category());
+  release_ = rt_timer_ticks2ns(start);
+#endif
+}
+
+int task::start_budget() noexcept
+{
+#if defined(RTXX_USE_POSIX)
+  int err = pthread_getcpuclockid(pthread_self(), &cpu_clk_);
+  if (err)
+    return err;
+
+  struct sigaction sa = {};
+  sa.sa_sigaction = budget_signal;
+  sa.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  if (sigaction(RTXX_BUDGET_SIGNAL, &sa, nullptr))
+    return errno;
+
+  struct sigevent sev = {};
+  sev.sigev_notify = SIGEV_THREAD_ID;
+  sev.sigev_signo = RTXX_BUDGET_SIGNAL;
+  sev.sigev_value.sival_ptr = this;
+  // sigev_notify_thread_id, which the C library does not name.
+  sev._sigev_un._tid = syscall(SYS_gettid);
+  if (timer_create(cpu_clk_, &sev, &budget_timer_))
+    return errno;
+  return 0;
+#else
+  return ENOTSUP;
+#endif
+}
+
+void task::end_cycle() noexcept
+{
+#if defined(RTXX_USE_POSIX)
+  if (!budget_ || cycle_start_ < 0)
+    return;
+
+  struct timespec ts;
+  clock_gettime(cpu_clk_, &ts);
+  const auto used = ts.tv_nsec +
+                    static_cast<chrono::nanoseconds::rep>(ts.tv_sec) *
+                        1'000'000'000LL -
+                    cycle_start_;
+  if (used > max_exec_time_.load(std::memory_order_relaxed))
+    max_exec_time_.store(used, std::memory_order_relaxed);
+  if (used > budget_)
+    budget_overruns_.store(
+        budget_overruns_.load(std::memory_order_relaxed) + 1,
+        std::memory_order_relaxed);
+#endif
+}
+
+void task::begin_cycle() noexcept
+{
+#if defined(RTXX_USE_POSIX)
+  if (!budget_)
+    return;
+
+  struct timespec ts;
+  clock_gettime(cpu_clk_, &ts);
+  cycle_start_ =
+      ts.tv_nsec + static_cast<chrono::nanoseconds::rep>(ts.tv_sec) *
+                       1'000'000'000LL;
+
+  const struct itimerspec its = {
+      .it_interval = {},
+      .it_value = detail::duration_to_timespec(chrono::nanoseconds(budget_)),
+  };
+  timer_settime(budget_timer_, 0, &its, nullptr);
+#endif
+}
+
+#if defined(RTXX_USE_POSIX)
+void task::budget_signal(int, siginfo_t *info, void *) noexcept
+{
+  if (info->si_code != SI_TIMER)
+    return;
+
+  auto self = static_cast<task *>(info->si_value.sival_ptr);
+  if (self->budget_exceeded_)
+    self->budget_exceeded_(*self);
+}
+#endif
+
+unsigned task::yield_period(error_code &ec)
+{
+#if defined(RTXX_USE_POSIX)
+  // Yielding gives up the rest of the runtime: the kernel throttles the
+  // task until its reservation is replenished at the next period.
+  RTXX_TRACE(wait_begin, this, 0);
+  if (sched_yield())
+    ec.assign(errno, system_category());
+  RTXX_TRACE(wait_end, this, 0);
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  const auto now = ts.tv_nsec + static_cast<chrono::nanoseconds::rep>(
+                                    ts.tv_sec) * 1'000'000'000LL;
+
+  // The first period starts when the task enters the scheduler, which is
+  // not observable: take the first return as the reference instead.
+  if (!release_)
+  {
+    release_ = now + period_;
+    return 0;
+  }
+
+  const unsigned overrun =
+      now > release_ + period_ ? (now - release_) / period_ : 0;
+  if (overrun && deadline_miss_)
+    deadline_miss_(*this, overrun);
+  record_wakeup(overrun);
+  return overrun;
+#else
+  ec.assign(ENOTSUP, system_category());
+  return 0;
+#endif
+}
+
+void task::record_wakeup(unsigned overrun) noexcept
+{
+#ifdef RTXX_ENABLE_TRACE
+  constexpr bool traced = true;
+#else
+  constexpr bool traced = false;
+#endif
+
+  chrono::nanoseconds::rep now = 0;
+  if (latency_ || traced)
+  {
+#if defined(RTXX_USE_SIM)
+    now = sim::detail::now();
+#elif defined(RTXX_USE_POSIX)
+    struct timespec ts;
+    clock_gettime(clk_, &ts);
+    now = ts.tv_nsec + static_cast<chrono::nanoseconds::rep>(ts.tv_sec) *
+                           1'000'000'000LL;
+#elif defined(RTXX_USE_ALCHEMY)
+    now = rt_timer_ticks2ns(rt_timer_read());
+#endif
+  }
+
+  const auto release = release_ + overrun * period_;
+  release_ = release + period_;
+
+  overruns_.store(overruns_.load(std::memory_order_relaxed) + overrun,
+                  std::memory_order_relaxed);
+
+  if (latency_)
+    latency_->record(chrono::nanoseconds(now - release));
+
+#ifdef RTXX_ENABLE_TRACE
+  const auto late = now - release;
+  RTXX_TRACE(wakeup, this,
+             late < 0 ? 0 : late > UINT32_MAX ? UINT32_MAX : late);
 #endif
 }
 
+latency_snapshot task::wakeup_latency() const
+{
+  if (!latency_)
+    return latency_snapshot();
+  return latency_->snapshot();
+}
+
+task::native_handle_type task::native_handle()
+{
+#if defined(RTXX_USE_POSIX)
+  return h_;
+#elif defined(RTXX_USE_ALCHEMY)
+  return &task_;
+#endif
+}
+
+unsigned long task::overruns() const noexcept
+{
+  return overruns_.load(std::memory_order_relaxed);
+}
+
+std::size_t task::stack_high_water() const noexcept
+{
+  return stack_high_water_;
+}
+
+unsigned long task::budget_overruns() const noexcept
+{
+  return budget_overruns_.load(std::memory_order_relaxed);
+}
+
+chrono::nanoseconds task::max_execution_time() const noexcept
+{
+  return chrono::nanoseconds(max_exec_time_.load(std::memory_order_relaxed));
+}
+
+unsigned long task::heap_allocations() const noexcept
+{
+  return heap_allocations_.load(std::memory_order_relaxed);
+}
+
 unsigned task::wait_period()
 {
   error_code ec;
@@ -176,6 +666,10 @@ void task::detach()
 {
   assert(this != this_task::detail::current_task());
 
+#if defined(RTXX_USE_SIM)
+  sim::detail::detach(sim_);
+  sim_ = nullptr;
+#endif
 #if defined(RTXX_USE_POSIX)
   int err = pthread_detach(h_);
   h_ = 0;
@@ -193,6 +687,24 @@ void *task::entry(void *arg) noexcept
 {
   auto self = reinterpret_cast<task *>(arg);
   this_task::detail::current_task() = self;
+  detail::alloc_guard() = {self->alloc_guard_, false, &self->heap_allocations_};
+
+#if defined(RTXX_USE_SIM)
+  // The state is read first: a detached task may be gone once it left.
+  sim::detail::thread *const sim = self->sim_;
+  sim::detail::enter(sim);
+#endif
+
+#if defined(RTXX_USE_POSIX)
+  if (self->name_)
+  {
+    int r = pthread_setname_np(pthread_self(), self->name_);
+    if (r)
+    {
+      log::error("pthread_setname_np: %s", strerror(r));
+    }
+  }
+#endif
 
 #if defined(RTXX_USE_POSIX) && defined(RTXX_DEBUG)
   signal(SIGDEBUG, [](int sig) {
@@ -205,11 +717,36 @@ void *task::entry(void *arg) noexcept
     int err = pthread_setmode_np(0, PTHREAD_WARNSW, nullptr);
     if (err)
     {
-      fprintf(stderr, "task::entry: %s\n", strerror(err));
+      log::error("task::entry: %s", strerror(err));
     }
   }
 #endif
 
+#if defined(RTXX_USE_POSIX)
+  if (self->dl_runtime_ || self->budget_)
+  {
+    // The creator waits for this, as a reservation refused by admission
+    // control or a missing budget timer must fail the construction of the
+    // task.
+    int err = 0;
+    if (self->dl_runtime_)
+      err = detail::set_deadline_scheduling(
+          self->dl_runtime_, self->dl_deadline_, self->dl_period_);
+    if (!err && self->budget_)
+      err = self->start_budget();
+    self->start_error_ = err;
+    self->started_.store(1, std::memory_order_release);
+    detail::futex_wake(&self->started_, 1, false);
+    if (err)
+      return nullptr;
+  }
+#endif
+
+  unsigned char *stack_lo = nullptr, *stack_hi = nullptr, *fill = nullptr;
+  if (runtime::current().prefault_stacks &&
+      detail::stack_bounds(stack_lo, stack_hi))
+    fill = detail::prefault_stack(stack_lo);
+
   try
   {
     self->fn_();
@@ -218,6 +755,20 @@ void *task::entry(void *arg) noexcept
   {
     std::terminate();
   }
+
+  detail::alloc_guard().armed = false;
+
+#if defined(RTXX_USE_POSIX)
+  if (self->budget_)
+    timer_delete(self->budget_timer_);
+#endif
+
+  if (fill)
+    self->stack_high_water_ = detail::stack_usage(fill, stack_hi);
+
+#if defined(RTXX_USE_SIM)
+  sim::detail::leave(sim);
+#endif
   return nullptr;
 }
 
@@ -227,6 +778,23 @@ void task::init(task::options const &opt, error_code &ec)
   int err;
   pthread_attr_t attr;
 
+  if (opt.record_latency)
+    latency_.reset(new latency_histogram);
+
+  resource_ = opt.memory_resource;
+  alloc_guard_ = opt.alloc_guard;
+  policy_ = opt.overrun;
+  deadline_miss_ = opt.deadline_miss;
+  budget_ = opt.budget.count();
+  budget_exceeded_ = opt.budget_exceeded;
+  if (budget_ < 0)
+    return ec.assign(EINVAL, system_category());
+#if defined(RTXX_USE_SIM)
+  // Reservations and budgets are not simulated.
+  if (opt.schedpolicy == SCHED_DEADLINE || budget_)
+    return ec.assign(ENOTSUP, system_category());
+#endif
+
   struct destroy_attr
   {
     pthread_attr_t *p_attr;
@@ -236,7 +804,7 @@ void task::init(task::options const &opt, error_code &ec)
       int err = pthread_attr_destroy(p_attr);
       if (err)
       {
-        fprintf(stderr, "task::init: %s", strerror(err));
+        log::error("task::init: %s", strerror(err));
       }
     }
   };
@@ -247,7 +815,31 @@ void task::init(task::options const &opt, error_code &ec)
 
   const destroy_attr guard{&attr};
 
-  if (opt.priority > 0)
+#if !defined(RTXX_USE_SIM)
+  // Under the simulation, priorities are applied by its scheduler and all
+  // tasks share one virtual CPU.
+  if (opt.schedpolicy == SCHED_DEADLINE)
+  {
+    // The reservation is applied by the task itself, as pthread attributes
+    // cannot carry it.
+    dl_runtime_ = opt.sched_runtime.count();
+    dl_deadline_ = opt.sched_deadline.count() ? opt.sched_deadline.count()
+                                              : opt.sched_period.count();
+    dl_period_ =
+        opt.sched_period.count() ? opt.sched_period.count() : dl_deadline_;
+    if (dl_runtime_ < detail::deadline_min_runtime ||
+        dl_runtime_ > dl_deadline_ || dl_deadline_ > dl_period_)
+      return ec.assign(EINVAL, system_category());
+
+    // Without set_periodic(), wait_period() follows the periods of the
+    // kernel, whose releases can be neither replayed nor moved.
+    if (policy_ != overrun_policy::skip)
+      return ec.assign(EINVAL, system_category());
+
+    clk_ = CLOCK_MONOTONIC;
+    period_ = dl_period_;
+  }
+  else if (opt.priority > 0)
   {
     err = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
     if (err)
@@ -264,40 +856,72 @@ void task::init(task::options const &opt, error_code &ec)
     if (err)
       return ec.assign(err, system_category());
   }
+#endif
 
-  if (opt.stack_size > 0)
+  if (opt.stack)
+  {
+    err = pthread_attr_setstack(&attr, opt.stack, opt.stack_size);
+    if (err)
+      return ec.assign(err, system_category());
+  }
+  else if (opt.stack_size > 0)
   {
     err = pthread_attr_setstacksize(&attr, opt.stack_size);
     if (err)
       return ec.assign(err, system_category());
   }
 
-  if (opt.cpu_set)
+#if !defined(RTXX_USE_SIM)
+  const cpu_set_t *cpus =
+      opt.affinity.empty() ? opt.cpu_set : opt.affinity.native_handle();
+  if (cpus)
   {
-#if defined(HAVE_PTHREAD_ATTR_SETAFFINITY_NP)
-    err = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), opt.cpu_set);
+#if defined(RTXX_HAVE_PTHREAD_ATTR_SETAFFINITY_NP)
+    err = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), cpus);
     if (err)
       return ec.assign(err, system_category());
+#else
+    return ec.assign(ENOTSUP, system_category());
 #endif
   }
+#endif
+
+  name_ = opt.name;
 
   err = pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
   if (err)
     return ec.assign(err, system_category());
 
+#if defined(RTXX_USE_SIM)
+  sim_ = sim::detail::spawn(opt.priority);
+#endif
+
   pthread_t t;
   err = pthread_create(&t, &attr, entry, this);
   if (err)
+  {
+#if defined(RTXX_USE_SIM)
+    delete sim_;
+    sim_ = nullptr;
+#endif
     return ec.assign(err, system_category());
+  }
 
   h_ = t;
+#if defined(RTXX_USE_SIM)
+  sim::detail::start(sim_);
+#endif
 
-  if (opt.name)
+  if (dl_runtime_ || budget_)
   {
-    int r = pthread_setname_np(h_, opt.name);
-    if (r)
+    while (!started_.load(std::memory_order_acquire))
+      detail::futex_wait(&started_, 0, nullptr, false);
+
+    if (start_error_)
     {
-      fprintf(stderr, "pthread_setname_np: %s\n", strerror(r));
+      pthread_join(h_, nullptr);
+      h_ = 0;
+      return ec.assign(start_error_, system_category());
     }
   }
 
@@ -308,6 +932,18 @@ void task::init(task::options const &opt, error_code &ec)
 
 void task::init(const task::options &opt, error_code &ec)
 {
+  if (opt.record_latency)
+    latency_.reset(new latency_histogram);
+
+  resource_ = opt.memory_resource;
+  alloc_guard_ = opt.alloc_guard;
+
+  policy_ = opt.overrun;
+  deadline_miss_ = opt.deadline_miss;
+
+  if (opt.stack || opt.schedpolicy == SCHED_DEADLINE || opt.budget.count())
+    return ec.assign(ENOTSUP, system_category());
+
   int mode = T_JOINABLE;
 #if defined(RTXX_DEBUG) && defined(__COBALT__)
   mode |= T_WARNSW;
@@ -317,9 +953,11 @@ void task::init(const task::options &opt, error_code &ec)
   if (err)
     return ec.assign(-err, system_category());
 
-  if (opt.cpu_set)
+  const cpu_set_t *cpus =
+      opt.affinity.empty() ? opt.cpu_set : opt.affinity.native_handle();
+  if (cpus)
   {
-    err = rt_task_set_affinity(&task_, opt.cpu_set);
+    err = rt_task_set_affinity(&task_, cpus);
     if (err)
       return ec.assign(-err, system_category());
   }
@@ -339,4 +977,36 @@ void task::init(const task::options &opt, error_code &ec)
 
 #endif
 
+deadline_admission check_deadline_admission(const task::options *tasks,
+                                            std::size_t count)
+{
+  deadline_admission result{true, 0.0, detail::deadline_capacity()};
+
+  for (std::size_t i = 0; i != count; ++i)
+  {
+    const task::options &opt = tasks[i];
+    if (opt.schedpolicy != SCHED_DEADLINE)
+      continue;
+
+    const auto runtime = opt.sched_runtime.count();
+    const auto deadline = opt.sched_deadline.count()
+                              ? opt.sched_deadline.count()
+                              : opt.sched_period.count();
+    const auto period =
+        opt.sched_period.count() ? opt.sched_period.count() : deadline;
+    if (runtime < detail::deadline_min_runtime || runtime > deadline ||
+        deadline > period)
+    {
+      result.admitted = false;
+      continue;
+    }
+
+    result.utilization += double(runtime) / double(period);
+  }
+
+  if (result.utilization > result.capacity)
+    result.admitted = false;
+  return result;
+}
+
 } // namespace rtxx
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <mutex>
+#include <rtxx/thread_pool.hpp>
+
+namespace rtxx
+{
+struct thread_pool::worker
+{
+  worker(std::size_t capacity, std::size_t index)
+      : jobs(new job_type[capacity]), capacity(capacity), index(index)
+  {
+  }
+
+  mutex lock{mutex::options{priority_inherit()}};
+  std::unique_ptr<job_type[]> jobs;
+  std::size_t capacity;
+  std::size_t head{0};
+  std::size_t count{0};
+  std::size_t index;
+  semaphore wake{0};
+  cpu_set_t cpus{};
+  char name[16]{};
+  std::unique_ptr<task> t;
+};
+
+thread_pool::thread_pool(const options &opt)
+{
+  cpu_set_t all;
+  if (!opt.affinity.empty())
+  {
+    all = *opt.affinity.native_handle();
+  }
+  else if (opt.cpu_set)
+  {
+    all = *opt.cpu_set;
+  }
+  else
+  {
+    CPU_ZERO(&all);
+    const long n = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long cpu = 0; cpu < n && cpu < CPU_SETSIZE; ++cpu)
+      CPU_SET(cpu, &all);
+  }
+
+  if (CPU_COUNT(&all) == 0 || opt.queue_capacity == 0)
+    throw system_error(make_error_code(errc::invalid_argument),
+                       "thread_pool::thread_pool");
+
+  const int priorities[2] = {opt.critical_priority, opt.background_priority};
+  const char tags[2] = {'c', 'b'};
+
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+  {
+    if (!CPU_ISSET(cpu, &all))
+      continue;
+
+    for (int l = 0; l != 2; ++l)
+    {
+      auto w = std::make_unique<worker>(opt.queue_capacity, workers_[l].size());
+      CPU_SET(cpu, &w->cpus);
+      snprintf(w->name, sizeof(w->name), "%.9s/%c%d", opt.name, tags[l], cpu);
+      workers_[l].push_back(std::move(w));
+    }
+  }
+
+  try
+  {
+    for (int l = 0; l != 2; ++l)
+    {
+      for (auto &w : workers_[l])
+      {
+        worker *self = w.get();
+        w->t = std::make_unique<task>(
+            task::options{name(w->name), priority(priorities[l]),
+                          cpu_set(&w->cpus)},
+            [this, l, self] { run(static_cast<lane>(l), *self); });
+      }
+    }
+  }
+  catch (...)
+  {
+    stop();
+    throw;
+  }
+}
+
+thread_pool::~thread_pool() { stop(); }
+
+void thread_pool::stop() noexcept
+{
+  stop_.store(true, std::memory_order_release);
+  for (auto &lane_workers : workers_)
+  {
+    for (auto &w : lane_workers)
+    {
+      if (!w->t)
+        continue;
+      w->wake.post();
+      w->t->join();
+      w->t.reset();
+    }
+  }
+}
+
+bool thread_pool::push(lane l, job_type &job) noexcept
+{
+  auto &ws = workers_[static_cast<int>(l)];
+  const auto start = next_[static_cast<int>(l)].fetch_add(
+      1, std::memory_order_relaxed);
+
+  for (std::size_t k = 0; k != ws.size(); ++k)
+  {
+    worker &w = *ws[(start + k) % ws.size()];
+    {
+      std::lock_guard<mutex> guard(w.lock);
+      if (w.count == w.capacity)
+        continue;
+      w.jobs[(w.head + w.count) % w.capacity] = std::move(job);
+      ++w.count;
+    }
+    w.wake.post();
+    return true;
+  }
+  return false;
+}
+
+bool thread_pool::pop(worker &w, job_type &job) noexcept
+{
+  std::lock_guard<mutex> guard(w.lock);
+  if (w.count == 0)
+    return false;
+  job = std::move(w.jobs[w.head]);
+  w.head = (w.head + 1) % w.capacity;
+  --w.count;
+  return true;
+}
+
+bool thread_pool::steal(lane l, const worker &self, job_type &job) noexcept
+{
+  auto &ws = workers_[static_cast<int>(l)];
+  for (std::size_t k = 1; k < ws.size(); ++k)
+  {
+    if (pop(*ws[(self.index + k) % ws.size()], job))
+      return true;
+  }
+  return false;
+}
+
+void thread_pool::run(lane l, worker &self) noexcept
+{
+  job_type job;
+  for (;;)
+  {
+    if (pop(self, job) || steal(l, self, job))
+    {
+      job();
+      job = job_type();
+      continue;
+    }
+
+    if (stop_.load(std::memory_order_acquire))
+      return;
+    self.wake.wait();
+  }
+}
+
+thread_pool::fork_join *thread_pool::acquire_fork_join() noexcept
+{
+  for (auto &fj : fork_joins_)
+  {
+    unsigned expected = 0;
+    if (fj.refs.compare_exchange_strong(expected, 1, std::memory_order_acquire))
+    {
+      // Drop wakeups left over from the previous use.
+      while (fj.done.try_wait())
+        ;
+      return &fj;
+    }
+  }
+  return nullptr;
+}
+
+void thread_pool::release(fork_join &fj) noexcept
+{
+  fj.refs.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void thread_pool::help(fork_join &fj) noexcept
+{
+  fj.running.fetch_add(1);
+  while (!fj.closed.load())
+  {
+    if (fj.deadline != monotonic_clock::time_point::max() &&
+        monotonic_clock::now() >= fj.deadline)
+    {
+      fj.closed.store(true);
+      break;
+    }
+
+    const auto i = fj.next.fetch_add(fj.grain, std::memory_order_relaxed);
+    if (i >= fj.last)
+      break;
+
+    const auto end = std::min(i + fj.grain, fj.last);
+    for (auto j = i; j != end; ++j)
+      fj.call(fj.fn, j);
+  }
+
+  if (fj.running.fetch_sub(1) == 1)
+    fj.done.post();
+}
+
+bool thread_pool::join(fork_join &fj, std::size_t helpers) noexcept
+{
+  for (std::size_t k = 0; k != helpers; ++k)
+  {
+    fj.refs.fetch_add(1, std::memory_order_relaxed);
+    job_type job([&fj] {
+      help(fj);
+      release(fj);
+    });
+    if (!push(lane::critical, job))
+    {
+      release(fj);
+      break;
+    }
+  }
+
+  help(fj);
+
+  // Helpers which have not entered the loop yet will see closed and leave
+  // without touching the caller's function.
+  fj.closed.store(true);
+  while (fj.running.load() != 0)
+    fj.done.wait();
+
+  const bool complete = fj.next.load(std::memory_order_relaxed) >= fj.last;
+  release(fj);
+  return complete;
+}
+
+} // namespace rtxx
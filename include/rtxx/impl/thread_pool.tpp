@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <rtxx/thread_pool.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace rtxx
+{
+template <typename... Initializers>
+constexpr thread_pool::options::options(Initializers &&... init) noexcept
+{
+  (init(this), ...);
+}
+
+template <typename F> bool thread_pool::try_submit(lane l, F &&f)
+{
+  job_type job(std::forward<F>(f));
+  return push(l, job);
+}
+
+template <typename F>
+bool thread_pool::parallel_for(std::size_t first, std::size_t last,
+                               std::size_t grain, F &&fn,
+                               monotonic_clock::time_point deadline)
+{
+  using callable = std::remove_reference_t<F>;
+
+  if (grain == 0)
+    grain = 1;
+  if (first >= last)
+    return true;
+
+  fork_join *fj = acquire_fork_join();
+  if (!fj)
+  {
+    // Every slot is taken, run on the caller alone.
+    for (auto i = first; i < last; i += grain)
+    {
+      if (monotonic_clock::now() >= deadline)
+        return false;
+      for (auto j = i; j != std::min(i + grain, last); ++j)
+        fn(j);
+    }
+    return true;
+  }
+
+  fj->next.store(first, std::memory_order_relaxed);
+  fj->last = last;
+  fj->grain = grain;
+  fj->deadline = deadline;
+  fj->closed.store(false, std::memory_order_relaxed);
+  fj->call = [](void *f, std::size_t i) { (*static_cast<callable *>(f))(i); };
+  fj->fn = const_cast<void *>(static_cast<const void *>(std::addressof(fn)));
+
+  const std::size_t chunks = (last - first + grain - 1) / grain;
+  return join(*fj, std::min(size(), chunks - 1));
+}
+
+constexpr auto critical_priority(int value)
+{
+  assert(value >= 0 && value < 100);
+
+  return [value](thread_pool::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->critical_priority = value;
+  };
+}
+
+constexpr auto background_priority(int value)
+{
+  assert(value >= 0 && value < 100);
+
+  return [value](thread_pool::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->background_priority = value;
+  };
+}
+
+constexpr auto queue_capacity(std::size_t n)
+{
+  return [n](thread_pool::options *opt) RTXX_CONSTEXPR_LAMBDA {
+    assert(opt);
+    opt->queue_capacity = n;
+  };
+}
+
+} // namespace rtxx
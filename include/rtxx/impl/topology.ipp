@@ -0,0 +1,269 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <rtxx/topology.hpp>
+#include <string>
+#include <utility>
+
+namespace rtxx
+{
+namespace detail
+{
+/// Read a whole sysfs attribute.
+inline bool read_text(const std::string &path, std::string &out)
+{
+  std::FILE *f = std::fopen(path.c_str(), "r");
+  if (!f)
+    return false;
+
+  out.clear();
+  char buf[256];
+  std::size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+    out.append(buf, n);
+
+  const bool failed = std::ferror(f);
+  std::fclose(f);
+  if (failed)
+    errno = EIO;
+  return !failed;
+}
+
+/// Read a sysfs attribute holding a CPU list.
+inline bool read_cpu_list(const std::string &path, cpu_mask &out)
+{
+  std::string text;
+  if (!read_text(path, text))
+    return false;
+
+  error_code ec;
+  out = cpu_mask::parse(text.c_str(), ec);
+  return !ec;
+}
+} // namespace detail
+
+topology topology::read(const char *sysfs)
+{
+  error_code ec;
+  topology t = read(sysfs, ec);
+  if (ec)
+    throw system_error(ec, "topology::read");
+  return t;
+}
+
+topology topology::read(const char *sysfs, error_code &ec)
+{
+  const std::string cpu_dir = std::string(sysfs) + "/devices/system/cpu/";
+  const std::string node_dir = std::string(sysfs) + "/devices/system/node/";
+
+  topology t;
+  std::string text;
+  if (!detail::read_text(cpu_dir + "online", text))
+  {
+    ec.assign(errno, system_category());
+    return t;
+  }
+  t.online_ = cpu_mask::parse(text.c_str(), ec);
+  if (ec)
+    return t;
+
+  // Both files are empty, or absent on older kernels, when nothing is
+  // isolated.
+  detail::read_cpu_list(cpu_dir + "isolated", t.isolated_);
+  detail::read_cpu_list(cpu_dir + "nohz_full", t.nohz_full_);
+
+  std::vector<int> node_of(cpu_mask::max_cpus, 0);
+  cpu_mask nodes;
+  detail::read_cpu_list(node_dir + "online", nodes);
+  for (int n = nodes.first(); n != -1; n = nodes.next(n))
+  {
+    cpu_mask members;
+    detail::read_cpu_list(node_dir + "node" + std::to_string(n) + "/cpulist",
+                          members);
+    for (int cpu = members.first(); cpu != -1; cpu = members.next(cpu))
+      node_of[cpu] = n;
+  }
+
+  for (int cpu = t.online_.first(); cpu != -1; cpu = t.online_.next(cpu))
+  {
+    const std::string dir = cpu_dir + "cpu" + std::to_string(cpu) + "/";
+    cpu_info info{cpu, cpu, 0, node_of[cpu], -1, -1};
+
+    cpu_mask shared;
+    if (detail::read_cpu_list(dir + "topology/thread_siblings_list", shared) &&
+        shared.test(cpu))
+      info.core = shared.first();
+
+    if (detail::read_text(dir + "topology/physical_package_id", text))
+      info.package = std::max(0, std::atoi(text.c_str()));
+
+    for (int index = 0;; ++index)
+    {
+      const std::string cache = dir + "cache/index" + std::to_string(index);
+      if (!detail::read_text(cache + "/level", text))
+        break;
+      const int level = std::atoi(text.c_str());
+
+      if (detail::read_text(cache + "/type", text) &&
+          text.compare(0, 11, "Instruction") == 0)
+        continue;
+      if (!detail::read_cpu_list(cache + "/shared_cpu_list", shared) ||
+          !shared.test(cpu))
+        continue;
+
+      if (level == 2)
+        info.l2 = shared.first();
+      else if (level == 3)
+        info.l3 = shared.first();
+    }
+
+    t.cpus_.push_back(info);
+  }
+
+  ec.clear();
+  return t;
+}
+
+const topology::cpu_info *topology::find(int cpu) const noexcept
+{
+  auto it = std::lower_bound(
+      cpus_.begin(), cpus_.end(), cpu,
+      [](const cpu_info &info, int value) { return info.cpu < value; });
+  return it != cpus_.end() && it->cpu == cpu ? &*it : nullptr;
+}
+
+cpu_mask topology::siblings(int cpu) const
+{
+  cpu_mask out;
+  if (const cpu_info *self = find(cpu))
+    for (const cpu_info &info : cpus_)
+      if (info.core == self->core)
+        out.set(info.cpu);
+  return out;
+}
+
+cpu_mask topology::sharing_cache(int cpu, int level) const
+{
+  if (level != 2 && level != 3)
+    throw system_error(make_error_code(errc::invalid_argument),
+                       "topology::sharing_cache");
+
+  cpu_mask out;
+  const cpu_info *self = find(cpu);
+  if (!self)
+    return out;
+
+  const int id = level == 2 ? self->l2 : self->l3;
+  if (id == -1)
+    return cpu_mask{cpu};
+
+  for (const cpu_info &info : cpus_)
+    if ((level == 2 ? info.l2 : info.l3) == id)
+      out.set(info.cpu);
+  return out;
+}
+
+cpu_mask topology::node(int node) const
+{
+  cpu_mask out;
+  for (const cpu_info &info : cpus_)
+    if (info.node == node)
+      out.set(info.cpu);
+  return out;
+}
+
+cpu_mask topology::cores(const cpu_mask &within) const
+{
+  cpu_mask out, seen;
+  for (const cpu_info &info : cpus_)
+  {
+    if (!within.test(info.cpu) || seen.test(info.core))
+      continue;
+    seen.set(info.core);
+    out.set(info.cpu);
+  }
+  return out;
+}
+
+cpu_mask topology::candidates(unsigned n, const cpu_mask &within) const
+{
+  if (!within.empty())
+    return within & online_;
+  if (cores(isolated_).count() >= int(n))
+    return isolated_ & online_;
+  return online_;
+}
+
+std::vector<int> topology::place_together(unsigned n,
+                                          const cpu_mask &within) const
+{
+  std::vector<int> out;
+  const cpu_mask pool = cores(candidates(n, within));
+  if (n == 0 || pool.count() < int(n))
+    return out;
+
+  // Look for the narrowest domain holding enough cores: L2, L3, NUMA node
+  // and finally the whole pool.
+  for (int scope = 0; scope != 4; ++scope)
+  {
+    for (int cpu = pool.first(); cpu != -1; cpu = pool.next(cpu))
+    {
+      cpu_mask domain = pool;
+      if (scope == 0)
+        domain &= sharing_cache(cpu, 2);
+      else if (scope == 1)
+        domain &= sharing_cache(cpu, 3);
+      else if (scope == 2)
+        domain &= node(find(cpu)->node);
+
+      if (domain.count() < int(n))
+        continue;
+
+      for (int c = domain.first(); out.size() != n; c = domain.next(c))
+        out.push_back(c);
+      return out;
+    }
+  }
+  return out;
+}
+
+std::vector<int> topology::place_apart(unsigned n,
+                                       const cpu_mask &within) const
+{
+  std::vector<int> out;
+  cpu_mask pool = cores(candidates(n, within));
+  if (n == 0 || pool.count() < int(n))
+    return out;
+
+  // Take the core sharing a node, then an L3, with the fewest cores
+  // already chosen.
+  while (out.size() != n)
+  {
+    int best = -1;
+    std::pair<int, int> best_load;
+    for (int cpu = pool.first(); cpu != -1; cpu = pool.next(cpu))
+    {
+      const cpu_info *info = find(cpu);
+      std::pair<int, int> load{0, 0};
+      for (int other : out)
+      {
+        const cpu_info *o = find(other);
+        load.first += o->node == info->node;
+        load.second += info->l3 != -1 && o->l3 == info->l3;
+      }
+      if (best == -1 || load < best_load)
+      {
+        best = cpu;
+        best_load = load;
+      }
+    }
+    out.push_back(best);
+    pool.reset(best);
+  }
+  return out;
+}
+} // namespace rtxx
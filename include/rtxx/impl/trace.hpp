@@ -0,0 +1,30 @@
+#pragma once
+
+#include <rtxx/trace.hpp>
+
+namespace rtxx
+{
+namespace trace
+{
+namespace detail
+{
+inline buffer *&current() noexcept
+{
+  thread_local buffer *b = nullptr;
+  return b;
+}
+
+inline void record(event e, const void *object, std::uint32_t arg) noexcept
+{
+  buffer *b = current();
+  if (!b && !(b = attach()))
+    return;
+
+  const auto ns = tsc_clock::now().time_since_epoch().count();
+  const auto n = b->count.load(std::memory_order_relaxed);
+  b->entries[n & (buffer::capacity - 1)] = entry{ns, object, arg, e};
+  b->count.store(n + 1, std::memory_order_release);
+}
+} // namespace detail
+} // namespace trace
+} // namespace rtxx
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <mutex>
+#include <new>
+#include <rtxx/trace.hpp>
+#include <vector>
+
+namespace rtxx
+{
+namespace trace
+{
+namespace detail
+{
+/// Process-wide list of buffers.
+struct registry
+{
+  std::mutex lock;
+  buffer *buffers{};
+};
+
+inline registry &state() noexcept
+{
+  static registry r;
+  return r;
+}
+
+buffer *attach() noexcept
+{
+  tsc_clock::calibrate();
+
+  buffer *b = new (std::nothrow) buffer;
+  if (!b)
+    return nullptr;
+
+  b->tid = syscall(SYS_gettid);
+  pthread_getname_np(pthread_self(), b->name, sizeof(b->name));
+
+  registry &st = state();
+  std::lock_guard<std::mutex> lock(st.lock);
+  b->next = st.buffers;
+  st.buffers = b;
+  current() = b;
+  return b;
+}
+
+/// Copy the events of a buffer which are not being overwritten.
+inline std::vector<entry> snapshot(const buffer &b)
+{
+  const auto last = b.count.load(std::memory_order_acquire);
+  auto first = last > buffer::capacity ? last - buffer::capacity : 0;
+
+  std::vector<entry> out;
+  out.reserve(last - first);
+  for (auto i = first; i != last; ++i)
+    out.push_back(b.entries[i & (buffer::capacity - 1)]);
+
+  // Drop the entries the owner may have overwritten meanwhile.
+  const auto now = b.count.load(std::memory_order_acquire);
+  if (now > first + buffer::capacity)
+  {
+    const auto stale = std::min<std::uint64_t>(now - first - buffer::capacity,
+                                               out.size());
+    out.erase(out.begin(), out.begin() + stale);
+  }
+  return out;
+}
+
+/// Write the events of one thread as Chrome trace events.
+inline void write_thread(std::FILE *f, const buffer &b, int pid,
+                         bool &first)
+{
+  auto sep = [&] {
+    std::fputs(first ? "\n" : ",\n", f);
+    first = false;
+  };
+
+  sep();
+  std::fprintf(f,
+               R"({"name":"thread_name","ph":"M","pid":%d,"tid":%ld,)"
+               R"("args":{"name":"%s"}})",
+               pid, b.tid, b.name[0] ? b.name : "?");
+
+  const void *pending_lock = nullptr;
+  for (const entry &e : snapshot(b))
+  {
+    const double us = e.ns / 1000.0;
+
+    auto slice = [&](char ph, const char *name, const char *key) {
+      sep();
+      std::fprintf(f,
+                   R"({"name":"%s","ph":"%c","pid":%d,"tid":%ld,"ts":%.3f,)"
+                   R"("args":{"%s":"%p"}})",
+                   name, ph, pid, b.tid, us, key, e.object);
+    };
+
+    switch (e.type)
+    {
+    case event::wakeup:
+      sep();
+      std::fprintf(f,
+                   R"({"name":"release","ph":"i","s":"t","pid":%d,)"
+                   R"("tid":%ld,"ts":%.3f})",
+                   pid, b.tid, us - e.arg / 1000.0);
+      sep();
+      std::fprintf(f,
+                   R"({"name":"wakeup","ph":"i","s":"t","pid":%d,"tid":%ld,)"
+                   R"("ts":%.3f,"args":{"latency_ns":%u}})",
+                   pid, b.tid, us, e.arg);
+      break;
+    case event::lock_request:
+      slice('B', "lock", "mutex");
+      pending_lock = e.object;
+      break;
+    case event::lock_acquire:
+      if (pending_lock == e.object)
+      {
+        slice('E', "lock", "mutex");
+        pending_lock = nullptr;
+      }
+      if (!e.arg)
+        slice('B', "locked", "mutex");
+      break;
+    case event::lock_release:
+      slice('E', "locked", "mutex");
+      break;
+    case event::wait_begin:
+      slice('B', "wait", "object");
+      break;
+    case event::wait_end:
+      slice('E', "wait", "object");
+      break;
+    case event::post:
+      sep();
+      std::fprintf(f,
+                   R"({"name":"post","ph":"i","s":"t","pid":%d,"tid":%ld,)"
+                   R"("ts":%.3f,"args":{"object":"%p"}})",
+                   pid, b.tid, us, e.object);
+      break;
+    }
+  }
+}
+} // namespace detail
+
+void attach()
+{
+#ifdef RTXX_ENABLE_TRACE
+  if (!detail::current() && !detail::attach())
+    throw std::bad_alloc();
+#endif
+}
+
+void export_json(const char *path, error_code &ec)
+{
+  std::FILE *f = std::fopen(path, "w");
+  if (!f)
+    return ec.assign(errno, system_category());
+
+  detail::registry &st = detail::state();
+  std::lock_guard<std::mutex> lock(st.lock);
+
+  const int pid = getpid();
+  bool first = true;
+  std::fputs(R"({"displayTimeUnit":"ns","traceEvents":[)", f);
+  for (auto b = st.buffers; b; b = b->next)
+    detail::write_thread(f, *b, pid, first);
+  std::fputs("\n]}\n", f);
+
+  const bool failed = std::ferror(f);
+  if (std::fclose(f) != 0 || failed)
+    return ec.assign(EIO, system_category());
+  ec.clear();
+}
+
+void export_json(const char *path)
+{
+  error_code ec;
+  export_json(path, ec);
+  if (ec)
+    throw system_error(ec, "trace::export_json");
+}
+
+void clear() noexcept
+{
+  detail::registry &st = detail::state();
+  std::lock_guard<std::mutex> lock(st.lock);
+  for (auto b = st.buffers; b; b = b->next)
+    b->count.store(0, std::memory_order_relaxed);
+}
+} // namespace trace
+} // namespace rtxx
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <rtxx/triple_buffer.hpp>
+
+namespace rtxx
+{
+template <typename T> void triple_buffer<T>::publish() noexcept
+{
+  back_ = middle_.exchange(back_ | fresh, std::memory_order_acq_rel) & ~fresh;
+}
+
+template <typename T> void triple_buffer<T>::write(const T &value)
+{
+  write_buffer() = value;
+  publish();
+}
+
+template <typename T> bool triple_buffer<T>::updated() const noexcept
+{
+  return middle_.load(std::memory_order_relaxed) & fresh;
+}
+
+template <typename T> const T &triple_buffer<T>::read() noexcept
+{
+  if (updated())
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & ~fresh;
+  return buffers_[front_].value;
+}
+
+} // namespace rtxx
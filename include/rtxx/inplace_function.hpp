@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <rtxx/config.hpp>
+#include <type_traits>
+
+namespace rtxx
+{
+template <typename Signature,
+          std::size_t Capacity = RTXX_INPLACE_FUNCTION_CAPACITY>
+class inplace_function;
+
+/// Move-only callable wrapper which never allocates.
+/** The callable is stored inside the object. Constructing from a callable
+ *  larger than \c Capacity bytes, or aligned more strictly than
+ *  \c std::max_align_t, fails to compile.
+ *
+ * @par Example
+ * @code
+ *   rtxx::inplace_function<void(int), 32> f = [&state](int v) { state = v; };
+ *   f(3);
+ * @endcode
+ */
+template <typename R, typename... Args, std::size_t Capacity>
+class inplace_function<R(Args...), Capacity>
+{
+public:
+  /// Create an empty function
+  inplace_function() noexcept = default;
+
+  /// Store a callable
+  template <typename F,
+            typename = std::enable_if_t<
+                !std::is_same<std::decay_t<F>, inplace_function>::value>>
+  inplace_function(F &&f);
+
+  /// Take the callable of \c other, leaving it empty
+  inplace_function(inplace_function &&other) noexcept;
+
+  /// Take the callable of \c other, leaving it empty
+  inplace_function &operator=(inplace_function &&other) noexcept;
+
+  /// Deleted copy constructor
+  inplace_function(const inplace_function &) = delete;
+
+  /// Deleted copy assignment operator
+  inplace_function &operator=(const inplace_function &) = delete;
+
+  /// Destroy the stored callable
+  ~inplace_function();
+
+  /// Invoke the stored callable
+  /** @par Preconditions
+   *    The function is not empty.
+   */
+  R operator()(Args... args) const;
+
+  /// Checks if a callable is stored
+  explicit operator bool() const noexcept { return vt_ != nullptr; }
+
+private:
+  struct vtable
+  {
+    R (*invoke)(void *self, Args &&... args);
+    void (*move)(void *dst, void *src) noexcept;
+    void (*destroy)(void *self) noexcept;
+  };
+
+  template <typename F> static const vtable vtable_for;
+
+  void reset() noexcept;
+
+  const vtable *vt_{};
+  alignas(std::max_align_t) mutable unsigned char storage_[Capacity];
+};
+
+} // namespace rtxx
+
+#include <rtxx/impl/inplace_function.tpp>
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/impl/spin_wait.hpp>
+
+#if defined(RTXX_USE_SIM)
+#error "rtxx::latch is not supported by the simulation backend"
+#endif
+
+#if defined(RTXX_USE_ALCHEMY)
+#include <alchemy/event.h>
+#endif
+
+namespace rtxx
+{
+/// Single-use countdown, opening once it reaches zero.
+/** Waiting tasks spin for options::spin, then sleep on a futex, or on an
+ *  event on Alchemy. Counting down never blocks.
+ *
+ * @par Example
+ * @code
+ *   rtxx::latch ready(3);
+ *
+ *   // in each of three worker tasks
+ *   init();
+ *   ready.count_down();
+ *
+ *   // in the control task
+ *   ready.wait();
+ * @endcode
+ */
+class latch
+{
+public:
+  /// Latch options
+  struct options
+  {
+    /// Time spent spinning before sleeping, zero to sleep at once
+    chrono::nanoseconds spin{chrono::microseconds(20)};
+
+    /// Construct options from convenient initializers
+    template <typename... Initializers>
+    constexpr explicit options(Initializers &&... init) noexcept;
+  };
+
+  /// Create a latch which opens after \c count decrements
+  RTXX_DECL explicit latch(unsigned count);
+
+  /// Create a latch which opens after \c count decrements
+  RTXX_DECL latch(unsigned count, const options &opt);
+
+  /// Destroy the latch
+  RTXX_DECL ~latch();
+
+  /// Deleted copy constructor
+  latch(const latch &) = delete;
+
+  /// Deleted copy assignment operator
+  latch &operator=(const latch &) = delete;
+
+  /// Decrement the count by \c n, opening the latch when it reaches zero
+  RTXX_DECL void count_down(unsigned n = 1) noexcept;
+
+  /// Checks if the latch is open
+  [[nodiscard]] bool try_wait() const noexcept
+  {
+    return count_.load(std::memory_order_acquire) == 0;
+  }
+
+  /// Wait until the latch is open
+  RTXX_DECL void wait() noexcept;
+
+  /// Decrement the count by \c n, then wait until the latch is open
+  RTXX_DECL void arrive_and_wait(unsigned n = 1) noexcept;
+
+private:
+  /// Count left, also the futex word.
+  alignas(RTXX_CACHELINE_SIZE) std::atomic<std::uint32_t> count_;
+  std::atomic<std::uint32_t> sleepers_{0};
+  const std::int64_t spin_;
+
+#if defined(RTXX_USE_ALCHEMY)
+  RT_EVENT event_;
+#endif
+};
+
+template <typename... Initializers>
+constexpr latch::options::options(Initializers &&... init) noexcept
+{
+  (init(this), ...);
+}
+
+} // namespace rtxx
+
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/latch.ipp>
+#endif
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+
+namespace rtxx
+{
+class latency_histogram;
+
+/// A copy of the content of a latency_histogram.
+class latency_snapshot
+{
+public:
+  /// Bits of precision kept inside each power of two
+  static constexpr unsigned sub_bucket_bits = 4;
+
+  /// Number of buckets per power of two
+  static constexpr std::size_t sub_bucket_count = std::size_t(1)
+                                                  << sub_bucket_bits;
+
+  /// Total number of buckets, covering the whole 64-bit range
+  static constexpr std::size_t bucket_count =
+      (64 - sub_bucket_bits + 1) * sub_bucket_count;
+
+  /// Get the bucket holding a value
+  RTXX_INLINE_DECL static constexpr std::size_t
+  bucket_index(std::uint64_t value) noexcept;
+
+  /// Get the smallest value held by a bucket
+  RTXX_INLINE_DECL static constexpr std::uint64_t
+  bucket_lower(std::size_t index) noexcept;
+
+  /// Get the largest value held by a bucket
+  RTXX_INLINE_DECL static constexpr std::uint64_t
+  bucket_upper(std::size_t index) noexcept;
+
+  /// Get the number of recorded values
+  [[nodiscard]] std::uint64_t count() const noexcept { return count_; }
+
+  /// Get the number of values recorded in a bucket
+  [[nodiscard]] std::uint64_t bucket(std::size_t index) const noexcept
+  {
+    return buckets_[index];
+  }
+
+  /// Get the smallest recorded value
+  [[nodiscard]] RTXX_INLINE_DECL chrono::nanoseconds min() const noexcept;
+
+  /// Get the largest recorded value
+  [[nodiscard]] RTXX_INLINE_DECL chrono::nanoseconds max() const noexcept;
+
+  /// Get the average of the recorded values
+  [[nodiscard]] RTXX_DECL chrono::nanoseconds mean() const noexcept;
+
+  /// Get the value below which a fraction \c p of the values lie
+  /** The result is the upper bound of the bucket holding the percentile,
+   *  capped by max(). For example \c percentile(0.999) is p99.9.
+   */
+  [[nodiscard]] RTXX_DECL chrono::nanoseconds
+  percentile(double p) const noexcept;
+
+private:
+  friend class latency_histogram;
+
+  std::array<std::uint64_t, bucket_count> buckets_{};
+  std::uint64_t count_{0};
+  std::uint64_t sum_{0};
+  std::uint64_t min_{0};
+  std::uint64_t max_{0};
+};
+
+/// Fixed-size log-linear histogram of durations.
+/** Values below 16ns are exact, larger values are kept with a relative
+ *  error below 1/16. Recording never allocates, locks or makes a system
+ *  call. There may be only one writer, while any number of other tasks
+ *  may take snapshots concurrently.
+ */
+class latency_histogram
+{
+public:
+  /// Create an empty histogram
+  latency_histogram() noexcept = default;
+
+  /// Deleted copy constructor
+  latency_histogram(const latency_histogram &) = delete;
+
+  /// Deleted copy assignment operator
+  latency_histogram &operator=(const latency_histogram &) = delete;
+
+  /// Record a value, negative durations are recorded as zero
+  /** Only one task may record into a histogram. */
+  RTXX_INLINE_DECL void record(chrono::nanoseconds value) noexcept;
+
+  /// Copy the content of the histogram
+  /** Values recorded while the copy is made may be partially counted. */
+  [[nodiscard]] RTXX_DECL latency_snapshot snapshot() const noexcept;
+
+private:
+  /// Increment a counter without a read-modify-write, as there is only one
+  /// writer.
+  RTXX_INLINE_DECL static void
+  bump(std::atomic<std::uint64_t> &counter, std::uint64_t n) noexcept;
+
+  std::atomic<std::uint64_t> buckets_[latency_snapshot::bucket_count]{};
+  std::atomic<std::uint64_t> count_{0};
+  std::atomic<std::uint64_t> sum_{0};
+  std::atomic<std::uint64_t> min_{UINT64_MAX};
+  std::atomic<std::uint64_t> max_{0};
+};
+
+} // namespace rtxx
+
+#include <rtxx/impl/latency_histogram.hpp>
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/latency_histogram.ipp>
+#endif
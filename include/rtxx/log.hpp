@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/error.hpp>
+
+namespace rtxx
+{
+/// Deferred logging for realtime tasks
+/** Logging a message only copies a timestamp, the format string pointer
+ *  and the raw arguments into a lock-free buffer owned by the calling
+ *  thread. A low-priority drain task started with log::start() formats
+ *  the records with printf syntax and writes them in batches. When a
+ *  buffer is full the record is dropped and counted, the caller never
+ *  blocks.
+ *
+ *  The format string must outlive the drain, a string literal is the
+ *  usual choice. Arguments may be integers, enumerations, floating point
+ *  numbers, pointers and C strings; strings are copied, truncated to
+ *  log::string_max bytes. The \c * width and precision are not supported.
+ *
+ *  While no drain is running, messages are formatted and written
+ *  immediately, which is what rtxx's own diagnostics rely on.
+ *
+ *  The first message logged by a thread allocates its buffer, call
+ *  log::attach() during the initialisation of realtime tasks to avoid it.
+ *
+ * @par Example
+ * @code
+ *   rtxx::log::start(rtxx::log::options{rtxx::log_buffer_size(64 << 10)},
+ *                    rtxx::task::options{rtxx::name("log")});
+ *
+ *   // periodic task
+ *   rtxx::log::attach();
+ *   for (;;)
+ *   {
+ *     rtxx::this_task::wait_period();
+ *     if (error > limit)
+ *       rtxx::log::warning("axis %d: following error %.3f", axis, error);
+ *   }
+ * @endcode
+ */
+namespace log
+{
+/// Severity of a message
+enum class level : unsigned char
+{
+  debug,
+  info,
+  warning,
+  error,
+};
+
+/// Longest string argument kept, in bytes
+constexpr std::size_t string_max = 128;
+
+/// Largest number of arguments of a message
+constexpr std::size_t max_args = 16;
+
+/// Logging options
+struct options
+{
+  /// Size of the buffer of each thread, rounded up to a power of two.
+  std::size_t buffer_size{16 << 10};
+
+  /// Descriptor the drain writes to.
+  int fd{2};
+
+  /// Interval between two passes of the drain.
+  chrono::nanoseconds period{10000000};
+
+  /// Messages below this level are discarded by the caller.
+  level min_level{level::info};
+
+  /// Construct options from convenient initializers
+  template <typename... Initializers>
+  constexpr explicit options(Initializers &&... init) noexcept;
+};
+
+/// Log a message
+template <typename... Args>
+void write(level lv, const char *fmt, const Args &... args) noexcept;
+
+/// Log a debug message
+template <typename... Args>
+void debug(const char *fmt, const Args &... args) noexcept
+{
+  write(level::debug, fmt, args...);
+}
+
+/// Log an informational message
+template <typename... Args>
+void info(const char *fmt, const Args &... args) noexcept
+{
+  write(level::info, fmt, args...);
+}
+
+/// Log a warning
+template <typename... Args>
+void warning(const char *fmt, const Args &... args) noexcept
+{
+  write(level::warning, fmt, args...);
+}
+
+/// Log an error
+template <typename... Args>
+void error(const char *fmt, const Args &... args) noexcept
+{
+  write(level::error, fmt, args...);
+}
+} // namespace log
+} // namespace rtxx
+
+// task.hpp includes this header in header-only builds: the message API
+// above must be complete before it.
+#include <rtxx/impl/log.tpp>
+#include <rtxx/task.hpp>
+
+namespace rtxx
+{
+namespace log
+{
+/// Start the drain task
+RTXX_DECL void start(const options &opt, const task::options &task_opt,
+                     error_code &ec);
+
+/// Start the drain task
+/** @throw system_error when error occurs. */
+RTXX_DECL void start(const options &opt, const task::options &task_opt);
+
+/// Stop the drain task after writing every pending message
+RTXX_DECL void stop();
+
+/// Checks if the drain task is running
+[[nodiscard]] RTXX_DECL bool running() noexcept;
+
+/// Write every pending message now, from the calling thread
+/** Waits for a drain in progress and performs I/O: not for realtime
+ *  loops.
+ */
+RTXX_DECL void flush();
+
+/// Allocate the buffer of the calling thread
+/** @throw std::bad_alloc when the buffer cannot be allocated. */
+RTXX_DECL void attach();
+
+/// Get the number of messages dropped because a buffer was full
+[[nodiscard]] RTXX_DECL unsigned long overflows() noexcept;
+} // namespace log
+
+/// Returns an initializer for the buffer_size log option.
+RTXX_INLINE_DECL constexpr auto log_buffer_size(std::size_t bytes);
+
+/// Returns an initializer for the fd log option.
+RTXX_INLINE_DECL constexpr auto log_fd(int fd);
+
+/// Returns an initializer for the period log option.
+RTXX_INLINE_DECL constexpr auto log_period(chrono::nanoseconds period);
+
+/// Returns an initializer for the min_level log option.
+RTXX_INLINE_DECL constexpr auto log_level(log::level lv);
+
+} // namespace rtxx
+
+#include <rtxx/impl/log.hpp>
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/log.ipp>
+#endif
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <rtxx/config.hpp>
+
+namespace rtxx
+{
+/// Fixed-capacity bump allocator.
+/** All memory is reserved and touched when the arena is created.
+ *  Deallocation does nothing, memory is reclaimed all at once by
+ *  release(). Unlike \c std::pmr::monotonic_buffer_resource, an exhausted
+ *  arena throws \c std::bad_alloc instead of falling back on the heap.
+ *  An arena must not be used by several tasks concurrently.
+ *
+ * @par Example
+ * @code
+ *   rtxx::monotonic_arena arena(1 << 20);
+ *   rtxx::task t(rtxx::task::options{rtxx::memory_resource(&arena)}, [] {
+ *     std::pmr::vector<int> v(rtxx::this_task::memory_resource());
+ *     v.reserve(1000);
+ *   });
+ * @endcode
+ */
+class monotonic_arena : public std::pmr::memory_resource
+{
+public:
+  /// Reserve \c size bytes from the heap
+  RTXX_DECL explicit monotonic_arena(std::size_t size);
+
+  /// Allocate from a buffer owned by the caller
+  RTXX_DECL monotonic_arena(void *buffer, std::size_t size) noexcept;
+
+  /// Deleted copy constructor
+  monotonic_arena(const monotonic_arena &) = delete;
+
+  /// Deleted copy assignment operator
+  monotonic_arena &operator=(const monotonic_arena &) = delete;
+
+  /// Give the reserved memory back to the heap, if it was taken from there
+  RTXX_DECL ~monotonic_arena() override;
+
+  /// Reclaim every allocation at once
+  RTXX_DECL void release() noexcept;
+
+  /// Get the number of bytes handed out, alignment padding included
+  [[nodiscard]] std::size_t used() const noexcept { return used_; }
+
+  /// Get the number of bytes reserved
+  [[nodiscard]] std::size_t capacity() const noexcept { return size_; }
+
+protected:
+  RTXX_DECL void *do_allocate(std::size_t bytes, std::size_t align) override;
+
+  RTXX_DECL void do_deallocate(void *p, std::size_t bytes,
+                               std::size_t align) override;
+
+  RTXX_DECL bool
+  do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+private:
+  unsigned char *buffer_;
+  std::size_t size_;
+  std::size_t used_{0};
+  bool owned_;
+};
+
+/// Pool of equally sized blocks.
+/** All blocks are reserved and touched when the pool is created.
+ *  Requests larger than the block size, aligned more strictly than
+ *  \c std::max_align_t, or made while every block is in use throw
+ *  \c std::bad_alloc. A pool must not be used by several tasks
+ *  concurrently.
+ */
+class pool_resource : public std::pmr::memory_resource
+{
+public:
+  /// Reserve \c block_count blocks of at least \c block_size bytes
+  RTXX_DECL pool_resource(std::size_t block_size, std::size_t block_count);
+
+  /// Deleted copy constructor
+  pool_resource(const pool_resource &) = delete;
+
+  /// Deleted copy assignment operator
+  pool_resource &operator=(const pool_resource &) = delete;
+
+  /// Give the reserved memory back to the heap
+  RTXX_DECL ~pool_resource() override;
+
+  /// Get the largest request a block can hold
+  [[nodiscard]] std::size_t block_size() const noexcept { return stride_; }
+
+  /// Get the number of blocks
+  [[nodiscard]] std::size_t block_count() const noexcept { return count_; }
+
+  /// Get the number of blocks not in use
+  [[nodiscard]] std::size_t available() const noexcept { return available_; }
+
+protected:
+  RTXX_DECL void *do_allocate(std::size_t bytes, std::size_t align) override;
+
+  RTXX_DECL void do_deallocate(void *p, std::size_t bytes,
+                               std::size_t align) override;
+
+  RTXX_DECL bool
+  do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+private:
+  struct block
+  {
+    block *next;
+  };
+
+  std::size_t stride_;
+  std::size_t count_;
+  std::size_t available_;
+  unsigned char *buffer_;
+  block *free_{};
+};
+
+/// What to do on a heap allocation made by a task after its warm-up
+enum class alloc_guard_mode
+{
+  /// Do not check allocations
+  off,
+  /// Count allocations, see task::heap_allocations()
+  count,
+  /// Print a message and abort the process
+  abort,
+};
+
+namespace detail
+{
+/// Allocation guard of the calling thread.
+struct alloc_guard_state
+{
+  alloc_guard_mode mode;
+  bool armed;
+  std::atomic<unsigned long> *count;
+};
+
+/// Get the allocation guard of the calling thread
+RTXX_DECL alloc_guard_state &alloc_guard() noexcept;
+
+/// Apply the allocation guard of the calling thread to a heap allocation.
+/** Called by the allocation functions of <rtxx/alloc_guard.hpp>. */
+RTXX_DECL void check_allocation() noexcept;
+} // namespace detail
+
+} // namespace rtxx
+
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/memory_resource.ipp>
+#endif
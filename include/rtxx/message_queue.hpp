@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/error.hpp>
+#include <type_traits>
+#include <utility>
+
+#if defined(RTXX_USE_POSIX)
+#include <rtxx/mutex.hpp>
+#include <rtxx/semaphore.hpp>
+#elif defined(RTXX_USE_ALCHEMY)
+#include <alchemy/queue.h>
+#endif
+
+namespace rtxx
+{
+namespace detail
+{
+/// Type-erased fixed-capacity message queue.
+/** Messages are kept in preallocated slots of \c msg_size bytes.
+ *  A \c nullptr timeout waits forever; a timeout in the past does not
+ *  block at all.
+ */
+class message_queue_base
+{
+public:
+  /// Create a queue of \c capacity slots of \c msg_size bytes each
+  RTXX_DECL message_queue_base(std::size_t msg_size, std::size_t capacity);
+
+  /// Deleted copy constructor
+  message_queue_base(const message_queue_base &) = delete;
+
+  /// Deleted copy assignment operator
+  message_queue_base &operator=(const message_queue_base &) = delete;
+
+  /// Destroy the queue
+  RTXX_DECL ~message_queue_base();
+
+  /// Take a free slot, returns \c nullptr on timeout
+  /** Timeouts are on the CLOCK_MONOTONIC timeline. On Alchemy this never
+   *  blocks, as \c rt_queue_alloc() does not.
+   */
+  RTXX_DECL void *loan(const struct timespec *abs_timeout);
+
+  /// Enqueue a loaned slot
+  RTXX_DECL void commit(void *slot, int prio);
+
+  /// Give back a loaned slot without sending it
+  RTXX_DECL void cancel(void *slot);
+
+  /// Dequeue the most urgent message, returns \c nullptr on timeout
+  RTXX_DECL void *receive(const struct timespec *abs_timeout);
+
+  /// Give back a slot returned by receive()
+  RTXX_DECL void release(void *slot);
+
+private:
+#if defined(RTXX_USE_POSIX)
+  struct node;
+
+  RTXX_DECL static node *to_node(void *slot) noexcept;
+  RTXX_DECL static void *to_slot(node *n) noexcept;
+
+  std::size_t stride_;
+  std::unique_ptr<unsigned char[]> storage_;
+
+  mutex lock_;
+  semaphore free_count_;
+  semaphore used_count_;
+
+  /// Free slots, singly linked.
+  node *free_{};
+  /// Queued messages, by descending priority and FIFO within a priority.
+  node *head_{};
+  node *tail_{};
+#elif defined(RTXX_USE_ALCHEMY)
+  std::size_t msg_size_;
+  RT_QUEUE q_;
+#endif
+};
+} // namespace detail
+
+/// Bounded message queue with per-message priority.
+/** All storage is allocated when the queue is created, sending and
+ *  receiving never allocate. Messages with a higher priority are received
+ *  first, messages of equal priority in FIFO order. Any number of tasks may
+ *  send and receive concurrently.
+ *
+ *  On Alchemy the queue is an \c RT_QUEUE, which only distinguishes
+ *  urgent (\c prio > 0, \c Q_URGENT) from normal messages.
+ *
+ * @par Example
+ * @code
+ *   rtxx::message_queue<command> q(64);
+ *
+ *   // producer, zero-copy
+ *   auto s = q.loan();
+ *   s->axis = 3;
+ *   s.commit(1);
+ *
+ *   // dispatcher
+ *   command c;
+ *   if (q.receive_for(c, 1ms))
+ *     dispatch(c);
+ * @endcode
+ */
+template <typename T> class message_queue : private detail::message_queue_base
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+                "message_queue only transports trivially copyable types");
+
+public:
+  using value_type = T;
+
+  /// A loaned slot, filled in place and then committed.
+  /** The slot is given back to the queue if it is destroyed without being
+   *  committed.
+   */
+  class slot
+  {
+  public:
+    slot() noexcept = default;
+
+    slot(slot &&other) noexcept
+        : q_(std::exchange(other.q_, nullptr)), p_(other.p_)
+    {
+    }
+
+    slot &operator=(slot &&other) noexcept
+    {
+      reset();
+      q_ = std::exchange(other.q_, nullptr);
+      p_ = other.p_;
+      return *this;
+    }
+
+    ~slot() { reset(); }
+
+    /// Checks if this object holds a slot
+    explicit operator bool() const noexcept { return q_ != nullptr; }
+
+    T *get() const noexcept { return p_; }
+    T *operator->() const noexcept { return p_; }
+    T &operator*() const noexcept { return *p_; }
+
+    /// Send the message with priority \c prio
+    void commit(int prio = 0)
+    {
+      q_->commit(p_, prio);
+      q_ = nullptr;
+    }
+
+  private:
+    friend class message_queue;
+
+    slot(message_queue *q, T *p) noexcept : q_(q), p_(p) {}
+
+    void reset() noexcept
+    {
+      if (q_)
+        q_->cancel(p_);
+      q_ = nullptr;
+    }
+
+    message_queue *q_{};
+    T *p_{};
+  };
+
+  /// Create a queue holding at most \c capacity messages
+  explicit message_queue(std::size_t capacity)
+      : message_queue_base(sizeof(T), capacity)
+  {
+  }
+
+  /// Loan a slot, blocks while the queue is full
+  slot loan();
+
+  /// Loan a slot, returns an empty slot if the queue is full
+  slot try_loan();
+
+  /// Send a message, blocks while the queue is full
+  void send(const T &msg, int prio = 0);
+
+  /// Send a message, fails if the queue is full
+  bool try_send(const T &msg, int prio = 0);
+
+  /// Receive the most urgent message, blocks while the queue is empty
+  void receive(T &msg);
+
+  /// Receive the most urgent message, fails if the queue is empty
+  bool try_receive(T &msg);
+
+  /// Receive the most urgent message, blocks at most \c rel_time
+  template <typename Rep, typename Period>
+  bool receive_for(T &msg, chrono::duration<Rep, Period> const &rel_time);
+
+  /// Receive the most urgent message, blocks at most until \c abs_time
+  /** The clock may be monotonic_clock, or realtime_clock on POSIX. */
+  template <typename Clock, typename Duration>
+  bool receive_until(T &msg, chrono::time_point<Clock, Duration> const &abs_time);
+
+  /// Receive the most urgent message, blocks at most until \c d
+  bool receive_until(T &msg, const deadline &d);
+
+private:
+  slot make_slot(void *p) noexcept;
+  bool receive(T &msg, const struct timespec *abs_timeout);
+};
+
+} // namespace rtxx
+
+#include <rtxx/impl/message_queue.tpp>
+
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/message_queue.ipp>
+#endif
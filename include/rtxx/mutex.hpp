@@ -1,9 +1,17 @@
 #pragma once
 
+#include <cstdint>
+#include <cstdio>
 #include <rtxx/clock.hpp>
 #include <rtxx/config.hpp>
+#include <rtxx/impl/name.hpp>
+#include <rtxx/impl/process_shared.hpp>
+#include <rtxx/latency_histogram.hpp>
+#include <vector>
 
-#if defined(RTXX_USE_POSIX)
+#if defined(RTXX_USE_SIM)
+#include <rtxx/impl/sim.hpp>
+#elif defined(RTXX_USE_POSIX)
 #include <pthread.h>
 #elif defined(RTXX_USE_ALCHEMY)
 #include <alchemy/mutex.h>
@@ -11,35 +19,161 @@
 
 namespace rtxx
 {
+namespace detail
+{
+struct mutex_stats;
+}
+
 /// The mutex class.
 /** @par Concepts
  *      @li TimedMutex
+ *
+ *  A mutex created with the \c profile option counts its acquisitions and
+ *  records how long tasks waited for it and held it. Profiled mutexes are
+ *  listed by mutex_profiler, ranked by the total time spent waiting.
+ *
+ * @par Example
+ * @code
+ *   rtxx::mutex m(rtxx::mutex::options{rtxx::priority_inherit(),
+ *                                      rtxx::adaptive_spin(200)});
+ *
+ *   rtxx::mutex joints(rtxx::mutex::options{rtxx::name("joints"),
+ *                                           rtxx::profile()});
+ *   // ...
+ *   rtxx::mutex_profiler::report(stdout);
+ * @endcode
  */
 class mutex
 {
 public:
+  /// Priority protocol of a mutex
+  enum class protocol_type
+  {
+    /// No priority boosting
+    none,
+
+    /// The owner inherits the priority of the highest waiter
+    /** \c PTHREAD_PRIO_INHERIT */
+    inherit,
+
+    /// The owner runs at the priority ceiling while holding the mutex
+    /** \c PTHREAD_PRIO_PROTECT */
+    protect,
+  };
+
+  /// Mutex options
+  struct options
+  {
+    /// The priority protocol.
+    /** Alchemy mutexes always use priority inheritance and do not support
+     *  \c protocol_type::protect.
+     */
+    protocol_type protocol{protocol_type::none};
+
+    /// The priority ceiling, used with \c protocol_type::protect.
+    int ceiling{0};
+
+    /// Keep the mutex usable when its owner dies while holding it.
+    /** The next owner is told through previous_owner_died(). Not supported
+     *  on Alchemy nor by the simulation.
+     */
+    bool robust{false};
+
+    /// Allow the mutex to be used by several processes.
+    /** The mutex must then be placed in shared memory, see shared_memory.
+     *  Not supported on Alchemy nor by the simulation.
+     */
+    bool process_shared{false};
+
+    /// Number of try-lock attempts made before blocking in lock().
+    /** Pays off when critical sections are shorter than a sleep and
+     *  wakeup, and the owner runs on another CPU.
+     */
+    unsigned spin_count{0};
+
+    /// Name shown in profiling reports, must outlive the mutex.
+    const char *name{};
+
+    /// Record acquisition statistics, see statistics().
+    /** Costs two clock reads per lock and unlock. Cannot be combined with
+     *  \c process_shared.
+     */
+    bool profile{false};
+
+    /// Construct options from convenient initializers
+    template <typename... Initializers>
+    constexpr explicit options(Initializers &&... init) noexcept;
+  };
+
   /// Deleted copy constructor
   mutex(const mutex &) = delete;
 
   /// Deleted copy assign operator
   mutex &operator=(const mutex &) = delete;
 
+  /// Acquisition statistics of a profiled mutex
+  struct stats
+  {
+    /// Name given in the options, or \c nullptr
+    const char *name;
+
+    /// Address of the mutex
+    const mutex *object;
+
+    /// Number of times the mutex was locked
+    std::uint64_t acquisitions;
+
+    /// Number of locks which found the mutex already held
+    std::uint64_t contended;
+
+    /// Number of timed locks which gave up
+    std::uint64_t timeouts;
+
+    /// Time spent waiting by contended locks which succeeded
+    latency_snapshot wait;
+
+    /// Time the mutex was held
+    latency_snapshot hold;
+
+    /// Longest time the mutex was held
+    chrono::nanoseconds longest_hold;
+
+    /// Name of the thread which held the mutex longest
+    char longest_holder[16];
+
+    /// Thread id of the thread which held the mutex longest
+    long longest_holder_tid;
+
+    /// Total time spent waiting, by which reports are ranked
+    [[nodiscard]] chrono::nanoseconds total_wait() const noexcept
+    {
+      return wait.mean() * static_cast<chrono::nanoseconds::rep>(wait.count());
+    }
+  };
+
   /// Create a mutex
   RTXX_DECL mutex();
 
+  /// Create a mutex
+  RTXX_DECL explicit mutex(const options &opt);
+
   /// Destroy a mutex
   RTXX_DECL ~mutex();
 
-  /// Lock a mutex
+  /// Lock a mutex, blocks at most \c duration
   RTXX_DECL bool try_lock_for(chrono::nanoseconds duration);
 
+  /// Lock a mutex, blocks at most until \c time_limit
+  RTXX_DECL bool try_lock_until(monotonic_clock::time_point time_limit);
+
 #if defined(RTXX_USE_POSIX)
-  /// Lock a mutex
+  /// Lock a mutex, blocks at most until \c time_limit
   RTXX_DECL bool try_lock_until(realtime_clock::time_point time_limit);
-#elif defined(RTXX_USE_ALCHEMY)
-  RTXX_DECL bool try_lock_until(monotonic_clock::time_point time_limit);
 #endif
 
+  /// Lock a mutex, blocks at most until \c d
+  RTXX_INLINE_DECL bool try_lock_until(const deadline &d);
+
   /// Lock a mutex
   RTXX_DECL bool try_lock();
 
@@ -49,7 +183,9 @@ public:
   /// Unlock a mutex
   RTXX_DECL void unlock();
 
-#if defined(RTXX_USE_POSIX)
+#if defined(RTXX_USE_SIM)
+  using native_handle_type = sim::detail::mutex_state *;
+#elif defined(RTXX_USE_POSIX)
   using native_handle_type = pthread_mutex_t *;
 #elif defined(RTXX_USE_ALCHEMY)
   using native_handle_type = RT_MUTEX *;
@@ -57,14 +193,81 @@ public:
 
   RTXX_INLINE_DECL native_handle_type native_handle();
 
+  /// Checks if the mutex was created with the \c profile option
+  [[nodiscard]] bool profiled() const noexcept { return stats_ != nullptr; }
+
+  /// Get the acquisition statistics of a profiled mutex
+  /** Values recorded meanwhile may be partially counted.
+   *  @throw system_error with errc::invalid_argument if the mutex is not
+   *  profiled.
+   */
+  [[nodiscard]] RTXX_DECL stats statistics() const;
+
+  /// Checks if the previous owner died while holding the mutex
+  /** Valid after the current owner acquired a robust mutex. The mutex has
+   *  been marked consistent again, but the data it protects may not be.
+   */
+  [[nodiscard]] RTXX_INLINE_DECL bool previous_owner_died() const noexcept;
+
 private:
-#if defined(RTXX_USE_POSIX)
+  /// Handle an error from a lock operation, returns true if locked.
+  RTXX_DECL bool lock_result(int err, const char *what);
+
+  /// Lock a mutex, blocks at most until \c abs_time on \c clock
+  RTXX_DECL bool clock_lock(clockid_t clock, const struct timespec *abs_time);
+
+  /// Try to lock without waiting, returns the error code.
+  RTXX_DECL int try_lock_native() noexcept;
+
+  /// Update the statistics after locking, \c start is when waiting began.
+  RTXX_DECL void profile_acquired(std::int64_t start, bool contended) noexcept;
+
+  /// Update the statistics before unlocking.
+  RTXX_DECL void profile_released() noexcept;
+
+  /// Restart the hold time after a condition variable wait.
+  RTXX_DECL void profile_reacquired() noexcept;
+
+  friend class condition_variable;
+
+#if defined(RTXX_USE_SIM)
+  sim::detail::mutex_state i_;
+#elif defined(RTXX_USE_POSIX)
   pthread_mutex_t i_;
 #elif defined(RTXX_USE_ALCHEMY)
   RT_MUTEX i_;
 #endif
+
+  unsigned spin_count_{0};
+  bool owner_died_{false};
+  detail::mutex_stats *stats_{};
 };
 
+/// Report of the profiled mutexes of the process
+namespace mutex_profiler
+{
+/// Get the statistics of every profiled mutex, most waited for first
+RTXX_DECL std::vector<mutex::stats> snapshot();
+
+/// Print the statistics of every profiled mutex, most waited for first
+RTXX_DECL void report(std::FILE *out);
+} // namespace mutex_profiler
+
+/// Returns an initializer for the priority inheritance mutex option.
+RTXX_INLINE_DECL constexpr auto priority_inherit();
+
+/// Returns an initializer for the priority ceiling mutex option.
+RTXX_INLINE_DECL constexpr auto priority_ceiling(int ceiling);
+
+/// Returns an initializer for the robust mutex option.
+RTXX_INLINE_DECL constexpr auto robust(bool enable = true);
+
+/// Returns an initializer for the adaptive spinning mutex option.
+RTXX_INLINE_DECL constexpr auto adaptive_spin(unsigned count);
+
+/// Returns an initializer for the profile mutex option.
+RTXX_INLINE_DECL constexpr auto profile(bool enable = true);
+
 } // namespace rtxx
 
 #include <rtxx/impl/mutex.hpp>
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <sys/epoll.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/error.hpp>
+#include <rtxx/inplace_function.hpp>
+#include <vector>
+
+#if defined(RTXX_USE_SIM)
+#error "rtxx::reactor is not supported by the simulation backend"
+#endif
+
+namespace rtxx
+{
+/// Waits on many file descriptors at once and dispatches their handlers.
+/** A reactor serves file descriptor readiness, periodic timers and
+ *  notifications from other tasks in a single wait, from the task calling
+ *  run(). Ready sources are dispatched in batches of up to \c batch_size.
+ *  It uses io_uring poll requests when the kernel supports them and falls
+ *  back on epoll otherwise. Sources are level-triggered: a handler is
+ *  called again as long as its descriptor stays ready.
+ *
+ *  Sources must be added and removed before run() or from a handler.
+ *  Only notify() and stop() may be called from other tasks. Under
+ *  Alchemy on Cobalt, waiting on Linux descriptors switches the task to
+ *  secondary mode.
+ *
+ * @par Example
+ * @code
+ *   rtxx::reactor r(rtxx::reactor::options{});
+ *   r.add_fd(sock, rtxx::reactor::readable, [&](std::uint64_t) { recv_frame(); });
+ *   r.add_timer(rtxx::monotonic_clock::now(), 1ms,
+ *               [&](std::uint64_t expirations) { send_cycle(); });
+ *   rtxx::task t(rtxx::task::options{rtxx::priority(70)}, [&] { r.run(); });
+ * @endcode
+ */
+class reactor
+{
+public:
+  /// Mechanism used to wait
+  enum class backend_type
+  {
+    epoll,
+    io_uring,
+  };
+
+  /// Handler of a source.
+  /** The argument is the ready event mask for descriptors, the number of
+   *  expirations for timers, and the number of notifications for
+   *  notifiers.
+   */
+  using handler_type = inplace_function<void(std::uint64_t)>;
+
+  /// Identifier of a source
+  using source_id = std::size_t;
+
+  /// The descriptor can be read
+  static constexpr std::uint32_t readable = 0x001;
+
+  /// The descriptor can be written
+  static constexpr std::uint32_t writable = 0x004;
+
+  /// An error is pending on the descriptor
+  static constexpr std::uint32_t error = 0x008;
+
+  /// The peer closed the connection
+  static constexpr std::uint32_t hangup = 0x010;
+
+  /// Reactor options
+  struct options
+  {
+    /// Maximum number of sources
+    std::size_t max_sources{64};
+
+    /// Maximum number of sources dispatched per wait
+    std::size_t batch_size{32};
+
+    /// Use io_uring if the kernel supports it
+    bool use_io_uring{true};
+
+    /// Construct options from convenient initializers
+    template <typename... Initializers>
+    constexpr explicit options(Initializers &&... init) noexcept;
+  };
+
+  /// Create a reactor
+  /** @throw system_error when error occurs. */
+  RTXX_DECL explicit reactor(const options &opt);
+
+  /// Deleted copy constructor
+  reactor(const reactor &) = delete;
+
+  /// Deleted copy assignment operator
+  reactor &operator=(const reactor &) = delete;
+
+  /// Close the reactor and the descriptors it created
+  RTXX_DECL ~reactor();
+
+  /// Call \c h when \c fd is ready for any of \c events
+  /** The descriptor is not owned by the reactor.
+   *  @throw system_error when error occurs.
+   */
+  RTXX_DECL source_id add_fd(int fd, std::uint32_t events, handler_type h);
+
+  /// Call \c h at \c start and then every \c period
+  /** A zero period makes a one-shot timer.
+   *  @throw system_error when error occurs.
+   */
+  RTXX_DECL source_id add_timer(monotonic_clock::time_point start,
+                                chrono::nanoseconds period, handler_type h);
+
+  /// Call \c h after notify() is called from any task
+  /** Notifications made before the handler runs are coalesced.
+   *  @throw system_error when error occurs.
+   */
+  RTXX_DECL source_id add_notifier(handler_type h);
+
+  /// Wake a notifier source, may be called from any task
+  RTXX_DECL void notify(source_id id);
+
+  /// Stop watching a source
+  RTXX_DECL void remove(source_id id);
+
+  /// Wait at most \c timeout and dispatch the ready sources
+  /** A negative timeout waits forever.
+   *  @returns the number of handlers called
+   */
+  RTXX_DECL std::size_t run_once(chrono::nanoseconds timeout);
+
+  /// Dispatch until stop() is called
+  RTXX_DECL void run();
+
+  /// Make run() return, may be called from any task
+  RTXX_DECL void stop() noexcept;
+
+  /// Get the mechanism used to wait
+  [[nodiscard]] backend_type backend() const noexcept { return backend_; }
+
+private:
+  enum class kind : unsigned char
+  {
+    none,
+    fd,
+    timer,
+    notifier,
+  };
+
+  struct source
+  {
+    int fd{-1};
+    std::uint32_t events{0};
+    std::uint32_t generation{0};
+    kind type{kind::none};
+    handler_type handler;
+  };
+
+  /// Ring of the io_uring backend.
+  struct uring
+  {
+    int fd{-1};
+    unsigned *sq_head{}, *sq_tail{}, *sq_mask{}, *sq_array{};
+    unsigned *cq_head{}, *cq_tail{}, *cq_mask{};
+    void *sqes{};
+    void *cqes{};
+    unsigned sq_entries{0};
+    void *ring{};
+    std::size_t ring_size{0};
+    std::size_t sqes_size{0};
+    unsigned to_submit{0};
+  };
+
+  RTXX_DECL bool setup_uring(unsigned entries) noexcept;
+  RTXX_DECL void close_uring() noexcept;
+  RTXX_DECL void uring_push(std::uint8_t op, int fd, std::uint32_t events,
+                            std::uint64_t addr, std::uint64_t data,
+                            error_code &ec) noexcept;
+  RTXX_DECL int uring_enter(unsigned min_complete,
+                            const struct timespec *timeout) noexcept;
+
+  RTXX_DECL source_id insert(int fd, std::uint32_t events, kind type,
+                             handler_type &h, const char *what);
+  RTXX_DECL void watch(source_id id, error_code &ec) noexcept;
+  RTXX_DECL bool dispatch(std::uint64_t data, std::uint32_t revents,
+                          bool rearm);
+
+  static std::uint64_t user_data(source_id id, std::uint32_t gen) noexcept
+  {
+    return (std::uint64_t(gen) << 32) | id;
+  }
+
+  backend_type backend_{backend_type::epoll};
+  int epfd_{-1};
+  uring ring_;
+  std::vector<source> sources_;
+  std::vector<struct epoll_event> events_;
+  std::size_t batch_size_;
+  source_id stop_id_{0};
+  bool stopping_{false};
+};
+
+/// Returns an initializer for the max_sources reactor option.
+RTXX_INLINE_DECL constexpr auto max_sources(std::size_t n);
+
+/// Returns an initializer for the batch_size reactor option.
+RTXX_INLINE_DECL constexpr auto batch_size(std::size_t n);
+
+/// Returns an initializer for the use_io_uring reactor option.
+RTXX_INLINE_DECL constexpr auto use_io_uring(bool enable = true);
+
+} // namespace rtxx
+
+#include <rtxx/impl/reactor.hpp>
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/reactor.ipp>
+#endif
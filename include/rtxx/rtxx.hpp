@@ -4,8 +4,35 @@
 #include <rtxx/clock.hpp>
 #include <rtxx/condition_variable.hpp>
 #include <rtxx/config.hpp>
+#include <rtxx/cpu_mask.hpp>
+#include <rtxx/cyclic_executor.hpp>
+#include <rtxx/inplace_function.hpp>
+#include <rtxx/latency_histogram.hpp>
+#include <rtxx/log.hpp>
+#include <rtxx/memory_resource.hpp>
+#include <rtxx/message_queue.hpp>
 #include <rtxx/mutex.hpp>
+#include <rtxx/runtime.hpp>
 #include <rtxx/semaphore.hpp>
+#include <rtxx/seqlock.hpp>
+#include <rtxx/shared_memory.hpp>
+#include <rtxx/spsc_queue.hpp>
 #include <rtxx/task.hpp>
+#include <rtxx/thread_pool.hpp>
+#include <rtxx/topology.hpp>
+#include <rtxx/trace.hpp>
+#include <rtxx/triple_buffer.hpp>
+
+// Synchronization built on host futexes and descriptors is left out of
+// the simulation, which cannot schedule it.
+#if defined(RTXX_USE_SIM)
+#include <rtxx/sim.hpp>
+#else
+#include <rtxx/barrier.hpp>
+#include <rtxx/event_flags.hpp>
+#include <rtxx/latch.hpp>
+#include <rtxx/reactor.hpp>
+#include <rtxx/shm_channel.hpp>
+#endif
 
 #endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <rtxx/config.hpp>
+#include <rtxx/error.hpp>
+
+namespace rtxx
+{
+/// Process-wide preparation for realtime operation
+/** Call runtime::init() once at startup, before creating realtime tasks,
+ *  so that first-touch page faults happen there instead of in the first
+ *  cycles of the tasks.
+ *
+ * @par Example
+ * @code
+ *   rtxx::runtime::init(rtxx::runtime::options{
+ *       rtxx::heap_reserve(64 << 20), rtxx::prefault_stacks()});
+ * @endcode
+ */
+namespace runtime
+{
+/// Runtime options
+struct options
+{
+  /// Lock current and future memory with \c mlockall().
+  bool lock_memory{true};
+
+  /// Never give heap memory back to the system.
+  /** Disables heap trimming, \c mmap() for large allocations and
+   *  per-thread malloc arenas, so that memory reserved up front stays
+   *  mapped and is shared by all tasks.
+   */
+  bool keep_heap{true};
+
+  /// Bytes of heap to allocate, touch and release at initialisation.
+  std::size_t heap_reserve{0};
+
+  /// Touch the stack of each task before its function runs.
+  /** The stack is also filled with a pattern, from which
+   *  task::stack_high_water() is computed when the task ends.
+   */
+  bool prefault_stacks{false};
+
+  /// Construct options from convenient initializers
+  template <typename... Initializers>
+  constexpr explicit options(Initializers &&... init) noexcept;
+};
+
+/// Prepare the process for realtime operation
+RTXX_DECL void init(const options &opt, error_code &ec);
+
+/// Prepare the process for realtime operation
+/** @throw system_error when error occurs. */
+RTXX_DECL void init(const options &opt);
+
+/// Get the options passed to the last successful init()
+/** Before init() is called, returns options with nothing enabled. */
+RTXX_DECL const options &current() noexcept;
+} // namespace runtime
+
+/// Returns an initializer for the lock_memory runtime option.
+RTXX_INLINE_DECL constexpr auto lock_memory(bool enable = true);
+
+/// Returns an initializer for the keep_heap runtime option.
+RTXX_INLINE_DECL constexpr auto keep_heap(bool enable = true);
+
+/// Returns an initializer for the heap_reserve runtime option.
+RTXX_INLINE_DECL constexpr auto heap_reserve(std::size_t bytes);
+
+/// Returns an initializer for the prefault_stacks runtime option.
+RTXX_INLINE_DECL constexpr auto prefault_stacks(bool enable = true);
+
+} // namespace rtxx
+
+#include <rtxx/impl/runtime.hpp>
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/runtime.ipp>
+#endif
@@ -2,8 +2,11 @@
 
 #include <rtxx/clock.hpp>
 #include <rtxx/config.hpp>
+#include <rtxx/impl/process_shared.hpp>
 
-#if defined(RTXX_USE_POSIX)
+#if defined(RTXX_USE_SIM)
+#include <rtxx/impl/sim.hpp>
+#elif defined(RTXX_USE_POSIX)
 #include <semaphore.h>
 #elif defined(RTXX_USE_ALCHEMY)
 #include <alchemy/sem.h>
@@ -16,9 +19,26 @@ class semaphore
 public:
   using value_type = unsigned;
 
+  /// Semaphore options
+  struct options
+  {
+    /// Allow the semaphore to be used by several processes.
+    /** The semaphore must then be placed in shared memory, see
+     *  shared_memory. Not supported on Alchemy nor by the simulation.
+     */
+    bool process_shared{false};
+
+    /// Construct options from convenient initializers
+    template <typename... Initializers>
+    constexpr explicit options(Initializers &&... init) noexcept;
+  };
+
   /// Create a semaphore
   RTXX_DECL explicit semaphore(value_type init_value);
 
+  /// Create a semaphore
+  RTXX_DECL semaphore(value_type init_value, const options &opt);
+
   /// Explicitly deleted copy constructor
   semaphore(const semaphore &other) = delete;
 
@@ -43,19 +63,42 @@ public:
   /// Lock the semaphore
   [[nodiscard]] RTXX_DECL bool try_wait();
 
+  /// Lock the semaphore, blocks at most \c rel_time
   template <typename Rep, typename Period>
   bool wait_for(chrono::duration<Rep, Period> const &rel_time);
 
+  /// Lock the semaphore, blocks at most until \c abs_time
+  /** The clock may be monotonic_clock, or realtime_clock on POSIX. */
   template <typename Clock, typename Duration>
   bool wait_until(chrono::time_point<Clock, Duration> const &abs_time);
 
+  /// Lock the semaphore, blocks at most until \c d
+  RTXX_INLINE_DECL bool wait_until(const deadline &d);
+
+  /// Lock the semaphore, blocks at most until \c abs_timeout
+  /** The timeout is on the CLOCK_REALTIME timeline on POSIX, as for
+   *  \c sem_timedwait(), and follows steps of the wall clock. Prefer the
+   *  overloads taking a deadline or a clock.
+   */
   RTXX_DECL bool wait_until(const struct timespec *abs_timeout);
 
+  /// Lock the semaphore, blocks at most until \c abs_timeout on \c clock
+  /** \c clock may be CLOCK_MONOTONIC, or CLOCK_REALTIME on POSIX. */
+  RTXX_INLINE_DECL bool wait_until(clockid_t clock,
+                                   const struct timespec *abs_timeout);
+
   /// Unlock the semaphore
   RTXX_DECL void post();
 
 private:
-#if defined(RTXX_USE_POSIX)
+  /// Lock the semaphore, blocks at most until \c abs_timeout on \c clock
+  RTXX_DECL bool clock_wait(clockid_t clock,
+                            const struct timespec *abs_timeout);
+
+#if defined(RTXX_USE_SIM)
+  sim::detail::semaphore_state sem_;
+
+#elif defined(RTXX_USE_POSIX)
   sem_t sem_;
 
 #elif defined(RTXX_USE_ALCHEMY)
@@ -63,30 +106,34 @@ private:
 #endif
 };
 
+template <typename... Initializers>
+constexpr semaphore::options::options(Initializers &&... init) noexcept
+{
+  (init(this), ...);
+}
+
 template <typename Rep, typename Period>
 bool semaphore::wait_for(chrono::duration<Rep, Period> const &rel_time)
 {
-#if defined(RTXX_USE_POSIX)
-  return wait_until(realtime_clock::now() + rel_time);
-#elif defined(RTXX_USE_ALCHEMY)
   return wait_until(monotonic_clock::now() + rel_time);
-#endif
 }
 
 template <typename Clock, typename Duration>
 bool semaphore::wait_until(chrono::time_point<Clock, Duration> const &abs_time)
 {
-#if defined(RTXX_USE_POSIX)
-  static_assert(std::is_same<Clock, realtime_clock>::value,
-                "currently only realtime clock is supported for posix");
-#endif
-
-#if defined(RTXX_USE_ALCHEMY)
-  static_assert(std::is_same<Clock, monotonic_clock>::value,
-                "currently only monotonic clock is supported for alchemy");
-#endif
   const auto ts = detail::duration_to_timespec(abs_time.time_since_epoch());
-  return wait_until(&ts);
+  return clock_wait(detail::wait_clockid<Clock>(), &ts);
+}
+
+inline bool semaphore::wait_until(const deadline &d)
+{
+  return clock_wait(CLOCK_MONOTONIC, d.as_timespec());
+}
+
+inline bool semaphore::wait_until(clockid_t clock,
+                                  const struct timespec *abs_timeout)
+{
+  return clock_wait(clock, abs_timeout);
 }
 
 } // namespace rtxx
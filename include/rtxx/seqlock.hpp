@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <rtxx/config.hpp>
+#include <type_traits>
+
+namespace rtxx
+{
+/// Latest-value cell with a wait-free writer and retrying readers.
+/** There may be only one writer, which never waits. Any number of
+ *  readers copy the value and retry if a write happened meanwhile, so a
+ *  slow reader never delays the writer. The value is copied word by word
+ *  through relaxed atomics, and the cell is kept on its own cache lines.
+ *
+ * @par Example
+ * @code
+ *   rtxx::seqlock<robot_state> state;
+ *
+ *   // 1 kHz control task
+ *   state.store(current);
+ *
+ *   // HMI task
+ *   const robot_state s = state.load();
+ * @endcode
+ */
+template <typename T> class alignas(RTXX_CACHELINE_SIZE) seqlock
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+                "seqlock only holds trivially copyable types");
+
+public:
+  using value_type = T;
+
+  /// Create a cell holding a value-initialized \c T
+  seqlock() noexcept;
+
+  /// Create a cell holding \c value
+  explicit seqlock(const T &value) noexcept;
+
+  /// Deleted copy constructor
+  seqlock(const seqlock &) = delete;
+
+  /// Deleted copy assignment operator
+  seqlock &operator=(const seqlock &) = delete;
+
+  /// Replace the value
+  /** Writer side only. */
+  void store(const T &value) noexcept;
+
+  /// Copy the value, retrying while a write is in progress
+  [[nodiscard]] T load() const noexcept;
+
+  /// Copy the value, fails if a write happened meanwhile
+  bool try_load(T &value) const noexcept;
+
+private:
+  using word = std::uintptr_t;
+  static constexpr std::size_t word_count =
+      (sizeof(T) + sizeof(word) - 1) / sizeof(word);
+
+  void copy_out(T &value) const noexcept;
+
+  /// Odd while a write is in progress.
+  std::atomic<std::uint64_t> seq_{0};
+  std::atomic<word> words_[word_count];
+};
+
+} // namespace rtxx
+
+#include <rtxx/impl/seqlock.tpp>
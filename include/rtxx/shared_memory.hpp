@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <rtxx/config.hpp>
+#include <rtxx/error.hpp>
+
+namespace rtxx
+{
+/// Named POSIX shared memory segment mapped into the process.
+/** The mapping is populated and locked when created, so that no page
+ *  fault happens when it is first touched by a realtime task. Objects
+ *  placed in it and used by several processes must be created with the
+ *  \c process_shared option.
+ *
+ * @par Example
+ * @code
+ *   // controller
+ *   rtxx::shared_memory shm("/robot", 4096, rtxx::shared_memory::mode::create);
+ *   auto m = new (shm.data()) rtxx::mutex(
+ *       rtxx::mutex::options{rtxx::process_shared(), rtxx::robust()});
+ *
+ *   // supervisor
+ *   rtxx::shared_memory shm("/robot", 4096, rtxx::shared_memory::mode::open);
+ *   auto m = static_cast<rtxx::mutex *>(shm.data());
+ * @endcode
+ */
+class shared_memory
+{
+public:
+  /// How to get the segment
+  enum class mode
+  {
+    /// Create the segment, fails if it exists
+    create,
+    /// Open an existing segment
+    open,
+    /// Open the segment, creating it if it does not exist
+    open_or_create,
+  };
+
+  /// Map a segment of \c size bytes
+  /** @throw system_error when error occurs. */
+  RTXX_DECL shared_memory(const char *name, std::size_t size, mode m);
+
+  /// Deleted copy constructor
+  shared_memory(const shared_memory &) = delete;
+
+  /// Deleted copy assignment operator
+  shared_memory &operator=(const shared_memory &) = delete;
+
+  /// Unmap the segment, it stays available to other processes
+  RTXX_DECL ~shared_memory();
+
+  /// Get the start of the mapping
+  [[nodiscard]] void *data() const noexcept { return data_; }
+
+  /// Get the size of the mapping
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+  /// Checks if this object created the segment
+  [[nodiscard]] bool created() const noexcept { return created_; }
+
+  /// Remove a segment name, mappings stay valid until unmapped
+  RTXX_DECL static void remove(const char *name, error_code &ec) noexcept;
+
+  /// Remove a segment name, mappings stay valid until unmapped
+  /** @throw system_error when error occurs. */
+  RTXX_DECL static void remove(const char *name);
+
+private:
+  void *data_{};
+  std::size_t size_{0};
+  bool created_{false};
+};
+
+} // namespace rtxx
+
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/shared_memory.ipp>
+#endif
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/shared_memory.hpp>
+#include <type_traits>
+
+#if defined(RTXX_USE_SIM)
+#error "rtxx::shm_channel is not supported by the simulation backend"
+#endif
+
+namespace rtxx
+{
+/// Single-producer single-consumer message channel between processes.
+/** The ring lives in a named shared memory segment: one process creates
+ *  the channel, the other opens it with the same type and capacity. The
+ *  producer never blocks nor enters the kernel, except to wake a consumer
+ *  which announced that it is going to sleep. The consumer may poll or
+ *  block on a process-shared futex.
+ *
+ *  Messages may be written in place with try_loan() and commit(), and read
+ *  in place with try_peek() and release(), so that no copy is made.
+ *
+ * @par Example
+ * @code
+ *   // controller process
+ *   rtxx::shm_channel<sample> ch("/samples", 256,
+ *                                rtxx::shared_memory::mode::create);
+ *   if (auto s = ch.try_loan())
+ *   {
+ *     s->position = read_encoder();
+ *     ch.commit();
+ *   }
+ *
+ *   // logger process
+ *   rtxx::shm_channel<sample> ch("/samples", 256,
+ *                                rtxx::shared_memory::mode::open);
+ *   sample s;
+ *   if (ch.receive_for(s, 10ms))
+ *     log(s);
+ * @endcode
+ */
+template <typename T> class shm_channel
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+                "shm_channel only transports trivially copyable types");
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+                    std::atomic<std::uint32_t>::is_always_lock_free,
+                "shm_channel needs address-free atomics");
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  /// Create or open the channel \c name holding \c capacity messages
+  /** \c capacity must be a power of two. Opening a channel created with a
+   *  different capacity or message size fails.
+   *  @throw system_error when error occurs.
+   */
+  shm_channel(const char *name, size_type capacity, shared_memory::mode m);
+
+  /// Deleted copy constructor
+  shm_channel(const shm_channel &) = delete;
+
+  /// Deleted copy assignment operator
+  shm_channel &operator=(const shm_channel &) = delete;
+
+  /// Get a free slot to fill in place, \c nullptr if the channel is full
+  /** Producer side only. */
+  T *try_loan() noexcept;
+
+  /// Publish the slot returned by the last try_loan()
+  /** Producer side only. */
+  void commit() noexcept;
+
+  /// Send a message, fails if the channel is full
+  /** Producer side only. */
+  bool try_send(const T &msg) noexcept;
+
+  /// Get the oldest message in place, \c nullptr if the channel is empty
+  /** Consumer side only. */
+  const T *try_peek() noexcept;
+
+  /// Give back the slot returned by the last try_peek()
+  /** Consumer side only. */
+  void release() noexcept;
+
+  /// Receive a message, fails if the channel is empty
+  /** Consumer side only. */
+  bool try_receive(T &msg) noexcept;
+
+  /// Receive a message, blocks while the channel is empty
+  /** Consumer side only. */
+  void receive(T &msg) noexcept;
+
+  /// Receive a message, blocks at most \c rel_time
+  /** Consumer side only. */
+  template <typename Rep, typename Period>
+  bool receive_for(T &msg, chrono::duration<Rep, Period> const &rel_time);
+
+  /// Get the capacity of the channel
+  [[nodiscard]] size_type capacity() const noexcept { return mask_ + 1; }
+
+  /// Get the underlying segment
+  [[nodiscard]] const shared_memory &segment() const noexcept { return shm_; }
+
+private:
+  /// Layout of the start of the segment, followed by the slots.
+  struct header
+  {
+    std::atomic<std::uint64_t> magic;
+    std::uint64_t capacity;
+    std::uint64_t msg_size;
+
+    /// Index of the next message to receive, written by the consumer only.
+    alignas(RTXX_CACHELINE_SIZE) std::atomic<std::uint64_t> head;
+    /// Futex word, 1 while the consumer is about to sleep or sleeping.
+    std::atomic<std::uint32_t> waiting;
+
+    /// Index of the next free slot, written by the producer only.
+    alignas(RTXX_CACHELINE_SIZE) std::atomic<std::uint64_t> tail;
+  };
+
+  static constexpr std::uint64_t magic_value = 0x7274787863686e31; // rtxxchn1
+
+  static constexpr size_type slots_offset()
+  {
+    return (sizeof(header) + alignof(T) - 1) / alignof(T) * alignof(T);
+  }
+
+  T *slot(std::uint64_t i) const noexcept
+  {
+    return reinterpret_cast<T *>(static_cast<unsigned char *>(shm_.data()) +
+                                 slots_offset()) +
+           (i & mask_);
+  }
+
+  header *hdr() const noexcept { return static_cast<header *>(shm_.data()); }
+
+  /// Block until a message is available or \c timeout expires.
+  bool wait(const struct timespec *timeout) noexcept;
+
+  shared_memory shm_;
+  size_type mask_;
+};
+
+} // namespace rtxx
+
+#include <rtxx/impl/shm_channel.tpp>
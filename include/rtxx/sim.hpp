@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+
+#if !defined(RTXX_USE_SIM)
+#error "rtxx/sim.hpp requires the simulation backend, define RTXX_USE_SIM"
+#endif
+
+#include <rtxx/impl/sim.hpp>
+
+namespace rtxx
+{
+/// Control of the simulation backend
+/** With \c RTXX_USE_SIM defined, tasks still run on threads of the host,
+ *  but only one at a time, chosen by a deterministic scheduler: the ready
+ *  task of highest priority runs, first come first served among equal
+ *  priorities, until it blocks, yields or is preempted. monotonic_clock
+ *  and realtime_clock read a virtual time which starts at zero and only
+ *  moves when every task is blocked, jumping to the next timeout, or when
+ *  the running task calls consume(). An hour of periodic schedule thus
+ *  runs as fast as the tasks compute, and every run takes the same
+ *  decisions.
+ *
+ *  task periods and sleeps, mutex (with priority inheritance and
+ *  ceiling), semaphore, condition_variable and the types built on them
+ *  are simulated. barrier, latch, event_flags, reactor and shm_channel are
+ *  not. \c SCHED_DEADLINE, budgets and process-shared objects fail with
+ *  \c ENOTSUP. Every task runs on the one virtual CPU: task::options
+ *  affinity and cpu_set are accepted and ignored. Threads calling the
+ *  library without being tasks, such as \c main(), join the simulation at
+ *  priority zero.
+ *
+ *  The simulation is cooperative: code between two calls to the library
+ *  takes no virtual time, and a task which busy-waits or blocks in the
+ *  host, in \c std::this_thread::sleep_for() or \c std::mutex for
+ *  instance, stops the simulation. When every task is blocked without a
+ *  timeout, the process aborts. The backend is header-only.
+ *
+ * @par Example
+ * @code
+ *   #define RTXX_USE_SIM
+ *   #include <rtxx/rtxx.hpp>
+ *
+ *   rtxx::task control(rtxx::task::options{rtxx::priority(80)}, [] {
+ *     rtxx::this_task::set_periodic(rtxx::monotonic_clock::now(), 1ms);
+ *     for (int i = 0; i != 3'600'000; ++i)
+ *     {
+ *       rtxx::sim::consume(200us);  // a cycle of the control law
+ *       rtxx::this_task::wait_period();
+ *     }
+ *   });
+ *   control.join();  // an hour later on the virtual clock
+ * @endcode
+ */
+namespace sim
+{
+/// Spend \c cpu of virtual time computing in the calling task
+/** The task may be preempted meanwhile by a task of higher priority whose
+ *  timeout falls within \c cpu.
+ */
+RTXX_DECL void consume(chrono::nanoseconds cpu);
+
+/// Block the calling task until \c abs_time on the virtual clock
+RTXX_DECL void sleep_until(monotonic_clock::time_point abs_time);
+
+/// Block the calling task for \c rel_time of virtual time
+template <typename Rep, typename Period>
+void sleep_for(chrono::duration<Rep, Period> const &rel_time);
+
+/// Get the number of context switches made by the scheduler
+[[nodiscard]] RTXX_DECL std::uint64_t context_switches() noexcept;
+
+template <typename Rep, typename Period>
+void sleep_for(chrono::duration<Rep, Period> const &rel_time)
+{
+  sleep_until(monotonic_clock::now() +
+              chrono::duration_cast<monotonic_clock::duration>(rel_time));
+}
+} // namespace sim
+} // namespace rtxx
+
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/sim.ipp>
+#endif
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/semaphore.hpp>
+#include <type_traits>
+
+namespace rtxx
+{
+/// Wait-free single-producer single-consumer ring buffer.
+/** The queue holds at most \c N elements, \c N must be a power of two.
+ *  Exactly one task may push and exactly one task may pop at a time.
+ *  No operation allocates, locks or enters the kernel.
+ *
+ * @par Example
+ * @code
+ *   rtxx::spsc_queue<sample, 1024> q;
+ *
+ *   // periodic task
+ *   if (!q.try_push(s))
+ *     ++dropped;
+ *
+ *   // logger task
+ *   sample buf[64];
+ *   auto n = q.try_pop_n(buf, 64);
+ * @endcode
+ */
+template <typename T, std::size_t N> class spsc_queue
+{
+  static_assert(N >= 2 && (N & (N - 1)) == 0,
+                "spsc_queue capacity must be a power of two");
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  /// Create an empty queue
+  spsc_queue() noexcept = default;
+
+  /// Deleted copy constructor
+  spsc_queue(const spsc_queue &) = delete;
+
+  /// Deleted copy assignment operator
+  spsc_queue &operator=(const spsc_queue &) = delete;
+
+  /// Destroy the queue and the elements left in it
+  ~spsc_queue();
+
+  /// Push an element, fails if the queue is full
+  /** Producer side only. */
+  bool try_push(const T &value);
+
+  /// Push an element, fails if the queue is full
+  /** Producer side only. */
+  bool try_push(T &&value);
+
+  /// Construct an element in place, fails if the queue is full
+  /** Producer side only. */
+  template <typename... Args> bool try_emplace(Args &&... args);
+
+  /// Push up to \c n elements copied from \c first
+  /** Producer side only.
+   *  @returns the number of elements pushed
+   */
+  size_type try_push_n(const T *first, size_type n);
+
+  /// Pop an element, fails if the queue is empty
+  /** Consumer side only. */
+  bool try_pop(T &value);
+
+  /// Pop up to \c n elements into \c out
+  /** Consumer side only.
+   *  @returns the number of elements popped
+   */
+  size_type try_pop_n(T *out, size_type n);
+
+  /// Checks if the queue is empty
+  /** The result is exact only when called from the consumer side. */
+  [[nodiscard]] bool empty() const noexcept;
+
+  /// Get the number of elements in the queue
+  /** The result is approximate when both sides are active. */
+  [[nodiscard]] size_type size() const noexcept;
+
+  /// Get the capacity of the queue
+  static constexpr size_type capacity() noexcept { return N; }
+
+private:
+  static constexpr size_type mask = N - 1;
+
+  T *slot(size_type i) noexcept
+  {
+    return std::launder(reinterpret_cast<T *>(&buf_[i & mask]));
+  }
+
+  /// Number of free slots, refreshing the cached head if fewer than wanted.
+  size_type free_slots(size_type wanted) noexcept;
+
+  /// Number of used slots, refreshing the cached tail if fewer than wanted.
+  size_type used_slots(size_type wanted) noexcept;
+
+  /// Index of the next element to pop, written by the consumer only.
+  alignas(RTXX_CACHELINE_SIZE) std::atomic<size_type> head_{0};
+  /// Consumer's last observed value of \c tail_.
+  size_type tail_cache_{0};
+
+  /// Index of the next free slot, written by the producer only.
+  alignas(RTXX_CACHELINE_SIZE) std::atomic<size_type> tail_{0};
+  /// Producer's last observed value of \c head_.
+  size_type head_cache_{0};
+
+  alignas(RTXX_CACHELINE_SIZE)
+      std::aligned_storage_t<sizeof(T), alignof(T)> buf_[N];
+};
+
+/// SPSC queue whose consumer may block until data arrives.
+/** The producer side stays wait-free: it only posts the semaphore when the
+ *  consumer has announced that it is going to sleep.
+ */
+template <typename T, std::size_t N>
+class blocking_spsc_queue : public spsc_queue<T, N>
+{
+  using base = spsc_queue<T, N>;
+
+public:
+  using typename base::size_type;
+  using typename base::value_type;
+
+  /// Create an empty queue
+  blocking_spsc_queue() : sem_(0) {}
+
+  /// Push an element and wake the consumer if it is sleeping
+  bool try_push(const T &value);
+
+  /// Push an element and wake the consumer if it is sleeping
+  bool try_push(T &&value);
+
+  /// Construct an element in place and wake the consumer if it is sleeping
+  template <typename... Args> bool try_emplace(Args &&... args);
+
+  /// Push up to \c n elements and wake the consumer if it is sleeping
+  size_type try_push_n(const T *first, size_type n);
+
+  /// Pop an element, blocks while the queue is empty
+  void pop(T &value);
+
+  /// Pop between 1 and \c n elements, blocks while the queue is empty
+  size_type pop_n(T *out, size_type n);
+
+  /// Pop an element, blocks at most \c rel_time
+  template <typename Rep, typename Period>
+  bool pop_for(T &value, chrono::duration<Rep, Period> const &rel_time);
+
+  /// Pop an element, blocks at most until \c abs_time
+  template <typename Clock, typename Duration>
+  bool pop_until(T &value, chrono::time_point<Clock, Duration> const &abs_time);
+
+  /// Pop an element, blocks at most until \c d
+  bool pop_until(T &value, const deadline &d);
+
+private:
+  void notify();
+  template <typename Wait> bool wait_nonempty(Wait &&wait);
+
+  alignas(RTXX_CACHELINE_SIZE) std::atomic<bool> waiting_{false};
+  semaphore sem_;
+};
+
+} // namespace rtxx
+
+#include <rtxx/impl/spsc_queue.tpp>
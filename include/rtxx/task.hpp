@@ -1,19 +1,36 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
-#include <functional>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <rtxx/clock.hpp>
 #include <rtxx/config.hpp>
+#include <rtxx/cpu_mask.hpp>
 #include <rtxx/error.hpp>
+#include <rtxx/impl/name.hpp>
+#include <rtxx/inplace_function.hpp>
+#include <rtxx/latency_histogram.hpp>
+#include <rtxx/memory_resource.hpp>
+
+#if defined(RTXX_USE_SIM)
+#include <rtxx/impl/sim.hpp>
+#endif
 
 #if defined(RTXX_USE_POSIX)
 #include <pthread.h>
 #include <sched.h>
+#include <signal.h>
+#include <time.h>
 #elif defined(RTXX_USE_ALCHEMY)
 #include <alchemy/task.h>
 #endif
 
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
 namespace rtxx
 {
 class task;
@@ -48,8 +65,56 @@ RTXX_DECL void yield(error_code &ec);
 /// Yield the processor
 RTXX_DECL void yield();
 
+/// Get the memory resource of the current task
+/** Returns task::options::memory_resource, or the default resource if
+ *  none was given or the caller is not a task.
+ */
+RTXX_DECL std::pmr::memory_resource *memory_resource() noexcept;
+
+/// End the warm-up of the current task
+/** Arms the allocation guard selected by task::options::alloc_guard. This
+ *  also happens on the first call to wait_period().
+ */
+RTXX_DECL void end_warmup() noexcept;
+
 } // namespace this_task
 
+/// What a periodic task does after missing releases
+enum class overrun_policy
+{
+  /// Drop the missed releases and wait for the next one on the timeline.
+  /** wait_period() returns the number of releases dropped. */
+  skip,
+
+  /// Run once for every missed release, back to back.
+  /** wait_period() returns 0 and does not block until the task is back
+   *  on the timeline.
+   */
+  catch_up,
+
+  /// Restart the timeline one period after the late wakeup.
+  /** wait_period() returns the number of releases missed. The phase of
+   *  the task shifts by the overrun.
+   */
+  stretch,
+};
+
+/// Outcome of an admission test for \c SCHED_DEADLINE tasks
+struct deadline_admission
+{
+  /// Checks if every task is valid and the set fits the capacity
+  bool admitted;
+
+  /// Sum of runtime / period over the tasks
+  double utilization;
+
+  /// Bandwidth available to deadline tasks, in CPUs
+  /** The number of online CPUs times the share allowed by
+   *  \c /proc/sys/kernel/sched_rt_runtime_us.
+   */
+  double capacity;
+};
+
 /// Realtime task class
 /** @par Example
  * @code
@@ -93,6 +158,13 @@ public:
      */
     int stack_size{0};
 
+    /// Caller-provided stack memory of \c stack_size bytes.
+    /** When set, no stack is allocated for the task. The memory must be
+     *  suitably aligned, at least \c PTHREAD_STACK_MIN bytes long and
+     *  outlive the task. Not supported on Alchemy.
+     */
+    void *stack{};
+
     /// The priority of the new task.
     /** When set to zero, the task will be non-realtime.
      *  If the value is between 1 and 99, the task will be realtime.
@@ -100,16 +172,75 @@ public:
     int priority{0};
 
     /// CPU affinity of the new task
+    /** Takes precedence over \c cpu_set when not empty. */
+    cpu_mask affinity{};
+
+    /// CPU affinity of the new task, owned by the caller
     const cpu_set_t *cpu_set{};
 
     /// Schedule policy of the new.
-    /** This is effective only if the priority > 0.
+    /** This is effective only if the priority > 0, or if it is
+     *  \c SCHED_DEADLINE.
      */
     int schedpolicy{SCHED_FIFO};
 
+    /// CPU time reserved in each period, with \c SCHED_DEADLINE.
+    chrono::nanoseconds sched_runtime{0};
+
+    /// Deadline relative to the start of each period, with
+    /// \c SCHED_DEADLINE.
+    chrono::nanoseconds sched_deadline{0};
+
+    /// Period of the reservation, with \c SCHED_DEADLINE.
+    /** A deadline task which does not call set_periodic() is released
+     *  at the start of each period: wait_period() gives up the remaining
+     *  runtime with \c sched_yield().
+     */
+    chrono::nanoseconds sched_period{0};
+
     /// Automatically join the thread when destructed
     bool auto_join{false};
 
+    /// Record the wakeup latency of each periodic release.
+    /** The latency is the time between the scheduled release point and
+     *  the return of wait_period(). It is kept in a latency_histogram
+     *  allocated when the task is created.
+     */
+    bool record_latency{false};
+
+    /// What wait_period() does after missed releases
+    /** Must be overrun_policy::skip with \c SCHED_DEADLINE, the task
+     *  cannot be created otherwise.
+     */
+    overrun_policy overrun{overrun_policy::skip};
+
+    /// Called by wait_period() in the task when releases were missed.
+    /** Receives the task and the number of releases missed. */
+    void (*deadline_miss)(task &, unsigned missed){};
+
+    /// CPU time allowed to the task in each period, or zero.
+    /** Measured on the thread CPU clock from the return of wait_period()
+     *  to the next call. Cycles over budget are counted, see
+     *  budget_overruns(). Not supported on Alchemy.
+     */
+    chrono::nanoseconds budget{0};
+
+    /// Called as soon as a cycle exhausts its budget.
+    /** Runs in a signal handler on the task, so it must be
+     *  async-signal-safe. The signal is \c RTXX_BUDGET_SIGNAL. CPU timers
+     *  are checked at scheduler ticks: a cycle which ends less than a tick
+     *  after its budget is counted without this being called.
+     */
+    void (*budget_exceeded)(task &){};
+
+    /// Memory resource of the task, see this_task::memory_resource().
+    /** Ownership is not transferred, the resource must outlive the task. */
+    std::pmr::memory_resource *memory_resource{};
+
+    /// What to do on a heap allocation after the warm-up of the task.
+    /** Only effective in programs which include <rtxx/alloc_guard.hpp>. */
+    alloc_guard_mode alloc_guard{alloc_guard_mode::off};
+
     /// Construct options from convenient initializers
     /** GCC 7.* does not support non-trivial designated initializers,
      *  so I provide this way to initialize options.
@@ -126,6 +257,12 @@ public:
   using native_handle_type = RT_TASK *;
 #endif
 
+  /// Function object run by a task, stored inside the task object.
+  /** Function objects larger than \c RTXX_INPLACE_FUNCTION_CAPACITY
+   *  bytes are rejected at compile time.
+   */
+  using function_type = inplace_function<void()>;
+
   /// Deleted copy constructor
   task(task const &) = delete;
 
@@ -182,6 +319,33 @@ public:
   /// Get the native handle to the task.
   RTXX_DECL native_handle_type native_handle();
 
+  /// Get the wakeup latencies recorded so far
+  /** May be called from any task while this task is running. Returns an
+   *  empty snapshot unless options::record_latency is set.
+   */
+  [[nodiscard]] RTXX_DECL latency_snapshot wakeup_latency() const;
+
+  /// Get the total number of releases missed by wait_period()
+  [[nodiscard]] RTXX_DECL unsigned long overruns() const noexcept;
+
+  /// Get the number of cycles which used more than their CPU budget
+  [[nodiscard]] RTXX_DECL unsigned long budget_overruns() const noexcept;
+
+  /// Get the largest CPU time used by a cycle
+  /** Only measured when options::budget is set. */
+  [[nodiscard]] RTXX_DECL chrono::nanoseconds
+  max_execution_time() const noexcept;
+
+  /// Get the deepest stack usage of the task, in bytes
+  /** Valid after join(). Returns zero unless stacks were prefaulted, see
+   *  runtime::options::prefault_stacks.
+   */
+  [[nodiscard]] RTXX_DECL std::size_t stack_high_water() const noexcept;
+
+  /// Get the number of heap allocations made after the warm-up
+  /** Counted when options::alloc_guard is alloc_guard_mode::count. */
+  [[nodiscard]] RTXX_DECL unsigned long heap_allocations() const noexcept;
+
 private:
   task() noexcept = default;
 
@@ -199,6 +363,34 @@ private:
   /** This can only be called from the current task. */
   RTXX_DECL unsigned wait_period(error_code &ec);
 
+  /// Account for a wakeup after \c overrun missed releases.
+  RTXX_DECL void record_wakeup(unsigned overrun) noexcept;
+
+  /// Apply the overrun policy after a wakeup, returns what wait_period()
+  /// returns.
+  RTXX_DECL unsigned handle_wakeup(unsigned missed, error_code &ec);
+
+  /// Move the timeline to one period after now.
+  RTXX_DECL void restart_period(error_code &ec);
+
+  /// Create the budget timer, from the task itself.
+  RTXX_DECL int start_budget() noexcept;
+
+  /// Measure the CPU time of the cycle ending.
+  RTXX_DECL void end_cycle() noexcept;
+
+  /// Arm the budget timer for the cycle starting.
+  RTXX_DECL void begin_cycle() noexcept;
+
+#if defined(RTXX_USE_POSIX)
+  /// Handler of RTXX_BUDGET_SIGNAL.
+  RTXX_DECL static void budget_signal(int sig, siginfo_t *info,
+                                      void *) noexcept;
+#endif
+
+  /// Wait for the next period of a deadline task without a timer.
+  RTXX_DECL unsigned yield_period(error_code &ec);
+
 #if defined(RTXX_USE_POSIX)
   pthread_t h_{};
 #elif defined(RTXX_USE_ALCHEMY)
@@ -207,38 +399,148 @@ private:
 #endif
 
 #if defined(RTXX_USE_POSIX)
+  /// Name set by the task itself before running the user function.
+  const char *name_{};
+
   /// The timer will be used if \c set_periodic() is called.
   int tfd_{-1};
   clockid_t clk_{};
 #endif
 
-  unsigned long flags_;
+#if defined(RTXX_USE_SIM)
+  /// State of the task in the simulation, freed by join().
+  sim::detail::thread *sim_{};
+#endif
+
+  unsigned long flags_{};
+
+  /// Reservation applied by the task itself before running the user
+  /// function, when the policy is SCHED_DEADLINE.
+  chrono::nanoseconds::rep dl_runtime_{0};
+  chrono::nanoseconds::rep dl_deadline_{0};
+  chrono::nanoseconds::rep dl_period_{0};
+
+  /// Overrun handling, from options.
+  overrun_policy policy_{overrun_policy::skip};
+  void (*deadline_miss_)(task &, unsigned){};
+
+  /// Releases still to run back to back, with overrun_policy::catch_up.
+  unsigned pending_{0};
+
+  /// Execution budget, from options.
+  chrono::nanoseconds::rep budget_{0};
+  void (*budget_exceeded_)(task &){};
+
+#if defined(RTXX_USE_POSIX)
+  /// Timer on the thread CPU clock, valid when budget_ is set.
+  timer_t budget_timer_{};
+  clockid_t cpu_clk_{};
+#endif
+
+  /// CPU time at the start of the current cycle, or -1 before the first.
+  chrono::nanoseconds::rep cycle_start_{-1};
+
+  /// Cycles over budget and longest cycle, written by this task only.
+  std::atomic<unsigned long> budget_overruns_{0};
+  std::atomic<chrono::nanoseconds::rep> max_exec_time_{0};
+
+  /// Set once the task applied its reservation and created its budget
+  /// timer, with their error in start_error_.
+  std::atomic<std::uint32_t> started_{0};
+  int start_error_{0};
+
+  /// Next scheduled release point and period, in nanoseconds.
+  chrono::nanoseconds::rep release_{};
+  chrono::nanoseconds::rep period_{};
+
+  /// Overruns returned by wait_period(), written by this task only.
+  std::atomic<unsigned long> overruns_{0};
+
+  /// Wakeup latencies, if options::record_latency is set.
+  std::unique_ptr<latency_histogram> latency_;
+
+  /// Deepest stack usage, written by the task before it ends.
+  std::size_t stack_high_water_{0};
+
+  std::pmr::memory_resource *resource_{};
+  alloc_guard_mode alloc_guard_{alloc_guard_mode::off};
+
+  /// Heap allocations after the warm-up, written by this task only.
+  std::atomic<unsigned long> heap_allocations_{0};
 
   /// Type-erased task routine.
-  std::function<void()> fn_;
+  function_type fn_;
 
   friend unsigned this_task::wait_period();
   friend unsigned this_task::wait_period(error_code &ec);
+  friend std::pmr::memory_resource *this_task::memory_resource() noexcept;
 };
 
+/// Check whether a set of \c SCHED_DEADLINE tasks can be admitted
+/** Each task must satisfy runtime <= deadline <= period, and the sum of
+ *  runtime / period must not exceed the capacity. Like the kernel, this
+ *  is a global bandwidth test: it does not guarantee that deadlines are
+ *  met on several CPUs, and deadline tasks already running are not
+ *  accounted for. Options whose policy is not \c SCHED_DEADLINE are
+ *  ignored.
+ */
+RTXX_DECL deadline_admission
+check_deadline_admission(const task::options *tasks, std::size_t count);
+
 /// Returns an initializer for priority task option.
 RTXX_INLINE_DECL constexpr auto priority(int value);
 
-/// Returns an initializer for name task option.
-RTXX_INLINE_DECL constexpr auto name(const char *name);
-
 /// Returns an initializer for stack size task option.
 RTXX_INLINE_DECL constexpr auto stack_size(int size);
 
+/// Returns an initializer for the stack and stack size task options.
+/** Ownership of the memory is not transferred after calling this
+ *  function.
+ */
+RTXX_INLINE_DECL constexpr auto stack(void *base, int size);
+
+/// Returns an initializer for the SCHED_DEADLINE task options.
+/** Sets the policy to \c SCHED_DEADLINE with the given reservation. The
+ *  deadline defaults to the period.
+ */
+RTXX_INLINE_DECL constexpr auto
+deadline_scheduling(chrono::nanoseconds runtime, chrono::nanoseconds period,
+                    chrono::nanoseconds deadline = chrono::nanoseconds(0));
+
 /// Returns an initializer for cpu_set task option.
 /** Ownership of the cpu_set_t object is not transferred after
- *  calling this function.
+ *  calling this function. Also applies to other options structures with
+ *  a \c cpu_set field.
  */
 RTXX_INLINE_DECL constexpr auto cpu_set(const cpu_set_t *set);
 
 /// Returns an initializer for schedpolicy task option
 RTXX_INLINE_DECL constexpr auto schedpolicy(int sched);
 
+/// Returns an initializer for record_latency task option
+RTXX_INLINE_DECL constexpr auto record_latency(bool enable = true);
+
+/// Returns an initializer for overrun task option
+RTXX_INLINE_DECL constexpr auto on_overrun(overrun_policy policy);
+
+/// Returns an initializer for deadline_miss task option
+RTXX_INLINE_DECL constexpr auto on_deadline_miss(void (*fn)(task &, unsigned));
+
+/// Returns an initializer for the budget and budget_exceeded task options
+RTXX_INLINE_DECL constexpr auto
+execution_budget(chrono::nanoseconds budget,
+                 void (*exceeded)(task &) = nullptr);
+
+/// Returns an initializer for memory_resource task option
+/** Ownership of the resource is not transferred after calling this
+ *  function.
+ */
+RTXX_INLINE_DECL constexpr auto
+memory_resource(std::pmr::memory_resource *resource);
+
+/// Returns an initializer for alloc_guard task option
+RTXX_INLINE_DECL constexpr auto alloc_guard(alloc_guard_mode mode);
+
 } // namespace rtxx
 
 #include <rtxx/impl/task.hpp>
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/inplace_function.hpp>
+#include <rtxx/mutex.hpp>
+#include <rtxx/semaphore.hpp>
+#include <rtxx/task.hpp>
+#include <vector>
+
+namespace rtxx
+{
+/// Prestarted workers pinned one per core, in two priority lanes.
+/** Every selected core runs a critical worker and a background worker.
+ *  Critical workers run at a higher realtime priority, so that a
+ *  background job is preempted as soon as critical work arrives on its
+ *  core. Each worker has its own bounded queue, idle workers steal from
+ *  the other queues of their lane. Jobs are stored without allocation.
+ *
+ * @par Example
+ * @code
+ *   rtxx::thread_pool pool(rtxx::thread_pool::options{
+ *       rtxx::critical_priority(80), rtxx::background_priority(10)});
+ *
+ *   // in the control cycle
+ *   const bool done = pool.parallel_for(0, axes, 1, [&](std::size_t i) {
+ *     solve_kinematics(i);
+ *   }, release + 500us);
+ * @endcode
+ */
+class thread_pool
+{
+public:
+  /// Priority lane of a job
+  enum class lane
+  {
+    /// Run by the critical workers
+    critical,
+    /// Run by the background workers, never ahead of critical jobs
+    background,
+  };
+
+  /// Job stored in a worker queue
+  using job_type = inplace_function<void()>;
+
+  /// Pool options
+  struct options
+  {
+    /// Prefix of the worker names
+    const char *name{"rtxx_pool"};
+
+    /// Cores to start workers on, one per core.
+    /** If not set, workers are started on every online core. Ownership of
+     *  the cpu_set_t object is not transferred.
+     */
+    const cpu_set_t *cpu_set{};
+
+    /// Cores to start workers on, takes precedence over \c cpu_set when
+    /// not empty.
+    cpu_mask affinity{};
+
+    /// Priority of the critical workers
+    int critical_priority{80};
+
+    /// Priority of the background workers, zero for non-realtime
+    int background_priority{0};
+
+    /// Capacity of the queue of each worker
+    std::size_t queue_capacity{256};
+
+    /// Construct options from convenient initializers
+    template <typename... Initializers>
+    constexpr explicit options(Initializers &&... init) noexcept;
+  };
+
+  /// Start the workers
+  /** @throw system_error when a worker cannot be started. */
+  RTXX_DECL explicit thread_pool(const options &opt);
+
+  /// Deleted copy constructor
+  thread_pool(const thread_pool &) = delete;
+
+  /// Deleted copy assignment operator
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  /// Run the queued jobs, then stop and join the workers
+  RTXX_DECL ~thread_pool();
+
+  /// Get the number of workers of each lane
+  [[nodiscard]] std::size_t size() const noexcept
+  {
+    return workers_[0].size();
+  }
+
+  /// Queue a job, fails if every queue of the lane is full
+  template <typename F> bool try_submit(lane l, F &&f);
+
+  /// Run \c fn(i) for every \c i in [first, last) on the critical lane
+  /** Indices are handed out in chunks of \c grain to the critical workers
+   *  and to the caller, which takes part in the work. Once \c deadline
+   *  is reached, chunks not started yet are cancelled; chunks already
+   *  running are always waited for.
+   *  @returns \c true if every index was processed
+   */
+  template <typename F>
+  bool parallel_for(std::size_t first, std::size_t last, std::size_t grain,
+                    F &&fn,
+                    monotonic_clock::time_point deadline =
+                        monotonic_clock::time_point::max());
+
+private:
+  struct worker;
+
+  /// State of a parallel_for, shared with the jobs helping it.
+  struct fork_join
+  {
+    /// Holders of this state, free when zero.
+    std::atomic<unsigned> refs{0};
+    std::atomic<std::size_t> next{0};
+    std::size_t last{0};
+    std::size_t grain{1};
+    monotonic_clock::time_point deadline{};
+    /// Participants inside the chunk loop.
+    std::atomic<unsigned> running{0};
+    /// Set when no chunk may be started anymore.
+    std::atomic<bool> closed{false};
+    void (*call)(void *fn, std::size_t i){};
+    void *fn{};
+    /// Posted when running drops to zero.
+    semaphore done{0};
+  };
+
+  /// Number of parallel_for which may run at the same time.
+  static constexpr std::size_t max_fork_joins = 8;
+
+  RTXX_DECL void stop() noexcept;
+  RTXX_DECL bool push(lane l, job_type &job) noexcept;
+  RTXX_DECL static bool pop(worker &w, job_type &job) noexcept;
+  RTXX_DECL bool steal(lane l, const worker &self, job_type &job) noexcept;
+  RTXX_DECL void run(lane l, worker &self) noexcept;
+
+  RTXX_DECL fork_join *acquire_fork_join() noexcept;
+  RTXX_DECL static void release(fork_join &fj) noexcept;
+  RTXX_DECL static void help(fork_join &fj) noexcept;
+  RTXX_DECL bool join(fork_join &fj, std::size_t helpers) noexcept;
+
+  std::vector<std::unique_ptr<worker>> workers_[2];
+  std::atomic<unsigned> next_[2]{};
+  std::atomic<bool> stop_{false};
+  fork_join fork_joins_[max_fork_joins];
+};
+
+/// Returns an initializer for the critical_priority pool option.
+RTXX_INLINE_DECL constexpr auto critical_priority(int value);
+
+/// Returns an initializer for the background_priority pool option.
+RTXX_INLINE_DECL constexpr auto background_priority(int value);
+
+/// Returns an initializer for the queue_capacity pool option.
+RTXX_INLINE_DECL constexpr auto queue_capacity(std::size_t n);
+
+} // namespace rtxx
+
+#include <rtxx/impl/thread_pool.tpp>
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/thread_pool.ipp>
+#endif
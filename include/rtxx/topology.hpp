@@ -0,0 +1,136 @@
+#pragma once
+
+#include <rtxx/config.hpp>
+#include <rtxx/cpu_mask.hpp>
+#include <rtxx/error.hpp>
+#include <vector>
+
+namespace rtxx
+{
+/// CPU layout of the machine, as described by \c /sys.
+/** Gives the physical cores, SMT siblings, shared L2 and L3 caches and
+ *  NUMA nodes of the online CPUs, and the CPUs set aside with the
+ *  \c isolcpus and \c nohz_full kernel parameters. Reading it allocates
+ *  and opens files: do it at startup, then place tasks with the result.
+ *
+ * @par Example
+ * @code
+ *   auto topo = rtxx::topology::read();
+ *   auto cpus = topo.place_together(2);
+ *   if (cpus.size() == 2)
+ *   {
+ *     rtxx::task producer(rtxx::task::options{rtxx::priority(80),
+ *                             rtxx::affinity(rtxx::cpu_mask{cpus[0]})}, ...);
+ *     rtxx::task consumer(rtxx::task::options{rtxx::priority(80),
+ *                             rtxx::affinity(rtxx::cpu_mask{cpus[1]})}, ...);
+ *   }
+ * @endcode
+ */
+class topology
+{
+public:
+  /// Description of one online CPU
+  struct cpu_info
+  {
+    /// CPU number
+    int cpu;
+
+    /// Lowest CPU of the physical core, shared by its SMT siblings
+    int core;
+
+    /// Physical package (socket)
+    int package;
+
+    /// NUMA node
+    int node;
+
+    /// Lowest CPU sharing the L2 cache, or -1 if unknown
+    int l2;
+
+    /// Lowest CPU sharing the L3 cache, or -1 if unknown
+    int l3;
+  };
+
+  /// Read the topology of the machine
+  /** @throw system_error when the list of online CPUs cannot be read. */
+  RTXX_DECL static topology read(const char *sysfs = "/sys");
+
+  /// Read the topology of the machine
+  /** Missing optional files, such as cache or node descriptions, are
+   *  treated as if every CPU had its own cache and was on node 0.
+   */
+  RTXX_DECL static topology read(const char *sysfs, error_code &ec);
+
+  /// Get the description of the online CPUs, sorted by CPU number
+  [[nodiscard]] const std::vector<cpu_info> &cpus() const noexcept
+  {
+    return cpus_;
+  }
+
+  /// Get the description of a CPU, or nullptr if it is not online
+  [[nodiscard]] RTXX_DECL const cpu_info *find(int cpu) const noexcept;
+
+  /// Get the online CPUs
+  [[nodiscard]] const cpu_mask &online() const noexcept { return online_; }
+
+  /// Get the CPUs isolated from the scheduler with \c isolcpus
+  [[nodiscard]] const cpu_mask &isolated() const noexcept
+  {
+    return isolated_;
+  }
+
+  /// Get the CPUs running without scheduler tick with \c nohz_full
+  [[nodiscard]] const cpu_mask &nohz_full() const noexcept
+  {
+    return nohz_full_;
+  }
+
+  /// Get the CPUs of the physical core of a CPU, including itself
+  [[nodiscard]] RTXX_DECL cpu_mask siblings(int cpu) const;
+
+  /// Get the CPUs sharing the cache of a given \c level (2 or 3) with a CPU
+  [[nodiscard]] RTXX_DECL cpu_mask sharing_cache(int cpu, int level) const;
+
+  /// Get the CPUs of a NUMA node
+  [[nodiscard]] RTXX_DECL cpu_mask node(int node) const;
+
+  /// Keep one CPU, the lowest, of each physical core in \c within
+  [[nodiscard]] RTXX_DECL cpu_mask cores(const cpu_mask &within) const;
+
+  /// Choose CPUs for \c n tasks which communicate with each other
+  /** Each task gets a physical core of its own, never an SMT sibling of
+   *  another one, and the cores share the closest possible cache: an L2,
+   *  else an L3, else a NUMA node. CPUs are taken from \c within, or,
+   *  when it is empty, from the isolated CPUs if there are enough of
+   *  them, else from all online CPUs.
+   *  @returns \c n CPUs, or an empty vector if there are not enough
+   *  physical cores
+   */
+  [[nodiscard]] RTXX_DECL std::vector<int>
+  place_together(unsigned n, const cpu_mask &within = cpu_mask()) const;
+
+  /// Choose CPUs for \c n tasks which should not disturb each other
+  /** Each task gets a physical core of its own, spread over as many
+   *  NUMA nodes and L3 caches as possible. CPUs are chosen from the same
+   *  set as by place_together().
+   *  @returns \c n CPUs, or an empty vector if there are not enough
+   *  physical cores
+   */
+  [[nodiscard]] RTXX_DECL std::vector<int>
+  place_apart(unsigned n, const cpu_mask &within = cpu_mask()) const;
+
+private:
+  /// Get the CPUs from which \c n tasks are placed.
+  RTXX_DECL cpu_mask candidates(unsigned n, const cpu_mask &within) const;
+
+  std::vector<cpu_info> cpus_;
+  cpu_mask online_;
+  cpu_mask isolated_;
+  cpu_mask nohz_full_;
+};
+
+} // namespace rtxx
+
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/topology.ipp>
+#endif
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <rtxx/clock.hpp>
+#include <rtxx/config.hpp>
+#include <rtxx/error.hpp>
+
+namespace rtxx
+{
+/// Timeline of task and synchronization events
+/** When rtxx is built with \c RTXX_ENABLE_TRACE, task, mutex, semaphore
+ *  and condition_variable record their events into a ring buffer owned
+ *  by the calling thread, timestamped with tsc_clock. Each
+ *  thread keeps its last \c RTXX_TRACE_BUFFER_EVENTS events, older ones
+ *  are overwritten. Without \c RTXX_ENABLE_TRACE nothing is recorded and
+ *  the instrumentation compiles to nothing.
+ *
+ *  export_json() writes the events in the Chrome trace event format,
+ *  which chrome://tracing and https://ui.perfetto.dev open directly.
+ *  Waits for a mutex, semaphore, condition variable or period are shown
+ *  as slices, as well as the time a mutex is held, while posts and
+ *  periodic releases are instants.
+ *
+ *  The first event of a thread allocates its buffer, and the first of the
+ *  process calibrates tsc_clock. Call trace::attach() during the
+ *  initialisation of realtime tasks to avoid both.
+ *
+ * @par Example
+ * @code
+ *   // cmake -DRTXX_ENABLE_TRACE=ON
+ *   rtxx::trace::attach();
+ *   // ... run until the deadline miss
+ *   rtxx::trace::export_json("/tmp/rtxx.json");
+ * @endcode
+ */
+namespace trace
+{
+/// Recorded events
+enum class event : std::uint8_t
+{
+  /// A periodic task woke up, the argument is its latency in nanoseconds.
+  wakeup,
+  /// Started to lock a mutex.
+  lock_request,
+  /// Locked a mutex, the argument is 1 if the attempt failed.
+  lock_acquire,
+  /// Unlocked a mutex.
+  lock_release,
+  /// Started to wait on a semaphore, condition variable or period.
+  wait_begin,
+  /// Stopped waiting, the argument is 1 on timeout.
+  wait_end,
+  /// Posted a semaphore or notified a condition variable.
+  post,
+};
+
+/// Allocate the buffer of the calling thread
+/** Also calibrates tsc_clock. Does nothing when tracing is compiled out.
+ *  @throw std::bad_alloc when the buffer cannot be allocated.
+ */
+RTXX_DECL void attach();
+
+/// Write the recorded events of all threads to \c path as JSON
+/** Threads may keep recording meanwhile, their newest events are then
+ *  not exported.
+ */
+RTXX_DECL void export_json(const char *path, error_code &ec);
+
+/// Write the recorded events of all threads to \c path as JSON
+/** @throw system_error when error occurs. */
+RTXX_DECL void export_json(const char *path);
+
+/// Discard the recorded events of all threads
+/** Must not be called while other threads record events. */
+RTXX_DECL void clear() noexcept;
+
+namespace detail
+{
+/// One recorded event.
+struct entry
+{
+  /// tsc_clock time, in nanoseconds.
+  std::int64_t ns;
+  const void *object;
+  std::uint32_t arg;
+  event type;
+};
+
+/// Event ring of a thread, never freed so it can be exported later.
+struct buffer
+{
+  static constexpr std::uint64_t capacity = RTXX_TRACE_BUFFER_EVENTS;
+  static_assert((capacity & (capacity - 1)) == 0,
+                "RTXX_TRACE_BUFFER_EVENTS must be a power of two");
+
+  /// Number of events ever recorded, written by the owner only.
+  std::atomic<std::uint64_t> count{0};
+  entry entries[capacity];
+
+  long tid{0};
+  char name[16]{};
+  buffer *next{};
+};
+
+/// Buffer of the calling thread, null until attached.
+RTXX_INLINE_DECL buffer *&current() noexcept;
+
+/// Allocate and register the buffer of the calling thread.
+RTXX_DECL buffer *attach() noexcept;
+
+/// Record an event.
+RTXX_INLINE_DECL void record(event e, const void *object,
+                             std::uint32_t arg) noexcept;
+} // namespace detail
+} // namespace trace
+} // namespace rtxx
+
+/// Record a trace event, compiled out unless RTXX_ENABLE_TRACE is defined
+#ifdef RTXX_ENABLE_TRACE
+#define RTXX_TRACE(ev, object, arg)                                            \
+  ::rtxx::trace::detail::record(::rtxx::trace::event::ev, object, arg)
+#else
+#define RTXX_TRACE(ev, object, arg) ((void)0)
+#endif
+
+#include <rtxx/impl/trace.hpp>
+#ifdef RTXX_HEADER_ONLY
+#include <rtxx/impl/trace.ipp>
+#endif
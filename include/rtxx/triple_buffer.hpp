@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <rtxx/config.hpp>
+
+namespace rtxx
+{
+/// Latest-value exchange between one writer and one reader.
+/** The writer fills a back buffer and publishes it, the reader takes the
+ *  most recently published buffer. Neither side ever waits or copies the
+ *  other's buffer, which suits state too large to copy on every read.
+ *  Values published while the reader does not look are overwritten.
+ *  Each buffer and each side's index live on their own cache lines.
+ *
+ * @par Example
+ * @code
+ *   rtxx::triple_buffer<point_cloud> clouds;
+ *
+ *   // writer
+ *   fill(clouds.write_buffer());
+ *   clouds.publish();
+ *
+ *   // reader
+ *   const point_cloud &c = clouds.read();
+ * @endcode
+ */
+template <typename T> class triple_buffer
+{
+public:
+  using value_type = T;
+
+  /// Create three value-initialized buffers
+  triple_buffer() = default;
+
+  /// Deleted copy constructor
+  triple_buffer(const triple_buffer &) = delete;
+
+  /// Deleted copy assignment operator
+  triple_buffer &operator=(const triple_buffer &) = delete;
+
+  /// Get the buffer to fill before publish()
+  /** Writer side only. */
+  T &write_buffer() noexcept { return buffers_[back_].value; }
+
+  /// Make the write buffer the latest value
+  /** Writer side only. */
+  void publish() noexcept;
+
+  /// Copy \c value into the write buffer and publish it
+  /** Writer side only. */
+  void write(const T &value);
+
+  /// Checks if a value was published since the last read()
+  /** Reader side only. */
+  [[nodiscard]] bool updated() const noexcept;
+
+  /// Get the latest published value
+  /** Reader side only. The reference stays valid until the next read(). */
+  const T &read() noexcept;
+
+private:
+  /// Set in middle_ when it holds a buffer not seen by the reader.
+  static constexpr unsigned fresh = 4;
+
+  struct alignas(RTXX_CACHELINE_SIZE) slot
+  {
+    T value{};
+  };
+
+  slot buffers_[3];
+
+  /// Buffer exchanged between the sides, with the fresh bit.
+  alignas(RTXX_CACHELINE_SIZE) std::atomic<unsigned> middle_{1};
+
+  /// Buffer owned by the writer.
+  alignas(RTXX_CACHELINE_SIZE) unsigned back_{0};
+
+  /// Buffer owned by the reader.
+  alignas(RTXX_CACHELINE_SIZE) unsigned front_{2};
+};
+
+} // namespace rtxx
+
+#include <rtxx/impl/triple_buffer.tpp>
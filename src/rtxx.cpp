@@ -3,9 +3,24 @@
 
 #include <rtxx/rtxx.hpp>
 
+#include <rtxx/impl/barrier.ipp>
 #include <rtxx/impl/clock.ipp>
 #include <rtxx/impl/condition_variable.ipp>
+#include <rtxx/impl/cpu_mask.ipp>
+#include <rtxx/impl/cyclic_executor.ipp>
+#include <rtxx/impl/event_flags.ipp>
+#include <rtxx/impl/latch.ipp>
+#include <rtxx/impl/latency_histogram.ipp>
+#include <rtxx/impl/log.ipp>
+#include <rtxx/impl/memory_resource.ipp>
+#include <rtxx/impl/message_queue.ipp>
 #include <rtxx/impl/mutex.ipp>
+#include <rtxx/impl/reactor.ipp>
+#include <rtxx/impl/runtime.ipp>
 #include <rtxx/impl/semaphore.ipp>
+#include <rtxx/impl/shared_memory.ipp>
 #include <rtxx/impl/task.ipp>
+#include <rtxx/impl/thread_pool.ipp>
+#include <rtxx/impl/topology.ipp>
+#include <rtxx/impl/trace.ipp>
 
@@ -0,0 +1,106 @@
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <rtxx/barrier.hpp>
+#include <rtxx/latch.hpp>
+#include <rtxx/task.hpp>
+#include <vector>
+
+using namespace rtxx;
+using namespace std::literals;
+
+namespace
+{
+constexpr unsigned participants = 4;
+constexpr unsigned phases = 2000;
+
+/// Every participant must see all the others in the same phase.
+void run_phases(const barrier::options &opt)
+{
+  unsigned done[participants] = {};
+  unsigned completions = 0;
+  std::atomic<unsigned> serial{0};
+
+  barrier b(
+      participants,
+      [&] {
+        ++completions;
+        for (unsigned i = 0; i != participants; ++i)
+          assert(done[i] == completions);
+      },
+      opt);
+  assert(b.expected() == participants);
+
+  std::vector<std::unique_ptr<task>> tasks;
+  for (unsigned i = 0; i != participants; ++i)
+    tasks.emplace_back(new task([&, i] {
+      for (unsigned p = 0; p != phases; ++p)
+      {
+        ++done[i];
+        if (b.arrive_and_wait())
+          serial.fetch_add(1, std::memory_order_relaxed);
+        assert(completions == p + 1);
+      }
+    }));
+
+  for (auto &t : tasks)
+    t->join();
+  assert(completions == phases);
+  assert(serial == phases);
+}
+
+/// Participants re-entering at once must still wait for all the others.
+void reenter(unsigned count, const barrier::options &opt)
+{
+  std::atomic<unsigned> arrivals{0};
+  barrier b(count, opt);
+
+  std::vector<std::unique_ptr<task>> tasks;
+  for (unsigned i = 0; i != count; ++i)
+    tasks.emplace_back(new task([&] {
+      for (unsigned p = 0; p != phases; ++p)
+      {
+        arrivals.fetch_add(1, std::memory_order_relaxed);
+        b.arrive_and_wait();
+        assert(arrivals.load(std::memory_order_relaxed) >= (p + 1) * count);
+      }
+    }));
+
+  for (auto &t : tasks)
+    t->join();
+  assert(arrivals == phases * count);
+}
+} // namespace
+
+int main()
+{
+  run_phases(barrier::options{});
+  run_phases(barrier::options{spin_time(0ns)});
+  reenter(3, barrier::options{});
+  reenter(8, barrier::options{});
+  reenter(8, barrier::options{spin_time(0ns)});
+
+  // A latch opens once, after the last count_down()
+  latch ready(participants - 1, latch::options{spin_time(0ns)});
+  assert(!ready.try_wait());
+
+  std::atomic<unsigned> started{0};
+  std::vector<std::unique_ptr<task>> tasks;
+  for (unsigned i = 1; i != participants; ++i)
+    tasks.emplace_back(new task([&] {
+      started.fetch_add(1);
+      ready.count_down();
+    }));
+
+  ready.wait();
+  assert(ready.try_wait());
+  assert(started == participants - 1);
+  for (auto &t : tasks)
+    t->join();
+
+  latch single(2);
+  task other([&] { single.arrive_and_wait(); });
+  single.arrive_and_wait();
+  other.join();
+  assert(single.try_wait());
+}
@@ -0,0 +1,32 @@
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <rtxx/clock.hpp>
+
+using namespace rtxx;
+
+using namespace std::literals;
+
+int main()
+{
+  tsc_clock::calibrate();
+  std::cout << "tsc_clock uses counter:\t" << tsc_clock::uses_counter() << '\n';
+
+  auto prev = tsc_clock::now();
+  for (int i = 0; i != 100000; ++i)
+  {
+    const auto t = tsc_clock::now();
+    assert(t >= prev);
+    prev = t;
+  }
+
+  // Both clocks share the monotonic timeline.
+  const auto mono = monotonic_clock::now();
+  const auto tsc = tsc_clock::to_monotonic(tsc_clock::now());
+  const auto skew = std::abs((tsc - mono).count());
+  std::cout << "skew:\t" << skew << '\n';
+  assert(skew < chrono::nanoseconds(1ms).count());
+
+  assert(tsc_clock::from_monotonic(mono).time_since_epoch() ==
+         mono.time_since_epoch());
+}
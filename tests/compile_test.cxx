@@ -1,8 +1,27 @@
 #include "rtxx/task.hpp"
 #include "rtxx/semaphore.hpp"
+#include "rtxx/spsc_queue.hpp"
 #include "rtxx/mutex.hpp"
+#include "rtxx/message_queue.hpp"
 #include "rtxx/clock.hpp"
 #include "rtxx/condition_variable.hpp"
+#include "rtxx/cyclic_executor.hpp"
+#include "rtxx/runtime.hpp"
+#include "rtxx/memory_resource.hpp"
+#include "rtxx/inplace_function.hpp"
+#include "rtxx/thread_pool.hpp"
+#include "rtxx/reactor.hpp"
+#include "rtxx/seqlock.hpp"
+#include "rtxx/triple_buffer.hpp"
+#include "rtxx/shared_memory.hpp"
+#include "rtxx/shm_channel.hpp"
+#include "rtxx/log.hpp"
+#include "rtxx/trace.hpp"
+#include "rtxx/barrier.hpp"
+#include "rtxx/latch.hpp"
+#include "rtxx/cpu_mask.hpp"
+#include "rtxx/topology.hpp"
+#include "rtxx/event_flags.hpp"
 
 int main()
 {
@@ -0,0 +1,158 @@
+#include <cassert>
+#include <new>
+#include <rtxx/coroutine.hpp>
+#include <rtxx/task.hpp>
+#include <thread>
+
+using namespace rtxx;
+
+using namespace std::literals;
+
+namespace
+{
+co_task periodic(int &count, int cycles)
+{
+  this_coroutine::set_periodic(monotonic_clock::now() + 1ms, 2ms);
+  for (int i = 0; i != cycles; ++i)
+  {
+    co_await this_coroutine::wait_period();
+    ++count;
+  }
+}
+
+co_task producer(semaphore &sem, int n)
+{
+  for (int i = 0; i != n; ++i)
+  {
+    co_await this_coroutine::sleep_for(1ms);
+    sem.post();
+  }
+}
+
+co_task consumer(semaphore &sem, int n, int &received, bool &timed_out)
+{
+  for (;;)
+  {
+    // Generous while posts are expected, so that a loaded host cannot make
+    // it time out early.
+    const auto timeout = received == n ? 1ms : 10s;
+    const bool ok = co_await this_coroutine::acquire(
+        sem, monotonic_clock::now() + timeout);
+    if (!ok)
+    {
+      timed_out = true;
+      co_return;
+    }
+    ++received;
+  }
+}
+
+void test_periodic()
+{
+  co_scheduler sched(co_scheduler::options{max_coroutines(128)});
+
+  int counts[100] = {};
+  for (auto &c : counts)
+    sched.spawn(periodic, c, 5);
+  assert(sched.size() == 100);
+
+  task t(task::options{priority(10)}, [&] { sched.run(); });
+  t.join();
+
+  assert(sched.size() == 0);
+  for (auto c : counts)
+    assert(c == 5);
+}
+
+void test_semaphore()
+{
+  co_scheduler sched(co_scheduler::options{poll_interval(50us)});
+  semaphore sem(0);
+  int received = 0;
+  bool timed_out = false;
+
+  sched.spawn(consumer, sem, 10, received, timed_out);
+  sched.spawn(producer, sem, 10);
+
+  task t(task::options{priority(10)}, [&] { sched.run(); });
+  t.join();
+
+  assert(received == 10);
+  assert(timed_out);
+}
+
+co_task take(co_semaphore &sem, int n, semaphore &done)
+{
+  for (int i = 0; i != n; ++i)
+  {
+    co_await this_coroutine::acquire(sem);
+    done.post();
+  }
+}
+
+void test_wakeup()
+{
+  // Posts and stop() wake the scheduler long before the poll interval
+  co_scheduler sched(co_scheduler::options{poll_interval(1h)});
+  co_semaphore sem(0), never(0);
+  semaphore done(0), never_done(0);
+  sched.spawn(take, sem, 3, done);
+  sched.spawn(take, never, 1, never_done);
+
+  const auto t0 = monotonic_clock::now();
+  task t(task::options{priority(10)}, [&] { sched.run(); });
+  for (int i = 0; i != 3; ++i)
+  {
+    std::this_thread::sleep_for(2ms);
+    sem.post();
+    done.wait();
+  }
+  std::this_thread::sleep_for(2ms);
+  sched.stop();
+  t.join();
+
+  assert(monotonic_clock::now() - t0 < 10s);
+  assert(never_done.get_value() == 0);
+  assert(sched.size() == 1);
+}
+
+void test_frame_pool()
+{
+  co_scheduler sched(co_scheduler::options{max_coroutines(2)});
+  int count = 0;
+  sched.spawn(periodic, count, 1);
+  sched.spawn(periodic, count, 1);
+
+  bool thrown = false;
+  try
+  {
+    sched.spawn(periodic, count, 1);
+  }
+  catch (const std::bad_alloc &)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+  assert(sched.size() == 2);
+
+  // frames can only come from a scheduler
+  thrown = false;
+  try
+  {
+    periodic(count, 1);
+  }
+  catch (const std::bad_alloc &)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+}
+} // namespace
+
+int main()
+{
+  test_periodic();
+  test_semaphore();
+  test_wakeup();
+  test_frame_pool();
+}
@@ -0,0 +1,58 @@
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <rtxx/cyclic_executor.hpp>
+
+using namespace rtxx;
+
+using namespace std::literals;
+
+int main()
+{
+  {
+    cyclic_executor bad;
+    bad.add_job("a", 2ms, 0ms, [] {});
+    bad.add_job("b", 3ms, 0ms, [] {});
+
+    error_code ec;
+    bad.start(task::options{}, ec);
+    assert(ec == std::errc::invalid_argument);
+    assert(!bad.running());
+  }
+
+  cyclic_executor ex;
+  unsigned long fast = 0, mid = 0, slow = 0;
+  const auto a = ex.add_job("fast", 1ms, 0ms, [&] { ++fast; });
+  const auto b = ex.add_job("mid", 2ms, 1ms, [&] { ++mid; });
+  const auto c = ex.add_job("slow", 4ms, 2ms, [&] { ++slow; });
+
+  ex.start(task::options{name("cyclic"), priority(90)});
+  assert(ex.running());
+  assert(ex.minor_frame() == 1ms);
+  assert(ex.major_frame() == 4ms);
+
+  timespec ts = detail::duration_to_timespec(100ms);
+  nanosleep(&ts, nullptr);
+  ex.stop();
+  assert(!ex.running());
+
+  for (auto job : {a, b, c})
+  {
+    const auto s = ex.stats(job);
+    std::cout << ex.job_name(job) << ":\truns " << s.runs << "\toverruns "
+              << s.overruns << "\tskipped " << s.skipped << "\tmaxexec "
+              << s.max_exec_time.count() << '\n';
+  }
+  std::cout << "frame overruns:\t" << ex.frame_overruns() << '\n';
+
+  const auto releases = [&](auto job) {
+    const auto s = ex.stats(job);
+    return static_cast<long>(s.runs + s.skipped);
+  };
+
+  assert(releases(a) > 50);
+  assert(std::abs(releases(a) / 2 - releases(b)) <= 1);
+  assert(std::abs(releases(a) / 4 - releases(c)) <= 1);
+  assert(ex.stats(a).runs == fast && ex.stats(b).runs == mid &&
+         ex.stats(c).runs == slow);
+}
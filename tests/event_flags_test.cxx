@@ -0,0 +1,92 @@
+#include <atomic>
+#include <cassert>
+#include <rtxx/event_flags.hpp>
+#include <rtxx/task.hpp>
+#include <thread>
+
+using namespace rtxx;
+using namespace std::literals;
+
+int main()
+{
+  // Setting and clearing
+  {
+    event_flags ev(0x1);
+    assert(ev.get() == 0x1);
+    assert(ev.set(0x6) == 0x1);
+    assert(ev.clear(0x3) == 0x7);
+    assert(ev.get() == 0x4);
+
+    assert(ev.wait_any(0x5) == 0x4);
+    assert(ev.wait_all(0x4) == 0x4);
+
+    bool thrown = false;
+    try
+    {
+      ev.wait_any(0);
+    }
+    catch (const system_error &e)
+    {
+      thrown = e.code() == errc::invalid_argument;
+    }
+    assert(thrown);
+  }
+
+  // Timeouts
+  {
+    event_flags ev(0x1);
+    const auto start = monotonic_clock::now();
+    assert(ev.wait_any_for(0x2, 10ms) == 0);
+    assert(monotonic_clock::now() - start >= 10ms);
+    assert(ev.wait_all_for(0x3, 1ms) == 0);
+    assert(ev.wait_all_until(0x3, realtime_clock::now() + 1ms) == 0);
+    assert(ev.wait_any_until(0x2, deadline::after(1ms)) == 0);
+    assert(ev.wait_any_until(0x3, deadline::after(1ms)) == 0x1);
+  }
+
+  // Only the waiters interested in a flag are woken by it
+  {
+    event_flags ev;
+    std::atomic<event_flags::mask_type> got_a{0}, got_b{0}, got_all{0};
+
+    task a([&] { got_a = ev.wait_any(0x1); });
+    task b([&] { got_b = ev.wait_any(0x2 | 0x4); });
+    task all([&] { got_all = ev.wait_all(0x1 | 0x2); });
+
+    std::this_thread::sleep_for(20ms);
+    ev.set(0x1);
+    a.join();
+    assert(got_a == 0x1);
+
+    std::this_thread::sleep_for(20ms);
+    assert(got_b == 0 && got_all == 0);
+
+    ev.set(0x4);
+    b.join();
+    assert(got_b == 0x4);
+    assert(got_all == 0);
+
+    ev.set(0x2);
+    all.join();
+    assert(got_all == 0x3);
+  }
+
+  // A flag cleared before the last one is set keeps wait_all sleeping
+  {
+    event_flags ev(0x1);
+    std::atomic<event_flags::mask_type> got{0};
+    task t([&] { got = ev.wait_all_for(0x3, 1s); });
+
+    std::this_thread::sleep_for(20ms);
+    ev.clear(0x1);
+    ev.set(0x2);
+    std::this_thread::sleep_for(20ms);
+    assert(got == 0);
+
+    ev.set(0x1);
+    t.join();
+    assert(got == 0x3);
+  }
+
+  return 0;
+}
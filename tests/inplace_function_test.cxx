@@ -0,0 +1,68 @@
+#include <cassert>
+#include <memory>
+#include <rtxx/inplace_function.hpp>
+#include <rtxx/task.hpp>
+
+using namespace rtxx;
+
+namespace
+{
+int destroyed = 0;
+
+struct counted
+{
+  int value;
+
+  explicit counted(int v) : value(v) {}
+  counted(counted &&other) noexcept : value(other.value) { other.value = 0; }
+  ~counted()
+  {
+    if (value)
+      ++destroyed;
+  }
+
+  int operator()(int x) const { return value + x; }
+};
+
+void test_function()
+{
+  inplace_function<int(int), 16> empty;
+  assert(!empty);
+
+  {
+    inplace_function<int(int), 16> f = counted(40);
+    assert(f && f(2) == 42);
+
+    auto g = std::move(f);
+    assert(!f && g(1) == 41);
+
+    f = std::move(g);
+    assert(f(0) == 40);
+  }
+  assert(destroyed == 1);
+
+  // move-only callables are accepted
+  auto p = std::make_unique<int>(7);
+  inplace_function<int()> h = [p = std::move(p)] { return *p; };
+  assert(h() == 7);
+}
+
+alignas(64) unsigned char task_stack[256 * 1024];
+
+void test_user_stack()
+{
+  const unsigned char *here = nullptr;
+  task t(task::options{stack(task_stack, sizeof(task_stack))}, [&here] {
+    unsigned char local;
+    here = &local;
+  });
+  t.join();
+  assert(here > task_stack && here < task_stack + sizeof(task_stack));
+}
+} // namespace
+
+int main()
+{
+  test_function();
+  test_user_stack();
+}
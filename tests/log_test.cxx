@@ -0,0 +1,96 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <rtxx/log.hpp>
+#include <rtxx/task.hpp>
+#include <string>
+
+using namespace rtxx;
+using namespace std::chrono_literals;
+
+namespace
+{
+enum class axis : short
+{
+  x = 1,
+  y,
+};
+
+std::string read_all(int fd)
+{
+  std::string out;
+  char buf[4096];
+  ssize_t n;
+  while ((n = ::read(fd, buf, sizeof(buf))) > 0)
+    out.append(buf, n);
+  return out;
+}
+
+std::size_t count(const std::string &s, const char *what)
+{
+  std::size_t n = 0;
+  for (auto pos = s.find(what); pos != std::string::npos;
+       pos = s.find(what, pos + 1))
+    ++n;
+  return n;
+}
+} // namespace
+
+int main()
+{
+  int fds[2];
+  assert(pipe2(fds, O_NONBLOCK) == 0);
+
+  // Without a drain, messages are written immediately.
+  log::debug("hidden %d", 1);
+  const char *none = nullptr;
+  log::info("int %d %5u %x %c, real %.2f, str %s|%-4s|, enum %d, %%, %s",
+            -42, 7u, 255, 'z', 3.14159, "hello", "ab", axis::y, none);
+  log::flush();
+
+  // Redirect to the pipe through a drain with a small buffer and a slow
+  // period, so that records pile up.
+  log::start(log::options{log_fd(fds[1]), log_buffer_size(4096),
+                          log_period(200ms), log_level(log::level::debug)},
+             task::options{name("log")});
+  assert(log::running());
+  log::attach();
+
+  log::debug("visible %d", 1);
+  log::warning("value %lu of %s %g", std::uint64_t(5), "many", 0.5);
+  log::flush();
+  {
+    const auto out = read_all(fds[0]);
+    assert(out.find(" D visible 1\n") != std::string::npos);
+    assert(out.find(" W value 5 of many 0.5\n") != std::string::npos);
+  }
+
+  // A full buffer drops and counts.
+  task t(task::options{}, [] {
+    for (int i = 0; i != 1000; ++i)
+      log::error("burst %d %d %d %d", i, i, i, i);
+  });
+  t.join();
+  const auto dropped = log::overflows();
+  assert(dropped > 0);
+
+  log::stop();
+  assert(!log::running());
+  {
+    const auto out = read_all(fds[0]);
+    assert(count(out, " E burst ") + dropped == 1000);
+    assert(out.find("rtxx::log: ") != std::string::npos);
+    assert(out.find(" E burst 0 0 0 0\n") != std::string::npos);
+  }
+
+  // After stop, messages are written immediately to the same descriptor.
+  log::error("after %s", "stop");
+  assert(read_all(fds[0]).find(" E after stop\n") != std::string::npos);
+
+  close(fds[0]);
+  close(fds[1]);
+  return 0;
+}
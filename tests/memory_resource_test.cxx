@@ -0,0 +1,103 @@
+#include <cassert>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <rtxx/alloc_guard.hpp>
+#include <rtxx/memory_resource.hpp>
+#include <rtxx/task.hpp>
+#include <vector>
+
+using namespace rtxx;
+
+using namespace std::literals;
+
+namespace
+{
+int *volatile sink;
+
+void test_arena()
+{
+  monotonic_arena arena(4096);
+  void *a = arena.allocate(10, 1);
+  void *b = arena.allocate(16, 16);
+  assert(reinterpret_cast<std::uintptr_t>(b) % 16 == 0);
+  assert(b > a);
+  assert(arena.used() >= 26 && arena.used() <= 32);
+
+  bool thrown = false;
+  try
+  {
+    (void)arena.allocate(4096, 1);
+  }
+  catch (const std::bad_alloc &)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+
+  arena.release();
+  assert(arena.used() == 0);
+  assert(arena.allocate(10, 1) == a);
+}
+
+void test_pool()
+{
+  pool_resource pool(24, 4);
+  assert(pool.block_size() >= 24);
+  assert(pool.available() == 4);
+
+  void *blocks[4];
+  for (auto &b : blocks)
+    b = pool.allocate(24);
+  assert(pool.available() == 0);
+
+  bool thrown = false;
+  try
+  {
+    (void)pool.allocate(8);
+  }
+  catch (const std::bad_alloc &)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+
+  pool.deallocate(blocks[2], 24);
+  assert(pool.available() == 1);
+  assert(pool.allocate(16) == blocks[2]);
+}
+
+void test_task_resource()
+{
+  monotonic_arena arena(1 << 16);
+  task t(task::options{memory_resource(&arena),
+                       alloc_guard(alloc_guard_mode::count)},
+         [&] {
+           assert(this_task::memory_resource() == &arena);
+
+           // warm-up: allocations are allowed
+           std::vector<int> warm(100);
+
+           this_task::set_periodic(monotonic_clock::now(), 1ms);
+           this_task::wait_period();
+
+           std::pmr::vector<int> v(this_task::memory_resource());
+           v.resize(1000);
+
+           sink = new int(42);
+           delete sink;
+         });
+  t.join();
+
+  assert(arena.used() >= 1000 * sizeof(int));
+  assert(t.heap_allocations() == 1);
+  assert(this_task::memory_resource() == std::pmr::get_default_resource());
+}
+} // namespace
+
+int main()
+{
+  test_arena();
+  test_pool();
+  test_task_resource();
+}
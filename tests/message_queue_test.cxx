@@ -0,0 +1,89 @@
+#include <cassert>
+#include <iostream>
+#include <rtxx/message_queue.hpp>
+#include <rtxx/task.hpp>
+
+using namespace rtxx;
+
+using namespace std::literals;
+
+struct command
+{
+  int producer;
+  int seq;
+};
+
+int main()
+{
+  message_queue<command> q(4);
+
+  command c{};
+  assert(!q.try_receive(c));
+  assert(!q.receive_for(c, 1ms));
+
+  // priority ordering, FIFO within a priority
+  q.send({0, 1}, 0);
+  q.send({0, 2}, 5);
+  q.send({0, 3}, 0);
+  q.send({0, 4}, 5);
+  assert(!q.try_send({0, 5}));
+
+  const int expected[] = {2, 4, 1, 3};
+  for (int seq : expected)
+  {
+    q.receive(c);
+    assert(c.seq == seq);
+  }
+
+  // zero-copy send, uncommitted slots go back to the queue
+  {
+    auto s = q.loan();
+    assert(s);
+    s->producer = 7;
+    s->seq = 8;
+    s.commit(1);
+
+    for (int i = 0; i != 3; ++i)
+      assert(q.try_loan());
+  }
+  assert(q.try_receive(c) && c.producer == 7 && c.seq == 8);
+  assert(!q.try_receive(c));
+
+  // several producers, one dispatcher
+  constexpr int producers = 3;
+  constexpr int count = 10000;
+  int last[producers] = {};
+
+  task dispatcher(task::options{name("dispatcher"), priority(50)}, [&] {
+    for (int i = 0; i != producers * count; ++i)
+    {
+      command c;
+      q.receive(c);
+      assert(c.seq == last[c.producer] + 1);
+      last[c.producer] = c.seq;
+    }
+  });
+
+  task p0([&] {
+    for (int i = 1; i <= count; ++i)
+      q.send({0, i});
+  });
+  task p1([&] {
+    for (int i = 1; i <= count; ++i)
+      q.send({1, i});
+  });
+  task p2([&] {
+    for (int i = 1; i <= count; ++i)
+      q.send({2, i});
+  });
+
+  p0.join();
+  p1.join();
+  p2.join();
+  dispatcher.join();
+
+  for (int n : last)
+    assert(n == count);
+
+  std::cout << "message_queue test passed\n";
+}
@@ -0,0 +1,140 @@
+#include <pthread.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <rtxx/mutex.hpp>
+#include <rtxx/semaphore.hpp>
+#include <rtxx/task.hpp>
+#include <thread>
+
+using namespace rtxx;
+
+using namespace std::literals;
+
+namespace
+{
+void contend(mutex &m)
+{
+  long counter = 0;
+  const auto body = [&] {
+    for (int i = 0; i != 10000; ++i)
+    {
+      std::lock_guard<mutex> guard(m);
+      ++counter;
+    }
+  };
+
+  task a(task::options{priority(10)}, body);
+  task b(task::options{priority(20)}, body);
+  a.join();
+  b.join();
+  assert(counter == 20000);
+}
+} // namespace
+
+int main()
+{
+  {
+    mutex m;
+    contend(m);
+  }
+
+  {
+    mutex m(mutex::options{priority_inherit(), adaptive_spin(100)});
+    contend(m);
+    assert(m.try_lock());
+    assert(!m.try_lock_for(1ms));
+    m.unlock();
+  }
+
+  {
+    mutex m(mutex::options{
+        priority_ceiling(sched_get_priority_max(SCHED_FIFO))});
+    contend(m);
+  }
+
+  {
+    mutex m(mutex::options{robust()});
+
+    // The owner exits without unlocking.
+    task owner([&] { m.lock(); });
+    owner.join();
+
+    m.lock();
+    assert(m.previous_owner_died());
+    m.unlock();
+
+    m.lock();
+    assert(!m.previous_owner_died());
+    m.unlock();
+  }
+
+  {
+    pthread_setname_np(pthread_self(), "mutex_test");
+    mutex quiet(mutex::options{name("quiet"), profile()});
+    mutex busy(mutex::options{name("busy"), profile()});
+    assert(busy.profiled());
+
+    {
+      std::lock_guard<mutex> guard(quiet);
+    }
+
+    // Hold the mutex while a task blocks on it. The waiter signals right
+    // before locking; at a higher priority it reaches the kernel before
+    // this task runs again on a single CPU, the sleep covers the others.
+    busy.lock();
+    semaphore locking(0);
+    task waiter(task::options{name("waiter"), priority(10)}, [&] {
+      locking.post();
+      busy.lock();
+      busy.unlock();
+      const bool locked = quiet.try_lock_for(1ms);
+      assert(!locked);
+    });
+    locking.wait();
+    std::this_thread::sleep_for(20ms);
+    quiet.lock();
+    busy.unlock();
+    waiter.join();
+    quiet.unlock();
+
+    const auto st = busy.statistics();
+    assert(st.acquisitions == 2);
+    assert(st.contended == 1);
+    assert(st.wait.count() == 1 && st.wait.max() > 0ns);
+    assert(st.hold.count() == 2);
+    assert(st.longest_hold > 0ns);
+    assert(std::strcmp(st.longest_holder, "mutex_test") == 0);
+
+    const auto q = quiet.statistics();
+    assert(q.acquisitions == 2 && q.contended == 0 && q.timeouts == 1);
+
+    const auto ranked = mutex_profiler::snapshot();
+    assert(ranked.size() == 2);
+    assert(std::strcmp(ranked[0].name, "busy") == 0);
+
+    std::FILE *out = std::tmpfile();
+    mutex_profiler::report(out);
+    assert(std::ftell(out) > 0);
+    std::fclose(out);
+
+    mutex plain;
+    assert(!plain.profiled());
+    bool thrown = false;
+    try
+    {
+      (void)plain.statistics();
+    }
+    catch (const system_error &e)
+    {
+      thrown = e.code() == errc::invalid_argument;
+    }
+    assert(thrown);
+  }
+  assert(mutex_profiler::snapshot().empty());
+
+  std::cout << "mutex test passed\n";
+}
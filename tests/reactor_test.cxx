@@ -0,0 +1,86 @@
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <rtxx/reactor.hpp>
+#include <rtxx/task.hpp>
+#include <thread>
+
+using namespace rtxx;
+
+using namespace std::literals;
+
+namespace
+{
+void test_reactor(bool io_uring)
+{
+  reactor r(reactor::options{use_io_uring(io_uring), max_sources(8)});
+  printf("backend: %s\n",
+         r.backend() == reactor::backend_type::io_uring ? "io_uring" : "epoll");
+  if (!io_uring)
+    assert(r.backend() == reactor::backend_type::epoll);
+
+  // nothing is ready
+  [[maybe_unused]] std::size_t called = r.run_once(1ms);
+  assert(called == 0);
+
+  // descriptor readiness, removed from its own handler
+  int fds[2];
+  [[maybe_unused]] const int err = pipe(fds);
+  assert(err == 0);
+  int reads = 0;
+  reactor::source_id pipe_id = 0;
+  auto on_readable = [&]([[maybe_unused]] std::uint64_t events) {
+    assert(events & reactor::readable);
+    char c;
+    [[maybe_unused]] const ssize_t n = ::read(fds[0], &c, 1);
+    assert(n == 1);
+    ++reads;
+    r.remove(pipe_id);
+  };
+  pipe_id = r.add_fd(fds[0], reactor::readable, on_readable);
+  [[maybe_unused]] const ssize_t written = ::write(fds[1], "ab", 2);
+  assert(written == 2);
+  called = r.run_once(100ms);
+  assert(called == 1);
+  called = r.run_once(1ms);
+  assert(called == 0);
+  assert(reads == 1);
+
+  // notifications coalesce until the handler runs
+  std::uint64_t notified = 0;
+  const auto n = r.add_notifier([&](std::uint64_t count) { notified += count; });
+  r.notify(n);
+  r.notify(n);
+  called = r.run_once(100ms);
+  assert(called == 1);
+  assert(notified == 2);
+
+  // periodic timer removed after 10 ticks, then the idle reactor is
+  // stopped from another task
+  std::atomic<int> ticks{0};
+  reactor::source_id timer_id = 0;
+  timer_id = r.add_timer(monotonic_clock::now() + 1ms, 1ms,
+                         [&](std::uint64_t expirations) {
+                           if ((ticks += expirations) >= 10)
+                             r.remove(timer_id);
+                         });
+
+  task t(task::options{priority(10)}, [&] { r.run(); });
+  while (ticks < 10)
+    std::this_thread::sleep_for(1ms);
+  r.stop();
+  t.join();
+  assert(ticks >= 10);
+
+  close(fds[0]);
+  close(fds[1]);
+}
+} // namespace
+
+int main()
+{
+  test_reactor(true);
+  test_reactor(false);
+}
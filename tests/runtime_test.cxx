@@ -0,0 +1,38 @@
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <rtxx/runtime.hpp>
+#include <rtxx/task.hpp>
+
+using namespace rtxx;
+
+int main()
+{
+  rtxx::error_code ec;
+  runtime::init(runtime::options{heap_reserve(8 << 20), prefault_stacks()},
+                ec);
+  if (ec == std::errc::operation_not_permitted ||
+      ec == std::errc::not_enough_memory)
+  {
+    // Not allowed to lock memory, keep going without it
+    runtime::init(runtime::options{lock_memory(false), heap_reserve(8 << 20),
+                                   prefault_stacks()});
+  }
+  else
+  {
+    assert(!ec);
+  }
+  assert(runtime::current().prefault_stacks);
+
+  constexpr std::size_t used = 64 * 1024;
+  task t(task::options{stack_size(1 << 20)}, [] {
+    volatile unsigned char buf[used];
+    std::memset(const_cast<unsigned char *>(buf), 0, sizeof(buf));
+  });
+  t.join();
+
+  printf("stack high water: %zu bytes\n", t.stack_high_water());
+  assert(t.stack_high_water() >= used);
+  assert(t.stack_high_water() < (1 << 20));
+}
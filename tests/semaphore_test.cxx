@@ -1,10 +1,14 @@
 #include "rtxx/semaphore.hpp"
 
+#include <cassert>
 #include <iostream>
 
+#include "rtxx/condition_variable.hpp"
+#include "rtxx/mutex.hpp"
 #include "rtxx/task.hpp"
 
 using namespace rtxx;
+using namespace std::literals;
 
 int main() {
     semaphore sem(1);
@@ -29,4 +33,41 @@ int main() {
     t3.join();
 
     assert(sem.get_value() == 1);
+
+    // Timed waits on both clocks
+    semaphore empty(0);
+    const auto st = monotonic_clock::now();
+    assert(!empty.wait_for(1ms));
+    assert(!empty.wait_until(monotonic_clock::now() + 1ms));
+    assert(!empty.wait_until(realtime_clock::now() + 1ms));
+    assert(monotonic_clock::now() - st >= 3ms);
+
+    // One deadline shared by several waits
+    const auto d = deadline::after(2ms);
+    assert(!d.expired() && d.remaining() <= 2ms);
+    assert(!empty.wait_until(d));
+    assert(d.expired() && d.remaining() == 0ns);
+
+    mutex m;
+    condition_variable cv;
+    std::unique_lock<mutex> lock(m);
+    assert(!cv.wait_until(lock, d));
+    assert(!cv.wait_for(lock, 1ms));
+    assert(!cv.wait_until(lock, realtime_clock::now() + 1ms));
+
+    // Raw timespecs are on CLOCK_REALTIME unless a clock is given
+    const auto rt = detail::duration_to_timespec(
+        (realtime_clock::now() + 1ms).time_since_epoch());
+    const auto mono = detail::duration_to_timespec(
+        (monotonic_clock::now() + 1ms).time_since_epoch());
+    bool woken = cv.wait_until(lock, &rt);
+    woken = woken || cv.wait_until(lock, CLOCK_MONOTONIC, &mono);
+    assert(!woken);
+    lock.unlock();
+    bool got = empty.wait_until(&rt);
+    got = got || empty.wait_until(CLOCK_MONOTONIC, &mono);
+    assert(!got);
+
+    assert(m.try_lock_until(d));
+    m.unlock();
 }
\ No newline at end of file
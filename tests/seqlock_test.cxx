@@ -0,0 +1,64 @@
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <rtxx/seqlock.hpp>
+#include <rtxx/task.hpp>
+
+using namespace rtxx;
+
+namespace
+{
+struct state
+{
+  std::uint64_t seq;
+  double joints[16];
+  std::uint64_t check;
+};
+
+state make_state(std::uint64_t seq)
+{
+  state s{};
+  s.seq = seq;
+  for (int i = 0; i != 16; ++i)
+    s.joints[i] = seq * 0.5 + i;
+  s.check = ~seq;
+  return s;
+}
+} // namespace
+
+int main()
+{
+  static_assert(alignof(seqlock<state>) == RTXX_CACHELINE_SIZE);
+  static_assert(sizeof(seqlock<state>) % RTXX_CACHELINE_SIZE == 0);
+
+  seqlock<state> cell(make_state(0));
+  assert(cell.load().seq == 0);
+
+  constexpr std::uint64_t writes = 200000;
+  std::atomic<bool> done{false};
+
+  task writer([&] {
+    for (std::uint64_t i = 1; i <= writes; ++i)
+      cell.store(make_state(i));
+    done = true;
+  });
+
+  std::uint64_t last = 0, reads = 0;
+  task reader([&] {
+    while (!done.load())
+    {
+      const state s = cell.load();
+      assert(s.check == ~s.seq);
+      for (int i = 0; i != 16; ++i)
+        assert(s.joints[i] == s.seq * 0.5 + i);
+      assert(s.seq >= last);
+      last = s.seq;
+      ++reads;
+    }
+  });
+
+  writer.join();
+  reader.join();
+  assert(cell.load().seq == writes);
+  assert(reads > 0);
+}
@@ -0,0 +1,149 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <new>
+#include <rtxx/mutex.hpp>
+#include <rtxx/semaphore.hpp>
+#include <rtxx/shared_memory.hpp>
+#include <rtxx/shm_channel.hpp>
+
+using namespace rtxx;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct message
+{
+  std::uint64_t seq;
+  double value;
+};
+
+struct shared_state
+{
+  mutex lock{mutex::options{process_shared()}};
+  semaphore ready{0, semaphore::options{process_shared()}};
+  long counter{0};
+};
+
+constexpr int rounds = 10000;
+
+void wait_child(pid_t pid)
+{
+  int status = 0;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+} // namespace
+
+int main()
+{
+  char state_name[64], channel_name[64];
+  snprintf(state_name, sizeof(state_name), "/rtxx_state_%d", int(getpid()));
+  snprintf(channel_name, sizeof(channel_name), "/rtxx_chan_%d", int(getpid()));
+
+  // process-shared mutex and semaphore
+  {
+    shared_memory shm(state_name, sizeof(shared_state),
+                      shared_memory::mode::create);
+    assert(shm.created());
+    auto *st = ::new (shm.data()) shared_state;
+
+    const pid_t pid = fork();
+    assert(pid != -1);
+    if (pid == 0)
+    {
+      shared_memory child(state_name, sizeof(shared_state),
+                          shared_memory::mode::open);
+      assert(!child.created());
+      auto *cst = static_cast<shared_state *>(child.data());
+      for (int i = 0; i != rounds; ++i)
+      {
+        cst->lock.lock();
+        ++cst->counter;
+        cst->lock.unlock();
+      }
+      cst->ready.post();
+      _exit(0);
+    }
+
+    for (int i = 0; i != rounds; ++i)
+    {
+      st->lock.lock();
+      ++st->counter;
+      st->lock.unlock();
+    }
+    st->ready.wait();
+    assert(st->counter == 2 * rounds);
+    wait_child(pid);
+
+    st->~shared_state();
+    shared_memory::remove(state_name);
+  }
+
+  // channel from parent to child
+  {
+    shm_channel<message> ch(channel_name, 64, shared_memory::mode::create);
+    assert(ch.capacity() == 64);
+
+    // Mismatched capacity is rejected.
+    bool thrown = false;
+    try
+    {
+      shm_channel<message> bad(channel_name, 32, shared_memory::mode::open);
+    }
+    catch (const system_error &e)
+    {
+      thrown = e.code() == errc::invalid_argument;
+    }
+    assert(thrown);
+
+    const pid_t pid = fork();
+    assert(pid != -1);
+    if (pid == 0)
+    {
+      shm_channel<message> rx(channel_name, 64, shared_memory::mode::open);
+      for (std::uint64_t i = 0; i != rounds; ++i)
+      {
+        message m;
+        if (i % 2)
+        {
+          rx.receive(m);
+        }
+        else
+        {
+          while (!rx.receive_for(m, 100ms))
+            ;
+        }
+        if (m.seq != i || m.value != i * 0.5)
+          _exit(1);
+      }
+      message m;
+      _exit(rx.receive_for(m, 1ms) ? 2 : 0);
+    }
+
+    for (std::uint64_t i = 0; i != rounds; ++i)
+    {
+      message *m;
+      while (!(m = ch.try_loan()))
+        usleep(10);
+      m->seq = i;
+      m->value = i * 0.5;
+      ch.commit();
+    }
+    wait_child(pid);
+
+    message m{1, 1.0};
+    assert(ch.try_send(m));
+    const message *p = ch.try_peek();
+    assert(p && p->seq == 1);
+    ch.release();
+    assert(!ch.try_peek());
+
+    shared_memory::remove(channel_name);
+  }
+
+  return 0;
+}
@@ -0,0 +1,233 @@
+#include <cassert>
+#include <list>
+#include <mutex>
+#include <rtxx/condition_variable.hpp>
+#include <rtxx/mutex.hpp>
+#include <rtxx/semaphore.hpp>
+#include <rtxx/sim.hpp>
+#include <rtxx/task.hpp>
+#include <utility>
+#include <vector>
+
+using namespace rtxx;
+using namespace std::literals;
+
+namespace
+{
+using log_type = std::vector<std::pair<int, chrono::nanoseconds>>;
+
+/// Virtual time elapsed since \c t0.
+chrono::nanoseconds since(monotonic_clock::time_point t0)
+{
+  return monotonic_clock::now() - t0;
+}
+
+/// Tasks of a priority inversion scenario, returns when the high priority
+/// task got the mutex.
+chrono::nanoseconds inversion(const mutex::options &opt)
+{
+  mutex m(opt);
+  const auto t0 = monotonic_clock::now();
+  chrono::nanoseconds got{};
+
+  task low(task::options{priority(10)}, [&] {
+    sim::sleep_until(t0 + 1ms);
+    std::lock_guard<mutex> guard(m);
+    sim::consume(4ms);
+  });
+  task medium(task::options{priority(20)}, [&] {
+    sim::sleep_until(t0 + 3ms);
+    sim::consume(10ms);
+  });
+  task high(task::options{priority(30)}, [&] {
+    sim::sleep_until(t0 + 2ms);
+    std::lock_guard<mutex> guard(m);
+    got = since(t0);
+  });
+
+  low.join();
+  medium.join();
+  high.join();
+  return got;
+}
+
+/// Periodic tasks sharing a mutex, returns what each cycle saw.
+log_type contention()
+{
+  mutex m;
+  log_type log;
+  const auto t0 = monotonic_clock::now();
+
+  auto cyclic = [&](int id, chrono::nanoseconds period) {
+    return [&, id, period] {
+      this_task::set_periodic(t0, period);
+      for (int i = 0; i != 100; ++i)
+      {
+        this_task::wait_period();
+        std::lock_guard<mutex> guard(m);
+        sim::consume(300us);
+        log.emplace_back(id, since(t0));
+      }
+    };
+  };
+
+  task a(task::options{priority(10)}, cyclic(1, 1ms));
+  task b(task::options{priority(10)}, cyclic(2, 1500us));
+  task c(task::options{priority(20)}, cyclic(3, 2500us));
+  a.join();
+  b.join();
+  c.join();
+  return log;
+}
+} // namespace
+
+int main()
+{
+  // An hour of periodic schedule on the virtual clock
+  {
+    const auto t0 = monotonic_clock::now();
+    unsigned long cycles = 0;
+    task t(task::options{priority(50)}, [&] {
+      this_task::set_periodic(t0, 10ms);
+      for (; cycles != 360'000; ++cycles)
+      {
+        this_task::wait_period();
+        sim::consume(2ms);
+      }
+    });
+    t.join();
+    assert(cycles == 360'000);
+    assert(t.overruns() == 0);
+    assert(since(t0) == 1h - 10ms + 2ms);
+  }
+
+  // Overruns are counted against the virtual clock
+  {
+    const auto t0 = monotonic_clock::now();
+    unsigned missed = 0;
+    task t(task::options{priority(50)}, [&] {
+      this_task::set_periodic(t0, 1ms);
+      this_task::wait_period();
+      sim::consume(2500us);
+      // Released at 1ms and 2ms meanwhile: runs late for the first.
+      missed = this_task::wait_period();
+      assert(since(t0) == 2500us);
+      this_task::wait_period();
+      assert(since(t0) == 3ms);
+    });
+    t.join();
+    assert(missed == 1);
+    assert(t.overruns() == 1);
+  }
+
+  // A task released in the middle of a lower priority one preempts it
+  {
+    const auto t0 = monotonic_clock::now();
+    log_type log;
+    task low(task::options{priority(10)}, [&] {
+      sim::sleep_until(t0 + 1ms);
+      log.emplace_back(1, since(t0));
+      sim::consume(10ms);
+      log.emplace_back(1, since(t0));
+    });
+    task high(task::options{priority(20)}, [&] {
+      sim::sleep_for(5ms);
+      log.emplace_back(2, since(t0));
+      sim::consume(2ms);
+      log.emplace_back(2, since(t0));
+    });
+    low.join();
+    high.join();
+    assert((log == log_type{{1, 1ms}, {2, 5ms}, {2, 7ms}, {1, 13ms}}));
+  }
+
+  // Priority inheritance bounds the inversion to the critical section
+  {
+    assert(inversion(mutex::options{priority_inherit()}) == 5ms);
+    assert(inversion(mutex::options{priority_ceiling(30)}) == 5ms);
+    assert(inversion(mutex::options{}) == 15ms);
+  }
+
+  // Semaphores and condition variables wake the highest priority first,
+  // then in arrival order
+  {
+    semaphore sem(0);
+    std::vector<int> order;
+    std::list<task> waiters;
+    for (int prio : {10, 30, 20, 30})
+      waiters.emplace_back(task::options{priority(prio)}, [&, prio] {
+        sem.wait();
+        order.push_back(prio * 10 + static_cast<int>(order.size()));
+      });
+    assert(sem.get_value() == 0);
+    for (int i = 0; i != 4; ++i)
+      sem.post();
+    for (auto &w : waiters)
+      w.join();
+    assert((order == std::vector<int>{300, 301, 202, 103}));
+  }
+  {
+    mutex m;
+    condition_variable cv;
+    bool go = false;
+    std::vector<int> order;
+    std::list<task> waiters;
+    for (int id : {1, 3, 2})
+      waiters.emplace_back(task::options{priority(id * 10)}, [&, id] {
+        std::unique_lock<mutex> lock(m);
+        while (!go)
+          cv.wait(lock);
+        order.push_back(id);
+      });
+    {
+      std::lock_guard<mutex> guard(m);
+      go = true;
+      cv.notify_all();
+    }
+    for (auto &w : waiters)
+      w.join();
+    assert((order == std::vector<int>{3, 2, 1}));
+  }
+
+  // Timeouts fall exactly on the virtual clock
+  {
+    semaphore sem(0);
+    auto t0 = monotonic_clock::now();
+    assert(!sem.wait_for(50ms));
+    assert(since(t0) == 50ms);
+
+    mutex m;
+    task owner(task::options{priority(10)}, [&] {
+      std::lock_guard<mutex> guard(m);
+      sim::sleep_for(20ms);
+    });
+    t0 = monotonic_clock::now();
+    assert(!m.try_lock_for(5ms));
+    assert(since(t0) == 5ms);
+    assert(m.try_lock_for(1h));
+    assert(since(t0) == 20ms);
+    m.unlock();
+    owner.join();
+
+    condition_variable cv;
+    std::unique_lock<mutex> lock(m);
+    t0 = monotonic_clock::now();
+    assert(!cv.wait_for(lock, 3ms));
+    assert(since(t0) == 3ms);
+    assert(realtime_clock::now().time_since_epoch() ==
+           monotonic_clock::now().time_since_epoch());
+  }
+
+  // Runs are reproducible
+  {
+    const auto switches = sim::context_switches();
+    const log_type first = contention();
+    const auto first_switches = sim::context_switches() - switches;
+    const log_type second = contention();
+    assert(first.size() == 300);
+    assert(first == second);
+    assert(sim::context_switches() - switches == 2 * first_switches);
+  }
+
+  return 0;
+}
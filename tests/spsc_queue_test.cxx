@@ -0,0 +1,168 @@
+#include <cassert>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <rtxx/clock.hpp>
+#include <rtxx/condition_variable.hpp>
+#include <rtxx/mutex.hpp>
+#include <rtxx/spsc_queue.hpp>
+#include <rtxx/task.hpp>
+
+using namespace rtxx;
+
+using namespace std::literals;
+
+namespace
+{
+constexpr long count = 200000;
+
+struct result
+{
+  double throughput; // messages per second
+  double avg_latency;
+  long max_latency;
+};
+
+void print(const char *title, const result &r)
+{
+  std::cout << title << ":\n"
+            << "throughput:\t" << (long)r.throughput << " msg/s\n"
+            << "avglatency:\t" << (long)r.avg_latency << '\n'
+            << "maxlatency:\t" << r.max_latency << '\n';
+}
+
+void check_basics()
+{
+  spsc_queue<int, 4> q;
+  assert(q.empty());
+  assert(q.capacity() == 4);
+
+  int v = 0;
+  [[maybe_unused]] bool ok = q.try_pop(v);
+  assert(!ok);
+
+  const int in[] = {1, 2, 3, 4, 5, 6};
+  [[maybe_unused]] std::size_t n = q.try_push_n(in, 6);
+  assert(n == 4);
+  ok = q.try_push(7);
+  assert(!ok);
+  assert(q.size() == 4);
+
+  int out[8];
+  n = q.try_pop_n(out, 3);
+  assert(n == 3);
+  assert(out[0] == 1 && out[1] == 2 && out[2] == 3);
+
+  ok = q.try_push(5);
+  assert(ok);
+  ok = q.try_pop(v);
+  assert(ok && v == 4);
+  ok = q.try_pop(v);
+  assert(ok && v == 5);
+  assert(q.empty());
+
+  blocking_spsc_queue<int, 4> bq;
+  ok = bq.pop_for(v, 1ms);
+  assert(!ok);
+}
+
+result run_spsc()
+{
+  blocking_spsc_queue<monotonic_clock::rep, 1024> q;
+  double latency_sum = 0;
+  long max_latency = 0;
+
+  const auto st = monotonic_clock::now();
+
+  task consumer(task::options{name("spsc_consumer")}, [&] {
+    monotonic_clock::rep stamps[64];
+    for (long received = 0; received != count;)
+    {
+      const auto n = q.pop_n(stamps, 64);
+      const auto now = monotonic_clock::now().time_since_epoch().count();
+      for (std::size_t i = 0; i != n; ++i)
+      {
+        const long diff = now - stamps[i];
+        latency_sum += diff;
+        if (max_latency < diff)
+          max_latency = diff;
+      }
+      received += n;
+    }
+  });
+
+  task producer(task::options{name("spsc_producer")}, [&] {
+    for (long sent = 0; sent != count;)
+    {
+      if (q.try_push(monotonic_clock::now().time_since_epoch().count()))
+        ++sent;
+      else
+        this_task::yield();
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  const chrono::duration<double> elapsed = monotonic_clock::now() - st;
+  assert(q.empty());
+  return {count / elapsed.count(), latency_sum / count, max_latency};
+}
+
+result run_mutex_cv()
+{
+  constexpr std::size_t limit = 1024;
+  std::deque<monotonic_clock::rep> q;
+  mutex m;
+  condition_variable not_empty;
+  condition_variable not_full;
+  double latency_sum = 0;
+  long max_latency = 0;
+
+  const auto st = monotonic_clock::now();
+
+  task consumer(task::options{name("mutex_consumer")}, [&] {
+    for (long received = 0; received != count; ++received)
+    {
+      std::unique_lock<mutex> lock(m);
+      while (q.empty())
+        not_empty.wait(lock);
+      const auto stamp = q.front();
+      q.pop_front();
+      not_full.notify_one();
+      lock.unlock();
+
+      const long diff = monotonic_clock::now().time_since_epoch().count() - stamp;
+      latency_sum += diff;
+      if (max_latency < diff)
+        max_latency = diff;
+    }
+  });
+
+  task producer(task::options{name("mutex_producer")}, [&] {
+    for (long sent = 0; sent != count; ++sent)
+    {
+      std::unique_lock<mutex> lock(m);
+      while (q.size() == limit)
+        not_full.wait(lock);
+      q.push_back(monotonic_clock::now().time_since_epoch().count());
+      not_empty.notify_one();
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  const chrono::duration<double> elapsed = monotonic_clock::now() - st;
+  return {count / elapsed.count(), latency_sum / count, max_latency};
+}
+
+} // namespace
+
+int main()
+{
+  check_basics();
+
+  print("spsc_queue", run_spsc());
+  print("mutex+condition_variable", run_mutex_cv());
+}
@@ -1,18 +1,39 @@
+#include <atomic>
+#include <cassert>
+#include <cmath>
 #include <csignal>
 #include <iomanip>
 #include <iostream>
 #include <rtxx/mutex.hpp>
 #include <rtxx/task.hpp>
+#include <thread>
+#include <vector>
 
 using namespace rtxx;
 
 using namespace std::literals;
 
+static std::atomic<unsigned> misses{0};
+static std::atomic<unsigned> exhausted{0};
+
+// Use up CPU time, whatever the preemptions.
+static void spin_for(chrono::nanoseconds d)
+{
+  auto cpu_time = [] {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return chrono::seconds(ts.tv_sec) + chrono::nanoseconds(ts.tv_nsec);
+  };
+  const auto end = cpu_time() + d;
+  while (cpu_time() < end)
+    ;
+}
+
 int main()
 {
   using namespace rtxx;
 
-  task task1(task::options{name("task_test"), priority(99), schedpolicy(SCHED_FIFO)}, []() {
+  task task1(task::options{name("task_test"), priority(99), schedpolicy(SCHED_FIFO), record_latency()}, []() {
     auto expected = monotonic_clock::now();
     auto period = 1ms;
 
@@ -60,4 +81,149 @@ int main()
 
   task1.join();
   std::cout << "task joined\n";
+
+  const auto latency = task1.wakeup_latency();
+  std::cout << "wakeups:\t" << latency.count() << '\n'
+            << "p50:\t" << latency.percentile(0.5).count() << '\n'
+            << "p99:\t" << latency.percentile(0.99).count() << '\n'
+            << "p99.9:\t" << latency.percentile(0.999).count() << '\n'
+            << "max:\t" << latency.max().count() << '\n'
+            << "overruns:\t" << task1.overruns() << '\n';
+
+  assert(latency.count() > 0);
+  assert(latency.percentile(0.5) <= latency.percentile(0.99));
+  assert(latency.percentile(0.999) <= latency.max());
+
+  // Overrun policies and deadline-miss callback
+  auto on_miss = [](task &, unsigned missed) { misses += missed; };
+  {
+    task t(task::options{on_overrun(overrun_policy::catch_up),
+                         on_deadline_miss(on_miss)},
+           [] {
+             this_task::set_periodic(monotonic_clock::now(), 5ms);
+             this_task::wait_period();
+             std::this_thread::sleep_for(17ms);
+
+             // The missed releases run back to back.
+             const auto st = monotonic_clock::now();
+             for (int i = 0; i != 3; ++i)
+               assert(this_task::wait_period() == 0);
+             assert(monotonic_clock::now() - st < 5ms);
+           });
+    t.join();
+    assert(t.overruns() >= 2);
+    assert(misses == t.overruns());
+  }
+
+  misses = 0;
+  {
+    task t(task::options{on_overrun(overrun_policy::stretch),
+                         on_deadline_miss(on_miss)},
+           [] {
+             this_task::set_periodic(monotonic_clock::now(), 5ms);
+             this_task::wait_period();
+             std::this_thread::sleep_for(17ms);
+
+             // The timeline restarts one period after the late wakeup.
+             assert(this_task::wait_period() >= 2);
+             const auto st = monotonic_clock::now();
+             this_task::wait_period();
+             assert(monotonic_clock::now() - st > 3ms);
+           });
+    t.join();
+    assert(misses >= 2);
+  }
+
+  // Execution budget on the thread CPU clock
+  {
+    task t(task::options{execution_budget(
+               1ms, [](task &) { exhausted.fetch_add(1); })},
+           [] {
+             this_task::set_periodic(monotonic_clock::now(), 50ms);
+             this_task::wait_period();
+             spin_for(200us);
+             this_task::wait_period();
+             // CPU timers are checked at scheduler ticks, which a loaded
+             // host may spread far apart: spin until the timer fired.
+             spin_for(20ms);
+             for (int i = 0; i != 2000 && exhausted == 0; ++i)
+               spin_for(1ms);
+             this_task::wait_period();
+           });
+    t.join();
+    std::cout << "max execution time:\t" << t.max_execution_time().count()
+              << '\n';
+    assert(t.budget_overruns() == 1);
+    assert(exhausted == 1);
+    assert(t.max_execution_time() >= 20ms);
+  }
+
+  // SCHED_DEADLINE admission test
+  {
+    const task::options set[] = {
+        task::options{deadline_scheduling(2ms, 10ms)},
+        task::options{deadline_scheduling(1ms, 4ms, 2ms)},
+        task::options{priority(10)},
+    };
+    const auto r = check_deadline_admission(set, 3);
+    assert(r.capacity > 0);
+    assert(r.utilization > 0.449 && r.utilization < 0.451);
+    assert(r.admitted == (r.utilization <= r.capacity));
+
+    const task::options invalid[] = {
+        task::options{deadline_scheduling(3ms, 10ms, 2ms)},
+    };
+    assert(!check_deadline_admission(invalid, 1).admitted);
+
+    // One more task of 0.9 CPU than the capacity of this host holds.
+    std::vector<task::options> full(
+        static_cast<std::size_t>(std::ceil(r.capacity / 0.9)) + 1,
+        task::options{deadline_scheduling(9ms, 10ms)});
+    const auto f = check_deadline_admission(full.data(), full.size());
+    assert(f.utilization > f.capacity);
+    assert(!f.admitted);
+  }
+
+  // Deadline tasks only skip missed releases
+  {
+    error_code ec;
+    try
+    {
+      task dl(task::options{deadline_scheduling(1ms, 10ms),
+                            on_overrun(overrun_policy::catch_up)},
+              [] {});
+    }
+    catch (const system_error &e)
+    {
+      ec = e.code();
+    }
+    assert(ec == std::errc::invalid_argument);
+  }
+
+  // SCHED_DEADLINE task, needs privileges and free bandwidth
+  {
+    error_code ec;
+    try
+    {
+      unsigned periods = 0;
+      task dl(task::options{name("dl_test"), deadline_scheduling(1ms, 10ms)},
+              [&periods] {
+                while (periods != 20)
+                {
+                  this_task::wait_period();
+                  ++periods;
+                }
+              });
+      dl.join();
+      assert(periods == 20);
+      std::cout << "deadline overruns:\t" << dl.overruns() << '\n';
+    }
+    catch (const system_error &e)
+    {
+      ec = e.code();
+      std::cout << "deadline task skipped: " << ec.message() << '\n';
+    }
+    assert(!ec || ec == std::errc::operation_not_permitted ||
+           ec == std::errc::device_or_resource_busy);
+  }
 }
@@ -0,0 +1,89 @@
+#include <atomic>
+#include <cassert>
+#include <rtxx/semaphore.hpp>
+#include <rtxx/thread_pool.hpp>
+#include <vector>
+
+using namespace rtxx;
+
+using namespace std::literals;
+
+namespace
+{
+void test_submit()
+{
+  std::atomic<int> critical{0}, background{0};
+  {
+    thread_pool pool(thread_pool::options{name("test_pool"),
+                                          critical_priority(20),
+                                          background_priority(0)});
+    assert(pool.size() > 0);
+
+    for (int i = 0; i != 100; ++i)
+    {
+      assert(pool.try_submit(thread_pool::lane::critical, [&] { ++critical; }));
+      assert(pool.try_submit(thread_pool::lane::background,
+                             [&] { ++background; }));
+    }
+  }
+  // queued jobs are run before the workers stop
+  assert(critical == 100 && background == 100);
+}
+
+void test_queue_full()
+{
+  thread_pool pool(thread_pool::options{queue_capacity(2)});
+  semaphore gate(0);
+
+  // block every critical worker, then fill their queues
+  std::size_t accepted = 0;
+  while (pool.try_submit(thread_pool::lane::critical, [&] { gate.wait(); }))
+    ++accepted;
+  assert(accepted >= pool.size() * 2);
+  for (std::size_t i = 0; i != accepted; ++i)
+    gate.post();
+}
+
+void test_parallel_for()
+{
+  thread_pool pool(thread_pool::options{critical_priority(20)});
+
+  std::vector<int> hits(10000);
+  const bool done = pool.parallel_for(0, hits.size(), 64,
+                                      [&](std::size_t i) { ++hits[i]; });
+  assert(done);
+  for (auto h : hits)
+    assert(h == 1);
+
+  // a past deadline cancels every chunk
+  std::atomic<int> calls{0};
+  const bool late = pool.parallel_for(
+      0, 1000, 1, [&](std::size_t) { ++calls; },
+      monotonic_clock::now() - 1ms);
+  assert(!late);
+  assert(calls == 0);
+
+  // chunks already running are waited for
+  std::atomic<int> finished{0};
+  const auto deadline = monotonic_clock::now() + 5ms;
+  pool.parallel_for(
+      0, 1000, 1,
+      [&](std::size_t) {
+        const auto until = monotonic_clock::now() + 1ms;
+        while (monotonic_clock::now() < until)
+          ;
+        ++finished;
+      },
+      deadline);
+  const int seen = finished;
+  assert(seen > 0 && seen < 1000);
+  assert(finished == seen);
+}
+} // namespace
+
+int main()
+{
+  test_submit();
+  test_queue_full();
+  test_parallel_for();
+}
@@ -0,0 +1,150 @@
+#include <sched.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <rtxx/task.hpp>
+#include <rtxx/topology.hpp>
+#include <string>
+#include <vector>
+
+using namespace rtxx;
+
+namespace
+{
+/// Create a file and its parent directories.
+void put(const std::string &root, const std::string &path, const char *text)
+{
+  const std::string full = root + "/" + path;
+  for (auto pos = full.find('/', 1); pos != std::string::npos;
+       pos = full.find('/', pos + 1))
+    mkdir(full.substr(0, pos).c_str(), 0755);
+
+  std::FILE *f = std::fopen(full.c_str(), "w");
+  assert(f);
+  std::fputs(text, f);
+  std::fclose(f);
+}
+
+/// Two nodes of two cores with two threads each. Each core has its own
+/// L2, each node its own L3. The second node is isolated.
+std::string fake_sysfs()
+{
+  char tmpl[] = "/tmp/rtxx_topology_XXXXXX";
+  const std::string root = mkdtemp(tmpl);
+  const std::string cpu = "devices/system/cpu/";
+
+  put(root, cpu + "online", "0-7\n");
+  put(root, cpu + "isolated", "2-3,6-7\n");
+  put(root, cpu + "nohz_full", "3,7\n");
+  put(root, "devices/system/node/online", "0-1\n");
+  put(root, "devices/system/node/node0/cpulist", "0-1,4-5\n");
+  put(root, "devices/system/node/node1/cpulist", "2-3,6-7\n");
+
+  for (int c = 0; c != 8; ++c)
+  {
+    const std::string dir = cpu + "cpu" + std::to_string(c) + "/";
+    const int core = c % 4;
+    const std::string siblings =
+        std::to_string(core) + "," + std::to_string(core + 4) + "\n";
+    const char *l3 = core < 2 ? "0-1,4-5\n" : "2-3,6-7\n";
+
+    put(root, dir + "topology/thread_siblings_list", siblings.c_str());
+    put(root, dir + "topology/physical_package_id", "0\n");
+    put(root, dir + "cache/index0/level", "1\n");
+    put(root, dir + "cache/index0/type", "Data\n");
+    put(root, dir + "cache/index0/shared_cpu_list", siblings.c_str());
+    put(root, dir + "cache/index1/level", "1\n");
+    put(root, dir + "cache/index1/type", "Instruction\n");
+    put(root, dir + "cache/index1/shared_cpu_list", siblings.c_str());
+    put(root, dir + "cache/index2/level", "2\n");
+    put(root, dir + "cache/index2/type", "Unified\n");
+    put(root, dir + "cache/index2/shared_cpu_list", siblings.c_str());
+    put(root, dir + "cache/index3/level", "3\n");
+    put(root, dir + "cache/index3/type", "Unified\n");
+    put(root, dir + "cache/index3/shared_cpu_list", l3);
+  }
+  return root;
+}
+} // namespace
+
+int main()
+{
+  // CPU lists
+  {
+    const cpu_mask m = cpu_mask::parse("0-3,8,10-11\n");
+    assert(m.count() == 7);
+    assert(m.test(8) && !m.test(9) && m.test(11));
+    assert(m.first() == 0 && m.next(3) == 8);
+    assert((m & cpu_mask{2, 9, 10}) == (cpu_mask{2, 10}));
+    assert((m - cpu_mask{0, 1, 2, 3}) == (cpu_mask{8, 10, 11}));
+    assert(cpu_mask::parse("").empty());
+
+    error_code ec;
+    (void)cpu_mask::parse("1-", ec);
+    assert(ec == errc::invalid_argument);
+    (void)cpu_mask::parse("3-1", ec);
+    assert(ec == errc::invalid_argument);
+  }
+
+  // Fake machine
+  {
+    const std::string root = fake_sysfs();
+    const topology topo = topology::read(root.c_str());
+
+    assert(topo.cpus().size() == 8);
+    assert(topo.online().count() == 8);
+    assert(topo.isolated() == (cpu_mask{2, 3, 6, 7}));
+    assert(topo.nohz_full() == (cpu_mask{3, 7}));
+    assert(topo.find(6)->core == 2 && topo.find(6)->node == 1);
+    assert(topo.find(5)->l2 == 1 && topo.find(5)->l3 == 0);
+
+    assert(topo.siblings(4) == (cpu_mask{0, 4}));
+    assert(topo.sharing_cache(1, 2) == (cpu_mask{1, 5}));
+    assert(topo.sharing_cache(1, 3) == (cpu_mask{0, 1, 4, 5}));
+    assert(topo.node(1) == (cpu_mask{2, 3, 6, 7}));
+    assert(topo.cores(topo.online()) == (cpu_mask{0, 1, 2, 3}));
+
+    // Isolated cores are preferred, never two SMT siblings.
+    assert((topo.place_together(2) == std::vector<int>{2, 3}));
+    assert((topo.place_together(2, topo.online()) == std::vector<int>{0, 1}));
+    assert((topo.place_together(3) == std::vector<int>{0, 1, 2}));
+    assert(topo.place_together(5).empty());
+
+    assert((topo.place_apart(2, topo.online()) == std::vector<int>{0, 2}));
+    assert((topo.place_apart(3, topo.online()) == std::vector<int>{0, 2, 1}));
+
+    std::string cmd = "rm -rf " + root;
+    assert(std::system(cmd.c_str()) == 0);
+
+    error_code ec;
+    (void)topology::read(root.c_str(), ec);
+    assert(ec == errc::no_such_file_or_directory);
+  }
+
+  // This machine
+  {
+    const topology topo = topology::read();
+    assert(!topo.online().empty());
+    assert(int(topo.cpus().size()) == topo.online().count());
+    assert(topo.place_together(1).size() == 1);
+  }
+
+  // Task affinity is applied
+  {
+    const int cpu = topology::read().online().first();
+    int ran_on = -1;
+    cpu_set_t allowed;
+    task t(task::options{affinity(cpu_mask{cpu})}, [&] {
+      ran_on = sched_getcpu();
+      pthread_getaffinity_np(pthread_self(), sizeof(allowed), &allowed);
+    });
+    t.join();
+    assert(ran_on == cpu);
+    assert(cpu_mask(allowed) == cpu_mask{cpu});
+  }
+
+  return 0;
+}
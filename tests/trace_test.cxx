@@ -0,0 +1,92 @@
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <rtxx/condition_variable.hpp>
+#include <rtxx/mutex.hpp>
+#include <rtxx/semaphore.hpp>
+#include <rtxx/task.hpp>
+#include <rtxx/trace.hpp>
+#include <sstream>
+#include <string>
+
+using namespace rtxx;
+using namespace std::chrono_literals;
+
+namespace
+{
+std::size_t count(const std::string &s, const std::string &what)
+{
+  std::size_t n = 0;
+  for (auto pos = s.find(what); pos != std::string::npos;
+       pos = s.find(what, pos + 1))
+    ++n;
+  return n;
+}
+} // namespace
+
+int main()
+{
+  trace::attach();
+
+  mutex m;
+  semaphore sem(0);
+  condition_variable cv;
+  bool ready = false;
+
+  task t(task::options{name("traced")}, [&] {
+    this_task::set_periodic(monotonic_clock::now() + 1ms, 1ms);
+    for (int i = 0; i != 3; ++i)
+      this_task::wait_period();
+
+    std::unique_lock<mutex> lock(m);
+    ready = true;
+    cv.notify_one();
+    lock.unlock();
+    sem.post();
+  });
+
+  {
+    std::unique_lock<mutex> lock(m);
+    while (!ready)
+      cv.wait(lock);
+  }
+  sem.wait();
+  assert(!sem.wait_for(1ms));
+  t.join();
+
+  char path[64];
+  snprintf(path, sizeof(path), "/tmp/rtxx_trace_%d.json", int(getpid()));
+  trace::export_json(path);
+
+  std::ifstream in(path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  const std::string json = ss.str();
+  unlink(path);
+
+  assert(json.rfind(R"({"displayTimeUnit":"ns","traceEvents":[)", 0) == 0);
+  assert(json.find(R"("args":{"name":"traced"})") != std::string::npos);
+  assert(count(json, R"("name":"wakeup")") == 3);
+  assert(count(json, R"("name":"release")") == 3);
+  assert(count(json, R"("name":"post")") >= 2);
+  assert(count(json, R"("name":"locked","ph":"B")") ==
+         count(json, R"("name":"locked","ph":"E")"));
+  assert(count(json, R"("name":"wait","ph":"B")") ==
+         count(json, R"("name":"wait","ph":"E")"));
+  // wait_period three times, the condition variable, the semaphore twice.
+  assert(count(json, R"("name":"wait","ph":"B")") >= 5);
+  assert(count(json, "{") == count(json, "}"));
+
+  trace::clear();
+  trace::export_json(path);
+  std::ifstream cleared(path);
+  std::stringstream cs;
+  cs << cleared.rdbuf();
+  assert(cs.str().find(R"("name":"wait")") == std::string::npos);
+  unlink(path);
+
+  return 0;
+}
@@ -0,0 +1,61 @@
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <rtxx/task.hpp>
+#include <rtxx/triple_buffer.hpp>
+
+using namespace rtxx;
+
+namespace
+{
+struct frame
+{
+  std::uint64_t seq{0};
+  std::uint64_t data[64]{};
+};
+} // namespace
+
+int main()
+{
+  triple_buffer<frame> buf;
+  assert(!buf.updated());
+  assert(buf.read().seq == 0);
+
+  buf.write_buffer().seq = 1;
+  buf.publish();
+  assert(buf.updated());
+  assert(buf.read().seq == 1);
+  assert(!buf.updated());
+  assert(buf.read().seq == 1);
+
+  constexpr std::uint64_t writes = 200000;
+  std::atomic<bool> done{false};
+
+  task writer([&] {
+    for (std::uint64_t i = 2; i <= writes; ++i)
+    {
+      frame &f = buf.write_buffer();
+      f.seq = i;
+      for (auto &d : f.data)
+        d = i;
+      buf.publish();
+    }
+    done = true;
+  });
+
+  task reader([&] {
+    std::uint64_t last = 1;
+    while (!done.load())
+    {
+      const frame &f = buf.read();
+      for (auto d : f.data)
+        assert(d == f.seq || f.seq == 1);
+      assert(f.seq >= last);
+      last = f.seq;
+    }
+  });
+
+  writer.join();
+  reader.join();
+  assert(buf.read().seq == writes);
+}